@@ -0,0 +1,150 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pins.h"
+
+// Chassis descriptors: how many wheels a build drives, and which GPIOs and PCA9685
+// channels each wheel index lands on. The controllers take their counts and wiring
+// from board::Active, so every per-wheel loop has a constant trip count and every
+// table lookup a constant table; a board is chosen per image with
+// -DMOTIONDRIVER_BOARD=<descriptor>, not at run time.
+//
+// A descriptor is a struct with:
+//   kWheelCount     wheels, each with one DRV8833 channel and one steering servo
+//   kMotors[]       the motor wiring, by wheel index
+//   kServoChannels[] wheel index -> PCA9685 output channel
+//   kEncoders[]     wheel index -> encoder A/B pins (-1 = not wired, stays open-loop)
+//   kWheelLon[], kWheelLat[]
+//                   wheel position in units of kHalfWheelbaseM / kHalfTrackM, for
+//                   the STEER solver: lon +1 front, -1 rear; lat +1 right, -1 left
+namespace board
+{
+    // One DRV8833 channel as the loom wires it to a wheel. `reversed` marks a motor
+    // whose leads are crossed relative to the driver's forward contract; the
+    // controller then drives IN2 where it would drive IN1, so FORWARD still turns
+    // the wheel forward.
+    struct MotorWiring
+    {
+        int in1Pin;
+        int in2Pin;
+        bool reversed;
+
+        // The pins the controller's A and B PWM channels drive.
+        constexpr int channelAPin() const { return reversed ? in2Pin : in1Pin; }
+        constexpr int channelBPin() const { return reversed ? in1Pin : in2Pin; }
+    };
+
+    struct EncoderWiring
+    {
+        int aPin;
+        int bPin;
+    };
+
+    // Cheddar, the six-wheel rover. Wheel index: 0 FL, 1 FR, 2 ML, 3 MR, 4 RL, 5 RR.
+    struct Cheddar
+    {
+        static constexpr uint8_t kWheelCount = 6;
+
+        // The loom does not follow M1..M6 in wheel order: M1/M2/M3 carry the right
+        // side front->rear, M4/M5/M6 the left side front->rear. Front Left and Middle
+        // Left are the only motors wired the normal way round -- don't "tidy" them
+        // into matching the others.
+        //
+        // Verified against hardware 2026-07-17 by driving every index in both
+        // directions and watching which wheel turned and which way.
+        static constexpr MotorWiring kMotors[kWheelCount] = {
+            {PIN_M4_IN1, PIN_M4_IN2, false}, // 0 Front Left
+            {PIN_M1_IN1, PIN_M1_IN2, true},  // 1 Front Right
+            {PIN_M5_IN1, PIN_M5_IN2, false}, // 2 Middle Left
+            {PIN_M2_IN1, PIN_M2_IN2, true},  // 3 Middle Right
+            {PIN_M6_IN1, PIN_M6_IN2, true},  // 4 Rear Left
+            {PIN_M3_IN1, PIN_M3_IN2, true},  // 5 Rear Right
+        };
+
+        // Unlike the motors there is no tidy pattern: the left side sits on channels
+        // 0-2 running rear->front, and the right side does not mirror it. Treat this
+        // as a lookup, not a formula.
+        // Verified against hardware 2026-07-16 by driving each index and watching
+        // which wheel steered.
+        static constexpr uint8_t kServoChannels[kWheelCount] = {
+            2, // 0 Front Left
+            4, // 1 Front Right
+            1, // 2 Middle Left
+            3, // 3 Middle Right
+            0, // 4 Rear Left
+            5  // 5 Rear Right
+        };
+
+        static constexpr EncoderWiring kEncoders[kWheelCount] = {
+            {PIN_ENC0_A, PIN_ENC0_B}, {PIN_ENC1_A, PIN_ENC1_B}, {PIN_ENC2_A, PIN_ENC2_B},
+            {PIN_ENC3_A, PIN_ENC3_B}, {PIN_ENC4_A, PIN_ENC4_B}, {PIN_ENC5_A, PIN_ENC5_B},
+        };
+
+        // Corner wheels steer about the middle axle's line; the middle pair stays
+        // straight. Not yet measured on the rover: equal half-wheelbase and half-track
+        // match the Pi's normalised model. Measure before trusting absolute radii --
+        // the angles at full lock do not depend on them, only the radius that
+        // produces them.
+        static constexpr double kHalfWheelbaseM = 0.15;
+        static constexpr double kHalfTrackM = 0.15;
+        static constexpr int8_t kWheelLon[kWheelCount] = {+1, +1, 0, 0, -1, -1};
+        static constexpr int8_t kWheelLat[kWheelCount] = {-1, +1, -1, +1, -1, +1};
+    };
+
+    // The four-wheel bench jig. Wheel index: 0 FL, 1 FR, 2 RL, 3 RR. Wired straight
+    // through on M1..M4 and PCA9685 channels 0-3, no encoders; both axles steer about
+    // the centre line.
+    struct TestJig
+    {
+        static constexpr uint8_t kWheelCount = 4;
+
+        static constexpr MotorWiring kMotors[kWheelCount] = {
+            {PIN_M1_IN1, PIN_M1_IN2, false}, // 0 Front Left
+            {PIN_M2_IN1, PIN_M2_IN2, false}, // 1 Front Right
+            {PIN_M3_IN1, PIN_M3_IN2, false}, // 2 Rear Left
+            {PIN_M4_IN1, PIN_M4_IN2, false}, // 3 Rear Right
+        };
+
+        static constexpr uint8_t kServoChannels[kWheelCount] = {0, 1, 2, 3};
+
+        static constexpr EncoderWiring kEncoders[kWheelCount] = {
+            {-1, -1}, {-1, -1}, {-1, -1}, {-1, -1},
+        };
+
+        static constexpr double kHalfWheelbaseM = 0.10;
+        static constexpr double kHalfTrackM = 0.10;
+        static constexpr int8_t kWheelLon[kWheelCount] = {+1, +1, -1, -1};
+        static constexpr int8_t kWheelLat[kWheelCount] = {-1, +1, -1, +1};
+    };
+
+    // ServoController::flush() writes one contiguous run of PCA9685 channels starting
+    // at 0, so a board's servo map must be a permutation of 0..kWheelCount-1: a gap
+    // would be rewritten from an idle (all-zero) shadow, a repeat would lose a servo.
+    template <typename Board>
+    constexpr bool servoChannelsPacked()
+    {
+        uint32_t seen = 0;
+        for (size_t wheel = 0; wheel < Board::kWheelCount; ++wheel)
+        {
+            const uint8_t channel = Board::kServoChannels[wheel];
+            if (channel >= Board::kWheelCount || (seen & (1u << channel)) != 0)
+            {
+                return false;
+            }
+            seen |= 1u << channel;
+        }
+        return true;
+    }
+
+#if !defined(MOTIONDRIVER_BOARD)
+#define MOTIONDRIVER_BOARD Cheddar
+#endif
+    using Active = MOTIONDRIVER_BOARD;
+
+    static_assert(Active::kWheelCount >= 1 && Active::kWheelCount <= 8,
+                  "Per-wheel masks are uint8_t");
+    static_assert(servoChannelsPacked<Active>(), "Servo channels must be 0..kWheelCount-1, each once");
+
+} // namespace board
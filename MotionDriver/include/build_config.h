@@ -0,0 +1,23 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Compile-time build profile. [env:release] in platformio.ini defines
+// MOTIONDRIVER_RELEASE; [env:debug] and the host bench leave it out. Every
+// switch here is a constexpr, so what a profile turns off is dropped by the
+// compiler rather than tested at run time.
+
+namespace build
+{
+#if defined(MOTIONDRIVER_RELEASE)
+    constexpr bool kRelease = true;
+#else
+    constexpr bool kRelease = false;
+#endif
+
+    // Bring-up detail on the USB console: I2C error codes, the encoder mask, where
+    // the calibration came from. Failures, command replies, STATS, LAT and the LOG
+    // telemetry stream are the protocol, not debug output, and stay in both images.
+    constexpr bool kDebugLog = !kRelease;
+
+} // namespace build
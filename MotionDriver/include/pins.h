@@ -31,3 +31,26 @@ constexpr int PIN_M5_IN1 = 19;
 constexpr int PIN_M5_IN2 = 23;
 constexpr int PIN_M6_IN1 = 2;  // swap if boot issues
 constexpr int PIN_M6_IN2 = 15; // swap if boot issues
+
+// Wheel encoders (JGA25-370 Hall quadrature), by wheel index: 0 FL, 1 FR, 2 ML, 3 MR,
+// 4 RL, 5 RR. -1 = not wired, which is every wheel today (see HARDWARE.md); that wheel
+// stays open-loop. Only GPIO 34, 35, 36 and 39 are still free, and they are input-only
+// without pull-ups, so at most two wheels fit and the encoder needs its own pull-ups.
+constexpr int PIN_ENC0_A = -1;
+constexpr int PIN_ENC0_B = -1;
+constexpr int PIN_ENC1_A = -1;
+constexpr int PIN_ENC1_B = -1;
+constexpr int PIN_ENC2_A = -1;
+constexpr int PIN_ENC2_B = -1;
+constexpr int PIN_ENC3_A = -1;
+constexpr int PIN_ENC3_B = -1;
+constexpr int PIN_ENC4_A = -1;
+constexpr int PIN_ENC4_B = -1;
+constexpr int PIN_ENC5_A = -1;
+constexpr int PIN_ENC5_B = -1;
+
+// Pack current sense: an analogue hall sensor on the battery lead, its output divided
+// down to the 3.3 V ADC range. -1 = not fitted, which it is not today (see
+// HARDWARE.md); the power budget then runs on its estimates alone. Must be one of the
+// free input-only GPIO 34-39.
+constexpr int PIN_CURRENT_SENSE = -1;
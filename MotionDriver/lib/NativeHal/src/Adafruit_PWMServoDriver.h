@@ -0,0 +1,21 @@
+#pragma once
+
+#include <Wire.h>
+
+// Just enough of the Adafruit driver for ServoController's setup path; channel writes
+// go through TwoWire bursts, which the HAL records.
+class Adafruit_PWMServoDriver
+{
+public:
+    explicit Adafruit_PWMServoDriver(uint8_t address = 0x40, TwoWire &wire = Wire);
+
+    bool begin(uint8_t prescale = 0);
+    void reset();
+    void setOscillatorFrequency(uint32_t frequency);
+    void setPWMFreq(float frequency);
+    uint8_t setPWM(uint8_t channel, uint16_t on, uint16_t off);
+
+private:
+    uint8_t m_address;
+    TwoWire *m_wire;
+};
@@ -0,0 +1,139 @@
+#pragma once
+
+// Host stand-in for the slice of the Arduino-ESP32 core that MotionDriver uses. Only
+// built for [env:native]: time runs on a simulated clock the bench advances (see
+// NativeHal.h), and pin, LEDC and serial traffic is recorded rather than driven.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define IRAM_ATTR
+
+constexpr uint8_t LOW = 0;
+constexpr uint8_t HIGH = 1;
+constexpr uint8_t INPUT = 0x01;
+constexpr uint8_t OUTPUT = 0x03;
+constexpr uint8_t INPUT_PULLUP = 0x05;
+constexpr uint8_t OUTPUT_OPEN_DRAIN = 0x13;
+constexpr uint32_t SERIAL_8N1 = 0x800001c;
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+uint32_t analogReadMilliVolts(uint8_t pin);
+
+double ledcSetup(uint8_t channel, double frequency, uint8_t resolutionBits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcWrite(uint8_t channel, uint32_t duty);
+
+class Print
+{
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t value) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *text) { return write(reinterpret_cast<const uint8_t *>(text), strlen(text)); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const char *text) { return write(text); }
+    size_t print(char value) { return write(static_cast<uint8_t>(value)); }
+    size_t print(int value, int base = 10) { return print(static_cast<long>(value), base); }
+    size_t print(unsigned int value, int base = 10) { return print(static_cast<unsigned long>(value), base); }
+    size_t print(long value, int base = 10);
+    size_t print(unsigned long value, int base = 10);
+    size_t print(double value, int digits = 2);
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(T value)
+    {
+        const size_t written = print(value);
+        return written + println();
+    }
+    size_t println(double value, int digits) { return print(value, digits) + println(); }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+};
+
+// Receive bytes are injected by the bench with simulateReceive(), which runs the
+// onReceive callback the way the ESP32's UART event task does. Everything written
+// collects in a buffer the bench drains with takeTransmitted().
+class HardwareSerial : public Stream
+{
+public:
+    typedef std::function<void(void)> OnReceiveCb;
+
+    explicit HardwareSerial(int uartNumber);
+
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1);
+    void end();
+    void updateBaudRate(unsigned long baud);
+    unsigned long baudRate() const { return m_baudRate; }
+    explicit operator bool() const { return true; }
+
+    void onReceive(OnReceiveCb function, bool onlyOnTimeout = false);
+    bool setRxTimeout(uint8_t symbolsTimeout);
+    bool setRxFIFOFull(uint8_t fifoBytes);
+    size_t setRxBufferSize(size_t size);
+    size_t setTxBufferSize(size_t size);
+
+    int available() override;
+    int read() override;
+    size_t read(uint8_t *buffer, size_t size);
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int availableForWrite() override;
+    void flush() override {}
+
+    // Host only.
+    void simulateReceive(const uint8_t *data, size_t length);
+    void simulateReceive(const char *text) { simulateReceive(reinterpret_cast<const uint8_t *>(text), strlen(text)); }
+    std::vector<uint8_t> takeTransmitted();
+
+private:
+    int m_uartNumber;
+    unsigned long m_baudRate;
+    OnReceiveCb m_onReceive;
+    std::vector<uint8_t> m_rx;
+    size_t m_rxRead;
+    std::vector<uint8_t> m_tx;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+
+// Cycle counts come from the host's monotonic clock at a nominal 1000 MHz, so the
+// firmware's cycles-to-us conversions still hold and read as host nanoseconds.
+class EspClass
+{
+public:
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 1000; }
+};
+
+extern EspClass ESP;
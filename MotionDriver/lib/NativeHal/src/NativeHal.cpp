@@ -0,0 +1,644 @@
+#include "NativeHal.h"
+
+#include <Adafruit_PWMServoDriver.h>
+#include <Preferences.h>
+#include <Wire.h>
+#include <driver/pcnt.h>
+#include <esp_task_wdt.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <map>
+#include <string>
+
+namespace
+{
+    // The ESP32 core's default UART driver buffers.
+    constexpr size_t kDefaultTxBufferSize = 256;
+
+    uint64_t g_nowMicros = 0;
+
+    uint32_t g_ledcDuty[hal::kLedcChannelCount] = {};
+    uint64_t g_ledcChangedAt[hal::kLedcChannelCount] = {};
+    uint32_t g_ledcWrites = 0;
+
+    int g_gpioLevel[hal::kGpioCount] = {};
+
+    uint32_t g_i2cTransactions = 0;
+    uint32_t g_i2cBytes = 0;
+    bool g_i2cFailing = false;
+    // Arduino-ESP32's endTransmission() code for a transaction that timed out.
+    constexpr uint8_t kI2cTimeoutError = 5;
+
+    // namespace -> key -> blob
+    std::map<std::string, std::map<std::string, std::vector<uint8_t>>> g_preferences;
+}
+
+HardwareSerial Serial(0);
+HardwareSerial Serial1(1);
+HardwareSerial Serial2(2);
+TwoWire Wire(0);
+TwoWire Wire1(1);
+EspClass ESP;
+
+namespace hal
+{
+
+    uint64_t nowMicros()
+    {
+        return g_nowMicros;
+    }
+
+    void setMicros(uint64_t micros)
+    {
+        g_nowMicros = micros;
+    }
+
+    void advanceMicros(uint64_t micros)
+    {
+        g_nowMicros += micros;
+    }
+
+    uint32_t ledcDuty(uint8_t channel)
+    {
+        return (channel < kLedcChannelCount) ? g_ledcDuty[channel] : 0;
+    }
+
+    uint64_t ledcChangedAtMicros(uint8_t channel)
+    {
+        return (channel < kLedcChannelCount) ? g_ledcChangedAt[channel] : 0;
+    }
+
+    uint32_t ledcWriteCount()
+    {
+        return g_ledcWrites;
+    }
+
+    int gpioLevel(uint8_t pin)
+    {
+        return (pin < kGpioCount) ? g_gpioLevel[pin] : LOW;
+    }
+
+    uint32_t i2cTransactions()
+    {
+        return g_i2cTransactions;
+    }
+
+    uint32_t i2cBytes()
+    {
+        return g_i2cBytes;
+    }
+
+    void setI2cFailing(bool failing)
+    {
+        g_i2cFailing = failing;
+    }
+
+    void reset()
+    {
+        g_nowMicros = 0;
+        memset(g_ledcDuty, 0, sizeof(g_ledcDuty));
+        memset(g_ledcChangedAt, 0, sizeof(g_ledcChangedAt));
+        g_ledcWrites = 0;
+        memset(g_gpioLevel, 0, sizeof(g_gpioLevel));
+        g_i2cTransactions = 0;
+        g_i2cBytes = 0;
+        g_i2cFailing = false;
+        g_preferences.clear();
+        for (HardwareSerial *port : {&Serial, &Serial1, &Serial2})
+        {
+            port->end();
+            port->takeTransmitted();
+        }
+    }
+
+} // namespace hal
+
+// ---- Time, GPIO, LEDC -----------------------------------------------------------
+
+unsigned long millis()
+{
+    return static_cast<unsigned long>(g_nowMicros / 1000u);
+}
+
+unsigned long micros()
+{
+    return static_cast<unsigned long>(g_nowMicros);
+}
+
+void delay(uint32_t ms)
+{
+    g_nowMicros += static_cast<uint64_t>(ms) * 1000u;
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    g_nowMicros += us;
+}
+
+void pinMode(uint8_t, uint8_t)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (pin < hal::kGpioCount)
+    {
+        g_gpioLevel[pin] = value ? HIGH : LOW;
+    }
+}
+
+int digitalRead(uint8_t pin)
+{
+    return hal::gpioLevel(pin);
+}
+
+uint32_t analogReadMilliVolts(uint8_t)
+{
+    return 0;
+}
+
+double ledcSetup(uint8_t, double frequency, uint8_t)
+{
+    return frequency;
+}
+
+void ledcAttachPin(uint8_t, uint8_t)
+{
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty)
+{
+    ++g_ledcWrites;
+    if (channel < hal::kLedcChannelCount && g_ledcDuty[channel] != duty)
+    {
+        g_ledcDuty[channel] = duty;
+        g_ledcChangedAt[channel] = g_nowMicros;
+    }
+}
+
+uint32_t EspClass::getCycleCount()
+{
+    const auto sinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch).count());
+}
+
+// ---- Print ----------------------------------------------------------------------
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t written = 0;
+    while (written < size && write(buffer[written]) == 1)
+    {
+        ++written;
+    }
+    return written;
+}
+
+size_t Print::print(long value, int base)
+{
+    if (base == 10)
+    {
+        char text[24];
+        snprintf(text, sizeof(text), "%ld", value);
+        return write(text);
+    }
+    return print(static_cast<unsigned long>(value), base);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    char text[72];
+    if (base == 16)
+    {
+        snprintf(text, sizeof(text), "%lX", value);
+    }
+    else if (base == 8)
+    {
+        snprintf(text, sizeof(text), "%lo", value);
+    }
+    else if (base == 2)
+    {
+        char *cursor = text + sizeof(text) - 1;
+        *cursor = '\0';
+        do
+        {
+            *--cursor = static_cast<char>('0' + (value & 1u));
+            value >>= 1;
+        } while (value != 0);
+        return write(cursor);
+    }
+    else
+    {
+        snprintf(text, sizeof(text), "%lu", value);
+    }
+    return write(text);
+}
+
+size_t Print::print(double value, int digits)
+{
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return write(text);
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    const int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (length <= 0)
+    {
+        return 0;
+    }
+    const size_t size = (static_cast<size_t>(length) < sizeof(text)) ? static_cast<size_t>(length) : sizeof(text) - 1;
+    return write(reinterpret_cast<const uint8_t *>(text), size);
+}
+
+// ---- HardwareSerial -------------------------------------------------------------
+
+HardwareSerial::HardwareSerial(int uartNumber)
+    : m_uartNumber(uartNumber),
+      m_baudRate(0),
+      m_onReceive(),
+      m_rx(),
+      m_rxRead(0),
+      m_tx()
+{
+}
+
+void HardwareSerial::begin(unsigned long baud, uint32_t, int8_t, int8_t)
+{
+    m_baudRate = baud;
+}
+
+void HardwareSerial::end()
+{
+    m_baudRate = 0;
+    m_onReceive = nullptr;
+    m_rx.clear();
+    m_rxRead = 0;
+}
+
+void HardwareSerial::updateBaudRate(unsigned long baud)
+{
+    m_baudRate = baud;
+}
+
+void HardwareSerial::onReceive(OnReceiveCb function, bool)
+{
+    m_onReceive = function;
+}
+
+bool HardwareSerial::setRxTimeout(uint8_t)
+{
+    return true;
+}
+
+bool HardwareSerial::setRxFIFOFull(uint8_t)
+{
+    return true;
+}
+
+size_t HardwareSerial::setRxBufferSize(size_t size)
+{
+    return size;
+}
+
+size_t HardwareSerial::setTxBufferSize(size_t size)
+{
+    return size;
+}
+
+int HardwareSerial::available()
+{
+    return static_cast<int>(m_rx.size() - m_rxRead);
+}
+
+int HardwareSerial::read()
+{
+    uint8_t value = 0;
+    return (read(&value, 1) == 1) ? value : -1;
+}
+
+size_t HardwareSerial::read(uint8_t *buffer, size_t size)
+{
+    const size_t count = std::min(size, m_rx.size() - m_rxRead);
+    memcpy(buffer, m_rx.data() + m_rxRead, count);
+    m_rxRead += count;
+    if (m_rxRead == m_rx.size())
+    {
+        m_rx.clear();
+        m_rxRead = 0;
+    }
+    return count;
+}
+
+size_t HardwareSerial::write(uint8_t value)
+{
+    m_tx.push_back(value);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    m_tx.insert(m_tx.end(), buffer, buffer + size);
+    return size;
+}
+
+int HardwareSerial::availableForWrite()
+{
+    // Drained instantly: the host link never backs up.
+    return static_cast<int>(kDefaultTxBufferSize);
+}
+
+void HardwareSerial::simulateReceive(const uint8_t *data, size_t length)
+{
+    m_rx.insert(m_rx.end(), data, data + length);
+    if (m_onReceive)
+    {
+        m_onReceive();
+    }
+}
+
+std::vector<uint8_t> HardwareSerial::takeTransmitted()
+{
+    std::vector<uint8_t> transmitted;
+    transmitted.swap(m_tx);
+    return transmitted;
+}
+
+// ---- TwoWire / PCA9685 ----------------------------------------------------------
+
+TwoWire::TwoWire(uint8_t busNumber)
+    : m_busNumber(busNumber),
+      m_pendingBytes(0)
+{
+}
+
+bool TwoWire::begin(int, int, uint32_t)
+{
+    return true;
+}
+
+bool TwoWire::end()
+{
+    return true;
+}
+
+bool TwoWire::setClock(uint32_t)
+{
+    return true;
+}
+
+void TwoWire::setTimeOut(uint16_t)
+{
+}
+
+void TwoWire::beginTransmission(uint8_t)
+{
+    m_pendingBytes = 0;
+}
+
+uint8_t TwoWire::endTransmission(bool)
+{
+    if (g_i2cFailing)
+    {
+        m_pendingBytes = 0;
+        return kI2cTimeoutError;
+    }
+    ++g_i2cTransactions;
+    g_i2cBytes += static_cast<uint32_t>(m_pendingBytes);
+    m_pendingBytes = 0;
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t, uint8_t)
+{
+    return 0;
+}
+
+size_t TwoWire::write(uint8_t)
+{
+    ++m_pendingBytes;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *, size_t size)
+{
+    m_pendingBytes += size;
+    return size;
+}
+
+Adafruit_PWMServoDriver::Adafruit_PWMServoDriver(uint8_t address, TwoWire &wire)
+    : m_address(address),
+      m_wire(&wire)
+{
+}
+
+bool Adafruit_PWMServoDriver::begin(uint8_t)
+{
+    reset();
+    return true;
+}
+
+void Adafruit_PWMServoDriver::reset()
+{
+    m_wire->beginTransmission(m_address);
+    m_wire->write(static_cast<uint8_t>(0x00));
+    m_wire->endTransmission();
+}
+
+void Adafruit_PWMServoDriver::setOscillatorFrequency(uint32_t)
+{
+}
+
+void Adafruit_PWMServoDriver::setPWMFreq(float)
+{
+}
+
+uint8_t Adafruit_PWMServoDriver::setPWM(uint8_t channel, uint16_t on, uint16_t off)
+{
+    const uint8_t registers[] = {static_cast<uint8_t>(0x06 + 4 * channel), static_cast<uint8_t>(on),
+                                 static_cast<uint8_t>(on >> 8), static_cast<uint8_t>(off),
+                                 static_cast<uint8_t>(off >> 8)};
+    m_wire->beginTransmission(m_address);
+    m_wire->write(registers, sizeof(registers));
+    return m_wire->endTransmission();
+}
+
+// ---- Preferences ----------------------------------------------------------------
+
+bool Preferences::begin(const char *name, bool readOnly, const char *)
+{
+    m_namespace = name;
+    m_readOnly = readOnly;
+    // Read-only opens of a namespace that was never written fail, as on NVS.
+    return !readOnly || g_preferences.count(name) != 0;
+}
+
+void Preferences::end()
+{
+    m_namespace = nullptr;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t length)
+{
+    if (m_namespace == nullptr || m_readOnly)
+    {
+        return 0;
+    }
+    const auto *bytes = static_cast<const uint8_t *>(value);
+    g_preferences[m_namespace][key].assign(bytes, bytes + length);
+    return length;
+}
+
+size_t Preferences::getBytes(const char *key, void *buffer, size_t maxLength)
+{
+    const size_t length = getBytesLength(key);
+    if (length == 0 || length > maxLength)
+    {
+        return 0;
+    }
+    memcpy(buffer, g_preferences[m_namespace][key].data(), length);
+    return length;
+}
+
+size_t Preferences::getBytesLength(const char *key)
+{
+    return isKey(key) ? g_preferences[m_namespace][key].size() : 0;
+}
+
+bool Preferences::isKey(const char *key)
+{
+    if (m_namespace == nullptr)
+    {
+        return false;
+    }
+    const auto space = g_preferences.find(m_namespace);
+    return space != g_preferences.end() && space->second.count(key) != 0;
+}
+
+bool Preferences::remove(const char *key)
+{
+    if (m_namespace == nullptr || m_readOnly)
+    {
+        return false;
+    }
+    return g_preferences[m_namespace].erase(key) != 0;
+}
+
+bool Preferences::clear()
+{
+    if (m_namespace == nullptr || m_readOnly)
+    {
+        return false;
+    }
+    g_preferences[m_namespace].clear();
+    return true;
+}
+
+// ---- Pulse counter --------------------------------------------------------------
+
+esp_err_t pcnt_unit_config(const pcnt_config_t *)
+{
+    return ESP_FAIL;
+}
+
+esp_err_t pcnt_set_filter_value(pcnt_unit_t, uint16_t)
+{
+    return ESP_FAIL;
+}
+
+esp_err_t pcnt_filter_enable(pcnt_unit_t)
+{
+    return ESP_FAIL;
+}
+
+esp_err_t pcnt_counter_pause(pcnt_unit_t)
+{
+    return ESP_FAIL;
+}
+
+esp_err_t pcnt_counter_clear(pcnt_unit_t)
+{
+    return ESP_FAIL;
+}
+
+esp_err_t pcnt_counter_resume(pcnt_unit_t)
+{
+    return ESP_FAIL;
+}
+
+esp_err_t pcnt_get_counter_value(pcnt_unit_t, int16_t *count)
+{
+    *count = 0;
+    return ESP_FAIL;
+}
+
+// ---- FreeRTOS -------------------------------------------------------------------
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char *, uint32_t, void *, UBaseType_t, TaskHandle_t *,
+                                   BaseType_t)
+{
+    return pdFAIL;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    g_nowMicros += static_cast<uint64_t>(ticks) * portTICK_PERIOD_MS * 1000u;
+}
+
+void vTaskDelayUntil(TickType_t *previousWake, TickType_t period)
+{
+    *previousWake += period;
+    const uint64_t wakeMicros = static_cast<uint64_t>(*previousWake) * portTICK_PERIOD_MS * 1000u;
+    if (wakeMicros > g_nowMicros)
+    {
+        g_nowMicros = wakeMicros;
+    }
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return static_cast<TickType_t>(g_nowMicros / (portTICK_PERIOD_MS * 1000u));
+}
+
+void vTaskDelete(TaskHandle_t)
+{
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return nullptr;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t)
+{
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t, TickType_t)
+{
+    return 0;
+}
+
+// ---- Task watchdog --------------------------------------------------------------
+
+esp_err_t esp_task_wdt_init(uint32_t, bool)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_add(TaskHandle_t)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_reset()
+{
+    return ESP_OK;
+}
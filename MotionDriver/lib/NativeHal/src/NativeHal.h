@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Bench-side controls for the host HAL: the simulated clock, and what the firmware
+// has driven onto its outputs.
+namespace hal
+{
+
+    constexpr uint8_t kLedcChannelCount = 16;
+    constexpr uint8_t kGpioCount = 40;
+
+    // Simulated time. Starts at 0 and only moves when told to (or on delay()).
+    uint64_t nowMicros();
+    void setMicros(uint64_t micros);
+    void advanceMicros(uint64_t micros);
+
+    // Last duty written to an LEDC channel, and the simulated time it last changed.
+    uint32_t ledcDuty(uint8_t channel);
+    uint64_t ledcChangedAtMicros(uint8_t channel);
+    uint32_t ledcWriteCount();
+
+    int gpioLevel(uint8_t pin);
+
+    // Completed I2C transactions and the payload bytes they carried.
+    uint32_t i2cTransactions();
+    uint32_t i2cBytes();
+    // While set, every I2C transaction fails as a timeout (error 5) would, the way
+    // a bus held low by a slave does.
+    void setI2cFailing(bool failing);
+
+    // Back to power-on: clock at 0, outputs low, counters, serial buffers and NVS
+    // cleared.
+    void reset();
+
+} // namespace hal
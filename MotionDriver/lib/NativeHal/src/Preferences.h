@@ -0,0 +1,23 @@
+#pragma once
+
+#include <Arduino.h>
+
+// NVS stand-in held in memory for the life of the process: namespaces persist across
+// begin()/end(), so a save followed by a load round-trips like it would on flash.
+class Preferences
+{
+public:
+    bool begin(const char *name, bool readOnly = false, const char *partitionLabel = nullptr);
+    void end();
+
+    size_t putBytes(const char *key, const void *value, size_t length);
+    size_t getBytes(const char *key, void *buffer, size_t maxLength);
+    size_t getBytesLength(const char *key);
+    bool isKey(const char *key);
+    bool remove(const char *key);
+    bool clear();
+
+private:
+    const char *m_namespace = nullptr;
+    bool m_readOnly = false;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Records transactions instead of clocking a bus; every device ACKs.
+class TwoWire : public Stream
+{
+public:
+    explicit TwoWire(uint8_t busNumber);
+
+    bool begin(int sdaPin = -1, int sclPin = -1, uint32_t frequency = 0);
+    bool end();
+    bool setClock(uint32_t frequency);
+    void setTimeOut(uint16_t timeoutMs);
+
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t size);
+
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+
+private:
+    uint8_t m_busNumber;
+    size_t m_pendingBytes;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
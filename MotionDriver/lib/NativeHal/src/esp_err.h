@@ -0,0 +1,6 @@
+#pragma once
+
+// The ESP-IDF error codes the stand-ins return.
+typedef int esp_err_t;
+constexpr esp_err_t ESP_OK = 0;
+constexpr esp_err_t ESP_FAIL = -1;
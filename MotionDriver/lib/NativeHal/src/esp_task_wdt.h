@@ -0,0 +1,13 @@
+#pragma once
+
+// Task watchdog stand-in. Nothing resets the host, so subscribing and feeding only
+// succeed; the benchmarks drive stalls through the health monitor's heartbeats.
+
+#include <cstdint>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+esp_err_t esp_task_wdt_init(uint32_t timeoutSeconds, bool panic);
+esp_err_t esp_task_wdt_add(TaskHandle_t task);
+esp_err_t esp_task_wdt_reset();
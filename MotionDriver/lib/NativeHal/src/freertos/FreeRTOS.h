@@ -0,0 +1,20 @@
+#pragma once
+
+// Types and macros only. The host has no scheduler: the bench steps the task bodies
+// itself on the simulated clock (see scheduler::ControlScheduler's *Tick methods).
+
+#include <cstdint>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void *TaskHandle_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY 0xffffffffUL
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms) * configTICK_RATE_HZ / 1000)
@@ -0,0 +1,93 @@
+#include "ActuationLatency.h"
+
+namespace diagnostics
+{
+
+    namespace
+    {
+        const char *const kPathNames[ActuationLatency::kPathCount] = {
+            "rx_to_parse",
+            "rx_to_motor_pwm",
+            "rx_to_servo_pwm"};
+    }
+
+    uint32_t ActuationLatency::stamp() const
+    {
+        if (!enabled())
+        {
+            return 0;
+        }
+        // 0 means untracked, so a stamp landing exactly on a micros() wrap is nudged
+        // to the microsecond before it.
+        const uint32_t nowUs = micros();
+        return (nowUs != 0) ? nowUs : UINT32_MAX;
+    }
+
+    void ActuationLatency::record(LatencyPath path, uint32_t stampUs)
+    {
+        const size_t index = static_cast<size_t>(path);
+        if (stampUs == 0 || index >= kPathCount)
+        {
+            return;
+        }
+        m_paths[index].record(micros() - stampUs);
+    }
+
+    void ActuationLatency::reset()
+    {
+        for (size_t index = 0; index < kPathCount; ++index)
+        {
+            m_paths[index].requestReset();
+        }
+    }
+
+    void ActuationLatency::print(Print &out) const
+    {
+        for (size_t index = 0; index < kPathCount; ++index)
+        {
+            const PathHistogram::Summary summary = m_paths[index].summarize();
+            out.printf("LAT %s n=%lu p50_us=%lu p99_us=%lu p999_us=%lu max_us=%lu\n",
+                       kPathNames[index],
+                       static_cast<unsigned long>(summary.count),
+                       static_cast<unsigned long>(summary.p50),
+                       static_cast<unsigned long>(summary.p99),
+                       static_cast<unsigned long>(summary.p999),
+                       static_cast<unsigned long>(summary.maxValue));
+        }
+    }
+
+    const char *ActuationLatency::pathName(LatencyPath path)
+    {
+        const size_t index = static_cast<size_t>(path);
+        return (index < kPathCount) ? kPathNames[index] : "?";
+    }
+
+    void PendingActuations::add(uint32_t stampUs, uint32_t outputMask)
+    {
+        if (stampUs == 0 || outputMask == 0 || m_count >= kCapacity)
+        {
+            return;
+        }
+        m_pending[m_count++] = Pending{stampUs, outputMask};
+    }
+
+    void PendingActuations::update(ActuationLatency &latency, LatencyPath path, uint32_t writtenMask)
+    {
+        const uint32_t nowUs = micros();
+        size_t kept = 0;
+        for (size_t index = 0; index < m_count; ++index)
+        {
+            const Pending &pending = m_pending[index];
+            if ((pending.outputMask & writtenMask) != 0)
+            {
+                latency.record(path, pending.stampUs);
+            }
+            else if (nowUs - pending.stampUs < kExpiryUs)
+            {
+                m_pending[kept++] = pending;
+            }
+        }
+        m_count = kept;
+    }
+
+} // namespace diagnostics
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+#include "diagnostics/LatencyHistogram.h"
+
+namespace diagnostics
+{
+
+    // Command-to-output latency in microseconds, 16 sub-buckets per power of two:
+    // percentiles within 1/16 (6.25%), exact below 32 us, and anything past ~1 s in
+    // the top bucket.
+    using PathHistogram = LatencyHistogram<4, 19>;
+
+    enum class LatencyPath : uint8_t
+    {
+        RxToParse,    // command task: line/frame framed -> parser picks it up
+        RxToMotorPwm, // motor task: line/frame framed -> the LEDC write it caused
+        RxToServoPwm, // servo task: line/frame framed -> the PCA9685 burst carrying it
+        Count
+    };
+
+    // The LAT benchmark. While enabled, every line or frame is stamped with micros()
+    // as the receive side frames it; the stamp rides the queued command to the motor
+    // or servo task, which records how long after it the output actually changed.
+    // micros() rather than cycle counts: the stamp and the record are taken on
+    // different cores, and only the esp_timer clock is shared between them.
+    class ActuationLatency
+    {
+    public:
+        static constexpr size_t kPathCount = static_cast<size_t>(LatencyPath::Count);
+
+        void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+        bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+        // Receive stamp for a line/frame just framed; 0 (untracked) while disabled.
+        uint32_t stamp() const;
+        // Records the time since stampUs; a 0 stamp is ignored. Each path has a single
+        // writer: the task named against it above.
+        void record(LatencyPath path, uint32_t stampUs);
+
+        void reset();
+        // One 'LAT <path> n=.. p50_us=.. p99_us=.. p999_us=.. max_us=..' line each.
+        void print(Print &out) const;
+
+        static const char *pathName(LatencyPath path);
+
+    private:
+        std::atomic<bool> m_enabled{false};
+        PathHistogram m_paths[kPathCount];
+    };
+
+    // Stamps of commands an output task has applied but whose effect has not reached
+    // the pins yet: a ramp held back by the power budget, or a servo burst that must
+    // wait for the next flush. Each carries the mask of outputs its command retargeted
+    // and is recorded on the first write to any of them. Owned by that task.
+    class PendingActuations
+    {
+    public:
+        // The command queues' depth: more can not be applied between two ticks.
+        static constexpr size_t kCapacity = 16;
+        // Backstop for a write that never comes (a dead I2C bus): the stamp is dropped
+        // rather than charged to whatever write eventually follows.
+        static constexpr uint32_t kExpiryUs = 250000;
+
+        void add(uint32_t stampUs, uint32_t outputMask);
+        bool empty() const { return m_count == 0; }
+        // Records, and forgets, every stamp waiting on an output in writtenMask; drops
+        // the rest once they pass kExpiryUs.
+        void update(ActuationLatency &latency, LatencyPath path, uint32_t writtenMask);
+
+    private:
+        struct Pending
+        {
+            uint32_t stampUs;
+            uint32_t outputMask;
+        };
+
+        Pending m_pending[kCapacity] = {};
+        size_t m_count = 0;
+    };
+
+} // namespace diagnostics
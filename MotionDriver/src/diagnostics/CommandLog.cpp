@@ -0,0 +1,144 @@
+#include "CommandLog.h"
+
+#include <cstring>
+
+#include "inputs/BinaryFrame.h"
+
+namespace diagnostics
+{
+
+    namespace
+    {
+        constexpr char kHexDigits[] = "0123456789ABCDEF";
+    }
+
+    void CommandLog::record(Kind kind, uint32_t atUs, const void *data, size_t length)
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        length = (length > kMaxDataLength) ? kMaxDataLength : length;
+        const size_t size = kHeaderBytes + length;
+        while (m_used + size > kCapacityBytes)
+        {
+            dropOldest();
+        }
+
+        const uint8_t header[kHeaderBytes] = {
+            static_cast<uint8_t>(atUs),
+            static_cast<uint8_t>(atUs >> 8),
+            static_cast<uint8_t>(atUs >> 16),
+            static_cast<uint8_t>(atUs >> 24),
+            static_cast<uint8_t>(kind),
+            static_cast<uint8_t>(length)};
+        const size_t tail = (m_head + m_used) % kCapacityBytes;
+        write(tail, header, kHeaderBytes);
+        write((tail + kHeaderBytes) % kCapacityBytes, static_cast<const uint8_t *>(data), length);
+        m_used += size;
+        ++m_entries;
+    }
+
+    void CommandLog::clear()
+    {
+        m_head = 0;
+        m_used = 0;
+        m_entries = 0;
+        m_overwritten = 0;
+    }
+
+    void CommandLog::dump(Print &out) const
+    {
+        out.printf("# RECORD entries=%lu overwritten=%lu bytes=%lu/%lu enabled=%d\n",
+                   static_cast<unsigned long>(m_entries), static_cast<unsigned long>(m_overwritten),
+                   static_cast<unsigned long>(m_used), static_cast<unsigned long>(kCapacityBytes),
+                   m_enabled ? 1 : 0);
+
+        uint8_t header[kHeaderBytes];
+        uint8_t data[kMaxDataLength];
+        bool first = true;
+        uint32_t originUs = 0;
+        size_t offset = m_head;
+        for (uint32_t entry = 0; entry < m_entries; ++entry)
+        {
+            read(offset, header, kHeaderBytes);
+            const uint32_t atUs = static_cast<uint32_t>(header[0]) | (static_cast<uint32_t>(header[1]) << 8) |
+                                  (static_cast<uint32_t>(header[2]) << 16) |
+                                  (static_cast<uint32_t>(header[3]) << 24);
+            const Kind kind = static_cast<Kind>(header[4]);
+            const size_t length = header[5];
+            read((offset + kHeaderBytes) % kCapacityBytes, data, length);
+            offset = (offset + kHeaderBytes + length) % kCapacityBytes;
+
+            if (first)
+            {
+                originUs = atUs;
+                first = false;
+            }
+            // Wrap-safe, so a capture spanning a micros() rollover still reads in order.
+            const uint32_t sinceUs = atUs - originUs;
+            const bool comment = (kind == Kind::Failsafe || kind == Kind::Rejected);
+            out.printf("%s%lu.%03lu ", comment ? "# " : "", static_cast<unsigned long>(sinceUs / 1000),
+                       static_cast<unsigned long>(sinceUs % 1000));
+
+            switch (kind)
+            {
+            case Kind::Line:
+                out.write(data, length);
+                break;
+            case Kind::Frame:
+                out.print('%');
+                out.print(kHexDigits[inputs::frame::kSync >> 4]);
+                out.print(kHexDigits[inputs::frame::kSync & 0x0F]);
+                for (size_t index = 0; index < length; ++index)
+                {
+                    out.print(kHexDigits[data[index] >> 4]);
+                    out.print(kHexDigits[data[index] & 0x0F]);
+                }
+                break;
+            case Kind::EmergencyStop:
+                out.print("^C");
+                break;
+            case Kind::Failsafe:
+                out.print("FAILSAFE");
+                break;
+            case Kind::Rejected:
+                out.print("REJECTED ");
+                out.write(data, length);
+                break;
+            }
+            out.print('\n');
+        }
+    }
+
+    void CommandLog::write(size_t offset, const uint8_t *data, size_t length)
+    {
+        if (length == 0)
+        {
+            return;
+        }
+        const size_t firstPart = (length < kCapacityBytes - offset) ? length : kCapacityBytes - offset;
+        memcpy(m_ring + offset, data, firstPart);
+        memcpy(m_ring, data + firstPart, length - firstPart);
+    }
+
+    void CommandLog::read(size_t offset, uint8_t *data, size_t length) const
+    {
+        const size_t firstPart = (length < kCapacityBytes - offset) ? length : kCapacityBytes - offset;
+        memcpy(data, m_ring + offset, firstPart);
+        memcpy(data + firstPart, m_ring, length - firstPart);
+    }
+
+    void CommandLog::dropOldest()
+    {
+        uint8_t header[kHeaderBytes];
+        read(m_head, header, kHeaderBytes);
+        const size_t size = kHeaderBytes + header[5];
+        m_head = (m_head + size) % kCapacityBytes;
+        m_used -= size;
+        --m_entries;
+        ++m_overwritten;
+    }
+
+} // namespace diagnostics
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace diagnostics
+{
+
+    // Flight recorder for one command link: every line and frame it received, as
+    // framed, plus the E-STOPs and deadman trips, in a fixed RAM ring that
+    // overwrites its oldest entries. RECORD DUMP prints it in the replay capture
+    // format (src/replay/Capture.h), so a field capture runs back through the same
+    // firmware on the host.
+    //
+    // Single writer: the command task of the port it is attached to, which is also
+    // the only task that dumps it, so nothing here is shared between tasks.
+    class CommandLog
+    {
+    public:
+        enum class Kind : uint8_t
+        {
+            Line,          // a text line, without CR/LF
+            Frame,         // a binary frame: opcode, payload, crc (the sync byte is implied)
+            EmergencyStop, // the E-STOP byte
+            Failsafe,      // the deadman tripped
+            Rejected       // refused while framing; the data is the ERR text
+        };
+
+        // ~400 Drive frames or ~250 MOTOR lines: the last several seconds of teleop.
+        static constexpr size_t kCapacityBytes = 8192;
+        static constexpr size_t kMaxDataLength = UINT8_MAX;
+
+        // atUs is micros() when the unit was framed. Data past kMaxDataLength is cut.
+        // Does nothing while disabled.
+        void record(Kind kind, uint32_t atUs, const void *data = nullptr, size_t length = 0);
+
+        // On from boot, so a fault is already on record when someone asks. Turning it
+        // off freezes what is there.
+        void setEnabled(bool enabled) { m_enabled = enabled; }
+        bool enabled() const { return m_enabled; }
+        void clear();
+
+        uint32_t entryCount() const { return m_entries; }
+        // Entries dropped to make room since the last clear().
+        uint32_t overwritten() const { return m_overwritten; }
+        size_t usedBytes() const { return m_used; }
+
+        // A '# RECORD ...' summary, then one row per entry oldest first, with times in
+        // ms since the oldest. Ends without a reply line.
+        void dump(Print &out) const;
+
+    private:
+        // uint32 atUs, uint8 kind, uint8 length; the data follows.
+        static constexpr size_t kHeaderBytes = 6;
+
+        void write(size_t offset, const uint8_t *data, size_t length);
+        void read(size_t offset, uint8_t *data, size_t length) const;
+        void dropOldest();
+
+        uint8_t m_ring[kCapacityBytes];
+        // Offset of the oldest entry, and bytes in use from there (wrapping).
+        size_t m_head = 0;
+        size_t m_used = 0;
+        uint32_t m_entries = 0;
+        uint32_t m_overwritten = 0;
+        bool m_enabled = true;
+    };
+
+} // namespace diagnostics
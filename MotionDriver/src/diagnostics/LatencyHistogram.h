@@ -0,0 +1,206 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace diagnostics
+{
+
+    // Duration distribution in whatever unit the caller records: CPU cycles for the
+    // STATS stages, microseconds for LAT. Each power of two is split into
+    // 2^SubBucketBits linear sub-buckets, so a percentile read off it overstates by
+    // at most 1/2^SubBucketBits (2x with none). Values from 2^(TopBit + 1) up land in
+    // the top bucket; count, min, mean and max stay exact.
+    //
+    // Single writer: only the task that owns the histogram calls record(). Any task
+    // may read summarize() or requestReset(). The writer publishes count and sum under
+    // a sequence counter so a reader on the other core never pairs a new count with
+    // an old sum; min, max and the buckets are plain single-word atomics.
+    template <uint8_t SubBucketBits, uint8_t TopBit>
+    class LatencyHistogram
+    {
+    public:
+        static constexpr uint32_t kSubBuckets = 1u << SubBucketBits;
+        static constexpr size_t kBucketCount = kSubBuckets * (TopBit - SubBucketBits + 2);
+        static_assert(SubBucketBits <= TopBit && TopBit < 32, "Buckets must fit a uint32_t");
+
+        struct Summary
+        {
+            uint32_t count;
+            uint32_t minValue;
+            uint32_t maxValue;
+            uint32_t meanValue;
+            // Upper edges of the buckets holding each percentile, capped at maxValue.
+            uint32_t p50;
+            uint32_t p99;
+            uint32_t p999;
+        };
+
+        void record(uint32_t value)
+        {
+            if (m_resetRequested.load(std::memory_order_acquire))
+            {
+                // Dropped only once the clear is done, so a reader never sees half of one.
+                clear();
+                m_resetRequested.store(false, std::memory_order_release);
+            }
+
+            // Odd sequence = update in progress; summarize() retries until it sees the
+            // same even value either side of its reads.
+            const uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+            m_sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            const uint32_t sumLow = m_sumLow.load(std::memory_order_relaxed);
+            const uint32_t newLow = sumLow + value;
+            if (newLow < sumLow)
+            {
+                m_sumHigh.store(m_sumHigh.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+            m_sumLow.store(newLow, std::memory_order_relaxed);
+            m_count.store(m_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_release);
+            m_sequence.store(sequence + 2, std::memory_order_relaxed);
+
+            if (value < m_minValue.load(std::memory_order_relaxed))
+            {
+                m_minValue.store(value, std::memory_order_relaxed);
+            }
+            if (value > m_maxValue.load(std::memory_order_relaxed))
+            {
+                m_maxValue.store(value, std::memory_order_relaxed);
+            }
+            auto &bucket = m_buckets[bucketFor(value)];
+            bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        // The writer clears on its next record(), so the clear never races it; until
+        // then summarize() already reads empty.
+        void requestReset() { m_resetRequested.store(true, std::memory_order_release); }
+
+        Summary summarize() const
+        {
+            Summary summary{};
+            if (m_resetRequested.load(std::memory_order_acquire))
+            {
+                return summary;
+            }
+
+            uint32_t count = 0;
+            uint64_t sum = 0;
+            for (;;)
+            {
+                const uint32_t before = m_sequence.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                count = m_count.load(std::memory_order_relaxed);
+                sum = (static_cast<uint64_t>(m_sumHigh.load(std::memory_order_relaxed)) << 32) |
+                      m_sumLow.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if ((before & 1u) == 0 && m_sequence.load(std::memory_order_relaxed) == before)
+                {
+                    break;
+                }
+            }
+
+            summary.count = count;
+            if (count == 0)
+            {
+                return summary;
+            }
+
+            summary.minValue = m_minValue.load(std::memory_order_relaxed);
+            summary.maxValue = m_maxValue.load(std::memory_order_relaxed);
+            summary.meanValue = static_cast<uint32_t>(sum / count);
+
+            // The buckets are read without the sequence guard, so they may run a sample
+            // or two ahead of count; rank the percentiles against their own total.
+            uint32_t total = 0;
+            for (size_t index = 0; index < kBucketCount; ++index)
+            {
+                total += m_buckets[index].load(std::memory_order_relaxed);
+            }
+            summary.p50 = percentile(total, 500, summary.maxValue);
+            summary.p99 = percentile(total, 990, summary.maxValue);
+            summary.p999 = percentile(total, 999, summary.maxValue);
+            return summary;
+        }
+
+    private:
+        static size_t bucketFor(uint32_t value)
+        {
+            if (value < 2 * kSubBuckets)
+            {
+                return value;
+            }
+            const uint8_t topBit = static_cast<uint8_t>(31 - __builtin_clz(value));
+            if (topBit > TopBit)
+            {
+                return kBucketCount - 1;
+            }
+            // The SubBucketBits bits under the top one pick the sub-bucket.
+            const uint8_t shift = topBit - SubBucketBits;
+            const uint32_t subBucket = (value >> shift) - kSubBuckets;
+            return kSubBuckets * (shift + 1) + subBucket;
+        }
+
+        // Largest value that lands in the bucket.
+        static uint32_t upperEdge(size_t bucket)
+        {
+            if (bucket < 2 * kSubBuckets)
+            {
+                return static_cast<uint32_t>(bucket);
+            }
+            const uint8_t shift = static_cast<uint8_t>(bucket / kSubBuckets - 1);
+            const uint64_t subBucket = bucket % kSubBuckets;
+            return static_cast<uint32_t>(((kSubBuckets + subBucket + 1) << shift) - 1);
+        }
+
+        uint32_t percentile(uint32_t total, uint32_t perMille, uint32_t maxValue) const
+        {
+            // Rank of the sample at perMille, rounded up so p999 of 100 samples is the max.
+            const uint32_t rank = static_cast<uint32_t>((static_cast<uint64_t>(total) * perMille + 999) / 1000);
+            uint32_t cumulative = 0;
+            for (size_t index = 0; index < kBucketCount; ++index)
+            {
+                cumulative += m_buckets[index].load(std::memory_order_relaxed);
+                if (cumulative >= rank && cumulative != 0)
+                {
+                    const uint32_t edge = upperEdge(index);
+                    return (edge < maxValue) ? edge : maxValue;
+                }
+            }
+            return maxValue;
+        }
+
+        void clear()
+        {
+            const uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+            m_sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_count.store(0, std::memory_order_relaxed);
+            m_sumLow.store(0, std::memory_order_relaxed);
+            m_sumHigh.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_sequence.store(sequence + 2, std::memory_order_relaxed);
+
+            m_minValue.store(UINT32_MAX, std::memory_order_relaxed);
+            m_maxValue.store(0, std::memory_order_relaxed);
+            for (size_t index = 0; index < kBucketCount; ++index)
+            {
+                m_buckets[index].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        std::atomic<uint32_t> m_sequence{0};
+        std::atomic<uint32_t> m_count{0};
+        std::atomic<uint32_t> m_sumLow{0};
+        std::atomic<uint32_t> m_sumHigh{0};
+        std::atomic<uint32_t> m_minValue{UINT32_MAX};
+        std::atomic<uint32_t> m_maxValue{0};
+        std::atomic<uint32_t> m_buckets[kBucketCount]{};
+        std::atomic<bool> m_resetRequested{false};
+    };
+
+} // namespace diagnostics
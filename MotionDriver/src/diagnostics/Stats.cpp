@@ -0,0 +1,96 @@
+#include "Stats.h"
+
+namespace diagnostics
+{
+
+    namespace
+    {
+        const char *const kStageNames[Stats::kStageCount] = {
+            "poll",
+            "cmd_update",
+            "motor_tick",
+            "motor_period",
+            "servo_update",
+            "i2c_flush"};
+
+        void resetCounter(std::atomic<uint32_t> &counter)
+        {
+            counter.store(0, std::memory_order_relaxed);
+        }
+
+        uint32_t read(const std::atomic<uint32_t> &counter)
+        {
+            return counter.load(std::memory_order_relaxed);
+        }
+    }
+
+    const char *Stats::stageName(Stage stage)
+    {
+        const size_t index = static_cast<size_t>(stage);
+        return (index < kStageCount) ? kStageNames[index] : "?";
+    }
+
+    void Stats::print(Print &out, uint32_t nowMs, uint32_t telemetrySkipped) const
+    {
+        const float cyclesPerUs = static_cast<float>(ESP.getCpuFreqMHz());
+
+        out.printf("STATS window_ms=%lu\n", static_cast<unsigned long>(nowMs - m_windowStartMs));
+        for (size_t index = 0; index < kStageCount; ++index)
+        {
+            const StageHistogram::Summary summary = m_stages[index].summarize();
+            out.printf("STAGE %s n=%lu min_us=%.1f mean_us=%.1f p99_us=%.1f max_us=%.1f\n",
+                       kStageNames[index],
+                       static_cast<unsigned long>(summary.count),
+                       summary.minValue / cyclesPerUs,
+                       summary.meanValue / cyclesPerUs,
+                       summary.p99 / cyclesPerUs,
+                       summary.maxValue / cyclesPerUs);
+        }
+        out.printf("COUNT lines=%lu frames=%lu errors=%lu line_too_long=%lu frame_errors=%lu "
+                   "rx_overflows=%lu busy=%lu superseded=%lu failsafe=%lu estop=%lu i2c_failures=%lu i2c_recoveries=%lu "
+                   "motor_overruns=%lu command_overruns=%lu servo_overruns=%lu shed=%lu telemetry_skipped=%lu\n",
+                   static_cast<unsigned long>(read(m_counters.linesParsed)),
+                   static_cast<unsigned long>(read(m_counters.framesParsed)),
+                   static_cast<unsigned long>(read(m_counters.errorReplies)),
+                   static_cast<unsigned long>(read(m_counters.lineTooLong)),
+                   static_cast<unsigned long>(read(m_counters.frameErrors)),
+                   static_cast<unsigned long>(read(m_counters.rxOverflows)),
+                   static_cast<unsigned long>(read(m_counters.busyRejects)),
+                   static_cast<unsigned long>(read(m_counters.supersededTargets)),
+                   static_cast<unsigned long>(read(m_counters.failsafeTrips)),
+                   static_cast<unsigned long>(read(m_counters.emergencyStops)),
+                   static_cast<unsigned long>(read(m_counters.i2cFlushFailures)),
+                   static_cast<unsigned long>(read(m_counters.i2cRecoveries)),
+                   static_cast<unsigned long>(read(m_counters.motorOverruns)),
+                   static_cast<unsigned long>(read(m_counters.commandOverruns)),
+                   static_cast<unsigned long>(read(m_counters.servoOverruns)),
+                   static_cast<unsigned long>(read(m_counters.shedCommands)),
+                   static_cast<unsigned long>(telemetrySkipped));
+    }
+
+    void Stats::reset(uint32_t nowMs)
+    {
+        for (size_t index = 0; index < kStageCount; ++index)
+        {
+            m_stages[index].requestReset();
+        }
+        resetCounter(m_counters.linesParsed);
+        resetCounter(m_counters.framesParsed);
+        resetCounter(m_counters.errorReplies);
+        resetCounter(m_counters.lineTooLong);
+        resetCounter(m_counters.frameErrors);
+        resetCounter(m_counters.rxOverflows);
+        resetCounter(m_counters.busyRejects);
+        resetCounter(m_counters.supersededTargets);
+        resetCounter(m_counters.failsafeTrips);
+        resetCounter(m_counters.emergencyStops);
+        resetCounter(m_counters.i2cFlushFailures);
+        resetCounter(m_counters.i2cRecoveries);
+        resetCounter(m_counters.motorOverruns);
+        resetCounter(m_counters.commandOverruns);
+        resetCounter(m_counters.servoOverruns);
+        resetCounter(m_counters.shedCommands);
+        m_windowStartMs = nowMs;
+    }
+
+} // namespace diagnostics
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+#include "diagnostics/ActuationLatency.h"
+#include "diagnostics/LatencyHistogram.h"
+
+namespace diagnostics
+{
+
+    // CPU cycle counter of the calling core. Only compare two readings taken on the
+    // same core -- every task here is pinned, so a start/end pair always is.
+    inline uint32_t cycleCount()
+    {
+        return ESP.getCycleCount();
+    }
+
+    // Stage timings in CPU cycles on plain power-of-two buckets: kept small, since
+    // there is one per stage and STATS only needs a rough p99 beside the exact
+    // min, mean and max.
+    using StageHistogram = LatencyHistogram<0, 31>;
+
+    enum class Stage : uint8_t
+    {
+        CommandPoll,   // command task: parse everything waiting in the receive ring
+        CommandUpdate, // command task: deadman, ACK flush, telemetry
+        MotorTick,     // motor task: drain queue + MotorController::update
+        MotorPeriod,   // motor task: start-to-start interval (1000 us is on time)
+        ServoUpdate,   // servo task: drain queue + sweep advance
+        I2cFlush,      // servo task: PCA9685 burst write
+        Count
+    };
+
+    // Event counters. Incremented from whichever task sees the event; reset zeroes
+    // them in place, which at worst loses an increment that lands in the same instant.
+    struct Counters
+    {
+        std::atomic<uint32_t> linesParsed{0};
+        std::atomic<uint32_t> framesParsed{0};
+        std::atomic<uint32_t> errorReplies{0}; // every ERR line, including the ones below
+        std::atomic<uint32_t> lineTooLong{0};
+        std::atomic<uint32_t> frameErrors{0};  // bad opcode or CRC
+        std::atomic<uint32_t> rxOverflows{0};  // events, not lines: one per ERR RX overflow
+        std::atomic<uint32_t> busyRejects{0};
+        std::atomic<uint32_t> supersededTargets{0}; // replaced in an output task's mailbox unapplied
+        std::atomic<uint32_t> failsafeTrips{0};
+        std::atomic<uint32_t> emergencyStops{0};
+        std::atomic<uint32_t> i2cFlushFailures{0};
+        std::atomic<uint32_t> i2cRecoveries{0};   // bus recoveries attempted after repeated failures
+        std::atomic<uint32_t> motorOverruns{0};   // motor ticks that started late or ran over a period
+        std::atomic<uint32_t> commandOverruns{0}; // command ticks over ControlScheduler::kCommandOverrunUs
+        std::atomic<uint32_t> servoOverruns{0};   // servo ticks over a servo period
+        std::atomic<uint32_t> shedCommands{0};    // dropped by the degradation ladder (scheduler/HealthMonitor.h)
+    };
+
+    class Stats
+    {
+    public:
+        static constexpr size_t kStageCount = static_cast<size_t>(Stage::Count);
+
+        void record(Stage stage, uint32_t cycles) { m_stages[static_cast<size_t>(stage)].record(cycles); }
+        static void increment(std::atomic<uint32_t> &counter) { counter.fetch_add(1, std::memory_order_relaxed); }
+        static void add(std::atomic<uint32_t> &counter, uint32_t amount) { counter.fetch_add(amount, std::memory_order_relaxed); }
+
+        Counters &counters() { return m_counters; }
+        // Command-to-output timings for LAT; kept apart from STATS and its RESET.
+        ActuationLatency &actuation() { return m_actuation; }
+
+        // Prints one line per stage and one of counters, ending without a reply line.
+        // The reporter keeps its own skip count, so it is passed in to print alongside.
+        void print(Print &out, uint32_t nowMs, uint32_t telemetrySkipped) const;
+        void reset(uint32_t nowMs);
+
+        static const char *stageName(Stage stage);
+
+    private:
+        StageHistogram m_stages[kStageCount];
+        Counters m_counters;
+        ActuationLatency m_actuation;
+        uint32_t m_windowStartMs = 0;
+    };
+
+} // namespace diagnostics
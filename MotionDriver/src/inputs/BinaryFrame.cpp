@@ -0,0 +1,87 @@
+#include "BinaryFrame.h"
+
+#include "outputs/MotorController.h"
+#include "outputs/ServoController.h"
+
+namespace inputs
+{
+    namespace frame
+    {
+        static_assert(outputs::MotorController::kMotorCount * 2 <= kMaxPayloadLength, "Drive payload exceeds frame buffer");
+        static_assert(outputs::ServoController::kServoCount * 2 <= kMaxPayloadLength, "Servo payload exceeds frame buffer");
+        static_assert(1 + (outputs::MotorController::kMotorCount + outputs::ServoController::kServoCount) * 2 <= kMaxPayloadLength,
+                      "Keyframe payload exceeds frame buffer");
+        static_assert(outputs::MotorController::kMotorCount + outputs::ServoController::kServoCount <= 16,
+                      "Delta mask is 16 bits: one per motor and servo");
+        static_assert(kDeltaServoShift == outputs::MotorController::kMotorCount,
+                      "Delta servo bits start after the motor bits");
+        static_assert(kDeltaHeaderLength + outputs::MotorController::kMotorCount + outputs::ServoController::kServoCount <=
+                          kMaxPayloadLength,
+                      "Delta payload exceeds frame buffer");
+        static_assert(3 + (outputs::MotorController::kMotorCount + outputs::ServoController::kServoCount) * 2 <= kMaxPayloadLength,
+                      "Segment payload exceeds frame buffer");
+
+        bool payloadLength(uint8_t opcode, size_t &length)
+        {
+            switch (static_cast<Opcode>(opcode))
+            {
+            case Opcode::Ping:
+            case Opcode::StopAll:
+                length = 0;
+                return true;
+            case Opcode::Drive:
+                length = outputs::MotorController::kMotorCount * 2;
+                return true;
+            case Opcode::Servo:
+                length = outputs::ServoController::kServoCount * 2;
+                return true;
+            case Opcode::Keyframe:
+                length = 1 + (outputs::MotorController::kMotorCount + outputs::ServoController::kServoCount) * 2;
+                return true;
+            case Opcode::Delta:
+                length = kDeltaHeaderLength;
+                return true;
+            case Opcode::Segment:
+                length = 3 + (outputs::MotorController::kMotorCount + outputs::ServoController::kServoCount) * 2;
+                return true;
+            }
+            return false;
+        }
+
+        size_t lengthHeaderBytes(uint8_t opcode)
+        {
+            return (static_cast<Opcode>(opcode) == Opcode::Delta) ? kDeltaHeaderLength : 0;
+        }
+
+        bool variablePayloadLength(uint8_t opcode, const uint8_t *header, size_t &length)
+        {
+            if (static_cast<Opcode>(opcode) != Opcode::Delta)
+            {
+                return false;
+            }
+
+            const uint16_t mask = readUint16(&header[1]);
+            if ((mask & ~kDeltaFieldMask) != 0)
+            {
+                return false;
+            }
+            length = kDeltaHeaderLength + static_cast<size_t>(__builtin_popcount(mask));
+            return true;
+        }
+
+        uint8_t crc8(const uint8_t *data, size_t length)
+        {
+            uint8_t crc = 0;
+            for (size_t index = 0; index < length; ++index)
+            {
+                crc ^= data[index];
+                for (uint8_t bit = 0; bit < 8; ++bit)
+                {
+                    crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+                }
+            }
+            return crc;
+        }
+    } // namespace frame
+
+} // namespace inputs
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "board.h"
+
+namespace inputs
+{
+    // Compact binary framing that shares the UART with the text CLI. A frame is
+    //
+    //     [kSync] [opcode] [payload] [crc8]
+    //
+    // Payload length is fixed per opcode, except Delta, whose header says how many
+    // value bytes follow (see variablePayloadLength()).
+    //
+    // kSync is not printable ASCII, so it can never open a text command. The CRC covers
+    // the opcode and payload (not the sync byte). Multi-byte fields are little-endian.
+    // Speeds are signed Q15: +/-32767 is full forward/backward, 0 is stop.
+    namespace frame
+    {
+        constexpr uint8_t kSync = 0xA5;
+
+        enum class Opcode : uint8_t
+        {
+            Ping = 0x01,    // no payload; replies PONG
+            StopAll = 0x02, // no payload; same path as MOTOR ALL STOP
+            Drive = 0x10,    // int16 speed[kMotorCount]
+            Servo = 0x11,    // uint16 pulseUs[kServoCount]
+            Keyframe = 0x12, // uint8 seq, int16 speed[kMotorCount], uint16 pulseUs[kServoCount]
+            Delta = 0x13,    // uint8 seq, uint16 mask, int8 step per set mask bit
+            Segment = 0x14   // uint16 durationMs, uint8 profile, int16 speed[kMotorCount], uint16 pulseUs[kServoCount]
+        };
+
+        // Stream mode: a Keyframe sets every motor and servo and (re)starts the
+        // sequence; each Delta must carry the next sequence number and changes only
+        // the fields in its mask -- one bit per motor from bit 0, then one per servo
+        // (bits 0-5 and 6-11 on Cheddar) -- by a signed step each. Steps are deltas
+        // against the receiver's mirror, so the sender must mirror the same quantised
+        // values it sends.
+        constexpr size_t kDeltaHeaderLength = 3;
+        constexpr uint8_t kDeltaServoShift = board::Active::kWheelCount;
+        constexpr uint16_t kDeltaMotorMask = static_cast<uint16_t>((1u << kDeltaServoShift) - 1);
+        constexpr uint16_t kDeltaFieldMask = static_cast<uint16_t>((1u << (2 * board::Active::kWheelCount)) - 1);
+        constexpr int16_t kDeltaSpeedStep = 256; // Q15 per step: ~0.8% of full speed
+        constexpr uint16_t kDeltaPulseStepUs = 4;
+
+        // The largest fixed payload, Segment's: 3 header bytes and a 16-bit value per
+        // motor and servo (27 on Cheddar).
+        constexpr size_t kMaxPayloadLength = 3 + 4 * board::Active::kWheelCount;
+        constexpr size_t kMaxLengthHeaderBytes = kDeltaHeaderLength;
+        // opcode + payload + crc; the sync byte is consumed before buffering starts.
+        constexpr size_t kMaxFrameLength = 1 + kMaxPayloadLength + 1;
+        constexpr int16_t kSpeedScale = 32767;
+
+        // Payload length for a known opcode. Returns false for an unknown opcode so the
+        // receiver can drop the frame and resynchronise on the next sync byte.
+        // For Delta this is only the header; variablePayloadLength() gives the rest.
+        bool payloadLength(uint8_t opcode, size_t &length);
+
+        // Payload bytes a frame carries before its full length is known: 0 for every
+        // fixed-length opcode.
+        size_t lengthHeaderBytes(uint8_t opcode);
+        // Full payload length of a variable-length frame, from its first
+        // lengthHeaderBytes() payload bytes. False if the header is malformed.
+        bool variablePayloadLength(uint8_t opcode, const uint8_t *header, size_t &length);
+
+        // CRC-8, polynomial 0x07, initial value 0 (CRC-8/SMBUS).
+        uint8_t crc8(const uint8_t *data, size_t length);
+
+        inline int16_t readInt16(const uint8_t *data)
+        {
+            return static_cast<int16_t>(static_cast<uint16_t>(data[0]) | (static_cast<uint16_t>(data[1]) << 8));
+        }
+
+        inline uint16_t readUint16(const uint8_t *data)
+        {
+            return static_cast<uint16_t>(static_cast<uint16_t>(data[0]) | (static_cast<uint16_t>(data[1]) << 8));
+        }
+    } // namespace frame
+
+} // namespace inputs
@@ -0,0 +1,177 @@
+#include "TextCommand.h"
+
+namespace inputs
+{
+    namespace text
+    {
+        namespace
+        {
+            // 7 digits stay below 2^24, so the mantissa converts to a float exactly.
+            constexpr uint8_t kMaxSignificantDigits = 7;
+            constexpr float kPowersOfTen[kMaxSignificantDigits + 1] = {
+                1.0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f};
+
+            bool isSeparator(char c)
+            {
+                return c == ' ' || c == '\t';
+            }
+
+            bool isDigit(char c)
+            {
+                return c >= '0' && c <= '9';
+            }
+
+            char foldCase(char c)
+            {
+                return (c >= 'a' && c <= 'z') ? static_cast<char>(c - ('a' - 'A')) : c;
+            }
+
+            // Digits only, no sign; the caller has already stepped past any.
+            bool parseMagnitude(const char *digits, uint32_t &value)
+            {
+                if (*digits == '\0')
+                {
+                    return false;
+                }
+                uint32_t result = 0;
+                for (const char *cursor = digits; *cursor != '\0'; ++cursor)
+                {
+                    if (!isDigit(*cursor))
+                    {
+                        return false;
+                    }
+                    const uint32_t digit = static_cast<uint32_t>(*cursor - '0');
+                    if (result > (UINT32_MAX - digit) / 10)
+                    {
+                        return false;
+                    }
+                    result = result * 10 + digit;
+                }
+                value = result;
+                return true;
+            }
+        } // namespace
+
+        void split(char *line, Tokens &tokens)
+        {
+            tokens.count = 0;
+            char *cursor = line;
+            while (tokens.count < kMaxTokens)
+            {
+                while (isSeparator(*cursor))
+                {
+                    ++cursor;
+                }
+                if (*cursor == '\0')
+                {
+                    return;
+                }
+                tokens.items[tokens.count++] = cursor;
+                while (*cursor != '\0' && !isSeparator(*cursor))
+                {
+                    ++cursor;
+                }
+                if (*cursor == '\0')
+                {
+                    return;
+                }
+                *cursor++ = '\0';
+            }
+        }
+
+        bool equalsIgnoreCase(const char *token, const char *word)
+        {
+            for (; *token != '\0' && *word != '\0'; ++token, ++word)
+            {
+                if (foldCase(*token) != foldCase(*word))
+                {
+                    return false;
+                }
+            }
+            return *token == *word;
+        }
+
+        bool parseUnsigned(const char *token, uint32_t &value)
+        {
+            return parseMagnitude(token, value);
+        }
+
+        bool parseSigned(const char *token, int32_t &value)
+        {
+            const bool negative = (*token == '-');
+            if (negative || *token == '+')
+            {
+                ++token;
+            }
+            uint32_t magnitude = 0;
+            if (!parseMagnitude(token, magnitude))
+            {
+                return false;
+            }
+            // INT32_MIN's magnitude is one more than INT32_MAX's.
+            const uint32_t limit = negative ? static_cast<uint32_t>(INT32_MAX) + 1u : static_cast<uint32_t>(INT32_MAX);
+            if (magnitude > limit)
+            {
+                return false;
+            }
+            value = negative ? static_cast<int32_t>(0u - magnitude) : static_cast<int32_t>(magnitude);
+            return true;
+        }
+
+        bool parseFixed(const char *token, float &value)
+        {
+            const bool negative = (*token == '-');
+            if (negative || *token == '+')
+            {
+                ++token;
+            }
+
+            uint32_t mantissa = 0;
+            uint8_t significant = 0;
+            uint8_t fractionDigits = 0;
+            bool anyDigit = false;
+            bool inFraction = false;
+            for (const char *cursor = token; *cursor != '\0'; ++cursor)
+            {
+                if (*cursor == '.' && !inFraction)
+                {
+                    inFraction = true;
+                    continue;
+                }
+                if (!isDigit(*cursor))
+                {
+                    return false;
+                }
+                anyDigit = true;
+
+                if (inFraction && fractionDigits == kMaxSignificantDigits)
+                {
+                    continue; // finer than a float keeps anyway
+                }
+                if (significant == kMaxSignificantDigits)
+                {
+                    if (!inFraction)
+                    {
+                        return false; // an 8th integer digit: far outside every range here
+                    }
+                    continue;
+                }
+                mantissa = mantissa * 10 + static_cast<uint32_t>(*cursor - '0');
+                // Leading zeros carry no precision, so they do not use up digits.
+                significant += (mantissa != 0) ? 1 : 0;
+                fractionDigits += inFraction ? 1 : 0;
+            }
+            if (!anyDigit)
+            {
+                return false;
+            }
+
+            // The mantissa is below 10^7 and the power of ten at most 10^7, both exact
+            // floats, so this one division rounds once.
+            const float magnitude = static_cast<float>(mantissa) / kPowersOfTen[fractionDigits];
+            value = negative ? -magnitude : magnitude;
+            return true;
+        }
+
+    } // namespace text
+} // namespace inputs
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace inputs
+{
+    // The text CLI's lexical layer: a line split into words in place, and number
+    // parsers that stay off libc. strtof/strtol pull in locale handling and, for
+    // floats, a general-purpose decimal converter; every number on this link is a
+    // short plain decimal, so those are parsed here with integer arithmetic.
+    //
+    // Nothing here allocates or keeps state; tokens point into the caller's line.
+    namespace text
+    {
+        // An optional #seq tag, the verb and up to six arguments (DRIVE's), plus
+        // room to notice that a line carried more than its verb takes.
+        constexpr size_t kMaxTokens = 10;
+
+        struct Tokens
+        {
+            char *items[kMaxTokens];
+            // Words found, up to kMaxTokens; anything past that is not split.
+            uint8_t count;
+        };
+
+        // A command's arguments: the words after its verb.
+        struct Args
+        {
+            char *const *items;
+            uint8_t count;
+
+            // nullptr past the end, as strtok_r would have returned.
+            char *operator[](uint8_t index) const { return (index < count) ? items[index] : nullptr; }
+        };
+
+        // Splits line at spaces and tabs, NUL-terminating each word in place.
+        void split(char *line, Tokens &tokens);
+
+        // ASCII-only, so a verb match never depends on locale.
+        bool equalsIgnoreCase(const char *token, const char *word);
+
+        // Plain decimal integers: digits only, with a leading sign for parseSigned.
+        // False on an empty token, any other character, or overflow.
+        bool parseUnsigned(const char *token, uint32_t &value);
+        bool parseSigned(const char *token, int32_t &value);
+
+        // [+|-]digits[.digits], at least one digit. Accumulated as a scaled integer
+        // and converted with a single division, so the result is the correctly
+        // rounded float of the digits kept, which covers every speed and radius the
+        // Pi sends. No exponents, inf or nan: none are ever a valid argument here.
+        // Digits past the seventh significant one, or the seventh decimal place, are
+        // dropped, and an eighth integer digit is rejected.
+        bool parseFixed(const char *token, float &value);
+
+    } // namespace text
+} // namespace inputs
@@ -1,8 +1,12 @@
 #include "UARTCommandInput.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
-#include <cstdlib>
-#include <strings.h>
+
+#include "inputs/TextCommand.h"
+#include "outputs/ConfigStore.h"
+#include "outputs/SteeringGeometry.h"
 
 namespace inputs
 {
@@ -13,365 +17,1965 @@ namespace inputs
         static constexpr char kHelpText[] =
 #include "../../docs/cli_help.txt"
             ;
+
+        // Text verbs. Adding one is an entry here, a case in handleLine() and its
+        // handler; the static_asserts below check the table is still well formed.
+        enum class Verb : uint8_t
+        {
+            Ping,
+            Servo,
+            Sweep,
+            Slew,
+            Trim,
+            Limit,
+            Config,
+            Power,
+            Log,
+            Motor,
+            Drive,
+            Steer,
+            Ack,
+            Calibrate,
+            Stats,
+            Latency,
+            Record,
+            Health,
+            Segment,
+            Baud,
+            Help
+        };
+
+        constexpr uint8_t kAnyArgs = UINT8_MAX;
+
+        // Argument counts are checked before the handler runs; a handler only sees
+        // lines within [minArgs, maxArgs] and checks what depends on the sub-command.
+        struct VerbSpec
+        {
+            const char *name;
+            Verb verb;
+            uint8_t minArgs;
+            uint8_t maxArgs;
+            const char *syntaxError; // fewer than minArgs
+            const char *extraError;  // more than maxArgs
+        };
+
+        constexpr VerbSpec kVerbs[] = {
+            {"PING", Verb::Ping, 0, kAnyArgs, nullptr, nullptr},
+            {"S", Verb::Servo, 2, kAnyArgs, "S cmd syntax", nullptr},
+            {"SWEEP", Verb::Sweep, 1, 2, "SWEEP cmd syntax", "SWEEP extra args"},
+            {"SLEW", Verb::Slew, 0, 2, nullptr, "SLEW extra args"},
+            {"TRIM", Verb::Trim, 0, 2, nullptr, "TRIM extra args"},
+            {"LIMIT", Verb::Limit, 0, 3, nullptr, "LIMIT extra args"},
+            {"CONFIG", Verb::Config, 1, 1, "CONFIG cmd syntax", "CONFIG extra args"},
+            {"POWER", Verb::Power, 0, 2, nullptr, "POWER extra args"},
+            {"LOG", Verb::Log, 1, 2, "LOG cmd syntax", "LOG extra args"},
+            {"MOTOR", Verb::Motor, 2, 3, "MOTOR cmd syntax", "MOTOR extra args"},
+            {"DRIVE", Verb::Drive, outputs::MotorController::kMotorCount, outputs::MotorController::kMotorCount,
+             "DRIVE cmd syntax", "DRIVE extra args"},
+            {"STEER", Verb::Steer, 1, 1, "STEER cmd syntax", "STEER extra args"},
+            {"ACK", Verb::Ack, 1, 2, "ACK cmd syntax", "ACK extra args"},
+            {"CALIBRATE", Verb::Calibrate, 1, 5, "CALIBRATE cmd syntax", "CALIBRATE extra args"},
+            {"STATS", Verb::Stats, 0, 1, nullptr, "STATS extra args"},
+            {"LAT", Verb::Latency, 0, 1, nullptr, "LAT extra args"},
+            {"RECORD", Verb::Record, 0, 1, nullptr, "RECORD extra args"},
+            {"HEALTH", Verb::Health, 0, 0, nullptr, "HEALTH extra args"},
+            {"SEG", Verb::Segment, 0, 5, nullptr, "SEG extra args"},
+            {"BAUD", Verb::Baud, 0, 1, nullptr, "BAUD extra args"},
+            {"HELP", Verb::Help, 0, kAnyArgs, nullptr, nullptr},
+            {"?", Verb::Help, 0, kAnyArgs, nullptr, nullptr},
+        };
+        constexpr uint8_t kVerbCount = sizeof(kVerbs) / sizeof(kVerbs[0]);
+
+        // Perfect hash over the verbs: first letter, last letter and length, case
+        // folded. One probe and one compare whatever the table size. If a new verb
+        // collides, the static_assert fires; retune the multipliers (or widen the
+        // table) until it passes.
+        constexpr size_t kVerbBuckets = 64;
+        constexpr uint8_t kNoVerb = UINT8_MAX;
+
+        constexpr size_t verbHash(const char *token, size_t length)
+        {
+            const size_t first = static_cast<uint8_t>(token[0]) | 0x20;
+            const size_t last = static_cast<uint8_t>(token[length - 1]) | 0x20;
+            return (first * 53 + last + length * 13) % kVerbBuckets;
+        }
+
+        constexpr size_t constexprLength(const char *text)
+        {
+            size_t length = 0;
+            while (text[length] != '\0')
+            {
+                ++length;
+            }
+            return length;
+        }
+
+        struct VerbIndex
+        {
+            uint8_t buckets[kVerbBuckets];
+            bool collisionFree;
+        };
+
+        constexpr VerbIndex buildVerbIndex()
+        {
+            VerbIndex index{};
+            index.collisionFree = true;
+            for (size_t bucket = 0; bucket < kVerbBuckets; ++bucket)
+            {
+                index.buckets[bucket] = kNoVerb;
+            }
+            for (uint8_t verb = 0; verb < kVerbCount; ++verb)
+            {
+                const char *name = kVerbs[verb].name;
+                uint8_t &bucket = index.buckets[verbHash(name, constexprLength(name))];
+                index.collisionFree = index.collisionFree && (bucket == kNoVerb);
+                bucket = verb;
+            }
+            return index;
+        }
+
+        constexpr VerbIndex kVerbIndex = buildVerbIndex();
+        static_assert(kVerbIndex.collisionFree, "Two verbs share a hash bucket: retune verbHash()");
+
+        constexpr bool verbSchemasValid()
+        {
+            for (const VerbSpec &spec : kVerbs)
+            {
+                // Past its maxArgs a line must still split into at least one more
+                // word than a verb takes, or extra args would go unnoticed.
+                const bool bounded = spec.maxArgs == kAnyArgs || spec.maxArgs + 2u < text::kMaxTokens;
+                if ((spec.minArgs != 0 && spec.syntaxError == nullptr) ||
+                    (spec.maxArgs != kAnyArgs && spec.extraError == nullptr) || !bounded)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        static_assert(verbSchemasValid(), "Every bounded verb needs its error replies and room to overflow");
+
+        const VerbSpec *findVerb(const char *token)
+        {
+            const size_t length = strlen(token);
+            const uint8_t verb = kVerbIndex.buckets[verbHash(token, length)];
+            if (verb == kNoVerb || !text::equalsIgnoreCase(token, kVerbs[verb].name))
+            {
+                return nullptr;
+            }
+            return &kVerbs[verb];
+        }
     }
 
-    UARTCommandInput::UARTCommandInput(HardwareSerial &serial, outputs::ServoController &servoController, outputs::MotorController &motorController)
+    UARTCommandInput::UARTCommandInput(HardwareSerial &serial, scheduler::CommandQueues &queues,
+                                       telemetry::TelemetryReporter &telemetryReporter,
+                                       diagnostics::Stats &stats,
+                                       const outputs::MotorController &motorController,
+                                       const outputs::ServoController &servoController,
+                                       outputs::PowerBudget &powerBudget)
         : m_serial(serial),
-          m_servoController(servoController),
+          m_queues(queues),
+          m_telemetryReporter(telemetryReporter),
+          m_stats(stats),
           m_motorController(motorController),
-          m_buffer{0},
-          m_bufferLength(0),
+          m_servoController(servoController),
+          m_powerBudget(powerBudget),
+          m_slot(nullptr),
+          m_slotLength(0),
+          m_frameExpected(0),
+          m_inFrame(false),
+          m_frameOpcode(0),
+          m_frameHeaderBytes(0),
+          m_frameHeader{},
+          m_discardingLine(false),
+          m_droppedFrames(0),
+          m_committedSlots(0),
+          m_emergencyStopCutoff(0),
+          m_emergencyStopUs(0),
+          m_emergencyStopPending(false),
+          m_receiveWaiter(nullptr),
+          m_reportedDroppedFrames(0),
+          m_releasedSlots(0),
+          m_dispatchStampUs(0),
+          m_ackMode(false),
+          m_ackIntervalMs(kDefaultAckIntervalMs),
+          m_lastAckMillis(0),
+          m_hasSequence(false),
+          m_sequence(0),
+          m_ackPending(false),
+          m_ackSequence(0),
           m_lastCommandMillis(0),
-          m_hasReceivedCommand(false),
-          m_failsafeActive(false)
+          m_deadmanPolicy(DeadmanPolicy::AnyCommand),
+          m_deadmanArmed(false),
+          m_failsafeActive(false),
+          m_latencyTimed(true),
+          m_commandLog(nullptr),
+          m_healthMonitor(nullptr),
+          m_reportedHealth(scheduler::HealthLevel::Normal),
+          m_baseBaudRate(0),
+          m_baudRate(0),
+          m_baudTrial(false),
+          m_baudTrialStartMs(0),
+          m_stream{},
+          m_segments(),
+          m_segmentOutputActive(false),
+          m_lastSegmentSampleMs(0),
+          m_lastSegmentServoMs(0),
+          m_segmentSpeeds{},
+          m_segmentPulses{}
     {
     }
 
-    void UARTCommandInput::begin(unsigned long baudRate)
+    void UARTCommandInput::begin(unsigned long baudRate, int8_t rxPin, int8_t txPin)
     {
-        m_serial.begin(baudRate);
-        resetBuffer();
+        m_baseBaudRate = baudRate;
+        m_baudRate = baudRate;
+        m_serial.begin(baudRate, SERIAL_8N1, rxPin, txPin);
+        // Raise the receive event one symbol after the line goes idle, so a command is
+        // framed as soon as its last byte lands rather than when the FIFO fills.
+        m_serial.setRxTimeout(1);
+        m_serial.onReceive([this]()
+                           { receive(); });
     }
 
     void UARTCommandInput::poll()
     {
-        while (m_serial.available())
+        takeEmergencyStop();
+        ReceivedFrame *received = nullptr;
+        while ((received = m_received.front()) != nullptr)
+        {
+            dispatch(*received);
+            m_received.release();
+            ++m_releasedSlots;
+            takeEmergencyStop();
+        }
+
+        const uint32_t dropped = m_droppedFrames.load(std::memory_order_relaxed);
+        if (dropped != m_reportedDroppedFrames)
+        {
+            m_reportedDroppedFrames = dropped;
+            diagnostics::Stats::increment(m_stats.counters().rxOverflows);
+            record(diagnostics::CommandLog::Kind::Rejected, micros(), "RX overflow");
+            reportError("RX overflow");
+        }
+    }
+
+    void UARTCommandInput::receive()
+    {
+        // Runs in the serial driver's event task, not the command task. Bytes are
+        // drained in bulk reads instead of an available()/read() call per byte.
+        uint8_t chunk[kBufferSize];
+        bool anyReceived = false;
+        for (;;)
+        {
+            const size_t count = m_serial.read(chunk, sizeof(chunk));
+            if (count == 0)
+            {
+                break;
+            }
+            anyReceived = true;
+            for (size_t index = 0; index < count; ++index)
+            {
+                receiveByte(chunk[index]);
+            }
+        }
+
+        // The event fires once the line goes idle, so this is about one wake per unit.
+        const TaskHandle_t waiter = m_receiveWaiter.load(std::memory_order_acquire);
+        if (anyReceived && waiter != nullptr)
+        {
+            xTaskNotifyGive(waiter);
+        }
+    }
+
+    void UARTCommandInput::receiveByte(uint8_t incoming)
+    {
+        if (m_inFrame)
+        {
+            if (m_slot != nullptr)
+            {
+                m_slot->data[m_slotLength] = static_cast<char>(incoming);
+            }
+            ++m_slotLength;
+
+            if (m_slotLength == 1)
+            {
+                size_t payloadLength = 0;
+                if (!frame::payloadLength(incoming, payloadLength))
+                {
+                    m_inFrame = false;
+                    queueError(ReceivedFrame::Kind::FrameOpcode);
+                    return;
+                }
+                // opcode + payload + crc
+                m_frameExpected = 1 + payloadLength + 1;
+                m_frameOpcode = incoming;
+                m_frameHeaderBytes = frame::lengthHeaderBytes(incoming);
+            }
+            else if (m_frameHeaderBytes != 0)
+            {
+                const size_t headerIndex = m_slotLength - 2;
+                m_frameHeader[headerIndex] = incoming;
+                if (headerIndex + 1 == m_frameHeaderBytes)
+                {
+                    m_frameHeaderBytes = 0;
+                    size_t payloadLength = 0;
+                    if (!frame::variablePayloadLength(m_frameOpcode, m_frameHeader, payloadLength))
+                    {
+                        m_inFrame = false;
+                        queueError(ReceivedFrame::Kind::FrameLength);
+                        return;
+                    }
+                    m_frameExpected = 1 + payloadLength + 1;
+                }
+            }
+
+            if (m_slotLength < m_frameExpected)
+            {
+                return;
+            }
+
+            m_inFrame = false;
+
+            if (m_slot == nullptr)
+            {
+                m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+                m_slotLength = 0;
+                return;
+            }
+
+            const uint8_t *bytes = reinterpret_cast<const uint8_t *>(m_slot->data);
+            if (bytes[m_slotLength - 1] != frame::crc8(bytes, m_slotLength - 1))
+            {
+                queueError(ReceivedFrame::Kind::FrameCrc);
+                return;
+            }
+
+            commitSlot(ReceivedFrame::Kind::Binary);
+            return;
+        }
+
+        if (incoming == kEmergencyStopByte)
+        {
+            triggerEmergencyStop();
+            return;
+        }
+
+        if (incoming == '\r')
+        {
+            return;
+        }
+
+        if (m_discardingLine)
+        {
+            m_discardingLine = (incoming != '\n');
+            return;
+        }
+
+        if (incoming == '\n')
+        {
+            if (m_slotLength > 0)
+            {
+                if (m_slot != nullptr)
+                {
+                    m_slot->data[m_slotLength] = '\0';
+                    commitSlot(ReceivedFrame::Kind::Text);
+                }
+                else
+                {
+                    m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            m_slot = nullptr;
+            m_slotLength = 0;
+            return;
+        }
+
+        if (m_slotLength == 0)
+        {
+            // Claim a slot for the new line or frame. If the ring is full the unit is
+            // still framed, so we resynchronise at its end, but its bytes go nowhere.
+            m_slot = m_received.acquire();
+
+            // A sync byte only opens a frame between text lines; mid-line it is just a
+            // bad character and the text parser gets to reject the line.
+            if (incoming == frame::kSync)
+            {
+                m_inFrame = true;
+                m_frameExpected = 0;
+                m_frameHeaderBytes = 0;
+                return;
+            }
+        }
+
+        if (m_slotLength >= kBufferSize - 1)
+        {
+            // Drop the rest of the line too, rather than parse its tail as a command.
+            queueError(ReceivedFrame::Kind::LineTooLong);
+            m_discardingLine = true;
+            return;
+        }
+
+        if (m_slot != nullptr)
+        {
+            m_slot->data[m_slotLength] = static_cast<char>(incoming);
+        }
+        ++m_slotLength;
+    }
+
+    void UARTCommandInput::commitSlot(ReceivedFrame::Kind kind)
+    {
+        m_slot->kind = kind;
+        m_slot->length = static_cast<uint8_t>(m_slotLength);
+        m_slot->receivedUs = m_latencyTimed ? m_stats.actuation().stamp() : 0;
+        m_slot->framedUs = (m_commandLog != nullptr) ? micros() : 0;
+        m_received.commit();
+        ++m_committedSlots;
+        m_slot = nullptr;
+        m_slotLength = 0;
+    }
+
+    void UARTCommandInput::triggerEmergencyStop()
+    {
+        // Hardware first: nothing below can make the stop slower than this write.
+        m_motorController.cutDrivers();
+        m_queues.stopAllPending.store(true, std::memory_order_release);
+
+        // The partial line, if any, predates the stop; its claimed slot is reused.
+        m_slotLength = 0;
+        m_discardingLine = false;
+        m_emergencyStopCutoff.store(m_committedSlots, std::memory_order_relaxed);
+        m_emergencyStopUs.store((m_commandLog != nullptr) ? micros() : 0, std::memory_order_relaxed);
+        m_emergencyStopPending.store(true, std::memory_order_release);
+    }
+
+    bool UARTCommandInput::takeEmergencyStop()
+    {
+        if (!m_emergencyStopPending.exchange(false, std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        // Everything framed before the stop is dropped unparsed: a DRIVE queued ahead
+        // of it must not start the motors again behind it.
+        const uint32_t cutoff = m_emergencyStopCutoff.load(std::memory_order_relaxed);
+        while (static_cast<int32_t>(cutoff - m_releasedSlots) > 0 && m_received.front() != nullptr)
+        {
+            m_received.release();
+            ++m_releasedSlots;
+        }
+
+        diagnostics::Stats::increment(m_stats.counters().emergencyStops);
+        record(diagnostics::CommandLog::Kind::EmergencyStop, m_emergencyStopUs.load(std::memory_order_relaxed),
+               nullptr);
+        // Queued behind anything the unit being dispatched when it landed may have
+        // pushed, so that cannot outlive the stop either.
+        requestStopAll();
+        m_serial.println("ESTOP");
+        return true;
+    }
+
+    void UARTCommandInput::queueError(ReceivedFrame::Kind kind)
+    {
+        if (m_slot != nullptr)
+        {
+            m_slotLength = 0;
+            commitSlot(kind);
+            return;
+        }
+        m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        m_slotLength = 0;
+    }
+
+    void UARTCommandInput::dispatch(ReceivedFrame &received)
+    {
+        m_hasSequence = false;
+
+        switch (received.kind)
+        {
+        case ReceivedFrame::Kind::Text:
+            diagnostics::Stats::increment(m_stats.counters().linesParsed);
+            // Before handleLine(), which splits the line in place.
+            record(diagnostics::CommandLog::Kind::Line, received.framedUs, received.data);
+            markCommandReceived();
+            beginLatencyStamp(received.receivedUs);
+            handleLine(received.data);
+            m_dispatchStampUs = 0;
+            return;
+        case ReceivedFrame::Kind::Binary:
+            diagnostics::Stats::increment(m_stats.counters().framesParsed);
+            if (m_commandLog != nullptr)
+            {
+                m_commandLog->record(diagnostics::CommandLog::Kind::Frame, received.framedUs, received.data,
+                                     received.length);
+            }
+            markCommandReceived();
+            beginLatencyStamp(received.receivedUs);
+            handleFrame(reinterpret_cast<const uint8_t *>(received.data));
+            m_dispatchStampUs = 0;
+            return;
+        case ReceivedFrame::Kind::LineTooLong:
+            diagnostics::Stats::increment(m_stats.counters().lineTooLong);
+            record(diagnostics::CommandLog::Kind::Rejected, received.framedUs, "Line too long");
+            reportError("Line too long");
+            return;
+        case ReceivedFrame::Kind::FrameOpcode:
+            diagnostics::Stats::increment(m_stats.counters().frameErrors);
+            record(diagnostics::CommandLog::Kind::Rejected, received.framedUs, "Frame opcode");
+            reportError("Frame opcode");
+            return;
+        case ReceivedFrame::Kind::FrameLength:
+            diagnostics::Stats::increment(m_stats.counters().frameErrors);
+            record(diagnostics::CommandLog::Kind::Rejected, received.framedUs, "Frame length");
+            reportError("Frame length");
+            return;
+        case ReceivedFrame::Kind::FrameCrc:
+            // Not fed to the deadman: a corrupt frame is no evidence the link is healthy.
+            diagnostics::Stats::increment(m_stats.counters().frameErrors);
+            record(diagnostics::CommandLog::Kind::Rejected, received.framedUs, "Frame CRC");
+            reportError("Frame CRC");
+            return;
+        }
+    }
+
+    void UARTCommandInput::record(diagnostics::CommandLog::Kind kind, uint32_t atUs, const char *text)
+    {
+        if (m_commandLog != nullptr)
+        {
+            m_commandLog->record(kind, atUs, text, (text != nullptr) ? strlen(text) : 0);
+        }
+    }
+
+    void UARTCommandInput::beginLatencyStamp(uint32_t receivedUs)
+    {
+        m_dispatchStampUs = receivedUs;
+        m_stats.actuation().record(diagnostics::LatencyPath::RxToParse, receivedUs);
+    }
+
+    void UARTCommandInput::update(unsigned long nowMillis)
+    {
+        // Unprompted, like FAILSAFE STOP: the host learns what is being shed.
+        if (m_healthMonitor != nullptr && m_healthMonitor->level() != m_reportedHealth)
+        {
+            m_reportedHealth = m_healthMonitor->level();
+            m_healthMonitor->printLevel(m_serial);
+        }
+
+        flushAck(nowMillis);
+        playSegments(nowMillis);
+
+        if (m_baudTrial && nowMillis - m_baudTrialStartMs >= kBaudConfirmMs)
+        {
+            // Nothing made it through at the new rate; the host is expected to fall
+            // back too and PING again at base.
+            switchBaudRate(m_baseBaudRate);
+        }
+
+        // Deadman failsafe: once armed, stop the motors if the link goes silent for
+        // longer than the deadman window. Servos are intentionally left holding their
+        // last position.
+        if (!m_deadmanArmed || m_failsafeActive)
+        {
+            return;
+        }
+
+        if (nowMillis - m_lastCommandMillis >= kDeadmanTimeoutMs)
+        {
+            m_failsafeActive = true;
+            // A console re-arms only by moving something again, not by the next line.
+            m_deadmanArmed = (m_deadmanPolicy == DeadmanPolicy::AnyCommand);
+            diagnostics::Stats::increment(m_stats.counters().failsafeTrips);
+            record(diagnostics::CommandLog::Kind::Failsafe, micros(), nullptr);
+            requestStopAll();
+            // Whoever reconnects may not know about ACK mode; start them on plain OKs.
+            m_ackMode = false;
+            m_ackPending = false;
+            m_serial.println("FAILSAFE STOP: link lost");
+            if (m_baudRate != m_baseBaudRate)
+            {
+                switchBaudRate(m_baseBaudRate);
+            }
+        }
+    }
+
+    uint32_t UARTCommandInput::msUntilDue(unsigned long nowMillis) const
+    {
+        uint32_t soonestMs = UINT32_MAX;
+        // Each deadline is a start time plus a window; 0 once the window has run out.
+        const auto consider = [&](unsigned long sinceMs, unsigned long windowMs)
+        {
+            const unsigned long elapsedMs = nowMillis - sinceMs;
+            const uint32_t remainingMs = (elapsedMs >= windowMs) ? 0 : static_cast<uint32_t>(windowMs - elapsedMs);
+            soonestMs = std::min(soonestMs, remainingMs);
+        };
+
+        if (m_ackMode && m_ackPending)
+        {
+            consider(m_lastAckMillis, m_ackIntervalMs);
+        }
+        if (m_segmentOutputActive)
+        {
+            consider(m_lastSegmentSampleMs, kSegmentSamplePeriodMs);
+        }
+        if (m_baudTrial)
+        {
+            consider(m_baudTrialStartMs, kBaudConfirmMs);
+        }
+        if (m_deadmanArmed && !m_failsafeActive)
+        {
+            consider(m_lastCommandMillis, kDeadmanTimeoutMs);
+        }
+        return soonestMs;
+    }
+
+    void UARTCommandInput::markCommandReceived()
+    {
+        // A complete command arrived: feed the deadman and clear any active failsafe
+        // so the link is considered alive again.
+        m_lastCommandMillis = millis();
+        m_deadmanArmed = m_deadmanArmed || (m_deadmanPolicy == DeadmanPolicy::AnyCommand);
+        m_failsafeActive = false;
+    }
+
+    void UARTCommandInput::markMotionCommand()
+    {
+        m_deadmanArmed = m_deadmanArmed || (m_deadmanPolicy == DeadmanPolicy::MotionCommands);
+    }
+
+    void UARTCommandInput::handleLine(char *line)
+    {
+        text::Tokens tokens;
+        text::split(line, tokens);
+        if (tokens.count == 0)
+        {
+            return;
+        }
+
+        // Optional "#<seq>" tag ahead of any verb. It labels this command's ERR and,
+        // in ACK mode, its acknowledgement.
+        uint8_t verbIndex = 0;
+        if (tokens.items[0][0] == '#')
+        {
+            uint32_t sequence = 0;
+            if (!text::parseUnsigned(tokens.items[0] + 1, sequence))
+            {
+                reportError("Sequence");
+                return;
+            }
+            m_sequence = sequence;
+            m_hasSequence = true;
+
+            if (tokens.count == 1)
+            {
+                reportError("Sequence without command");
+                return;
+            }
+            verbIndex = 1;
+        }
+
+        const VerbSpec *spec = findVerb(tokens.items[verbIndex]);
+        if (spec == nullptr)
+        {
+            reportError("Unknown command");
+            return;
+        }
+
+        const text::Args args{&tokens.items[verbIndex + 1], static_cast<uint8_t>(tokens.count - verbIndex - 1)};
+        if (args.count < spec->minArgs)
+        {
+            reportError(spec->syntaxError);
+            return;
+        }
+        if (args.count > spec->maxArgs)
+        {
+            reportError(spec->extraError);
+            return;
+        }
+
+        switch (spec->verb)
+        {
+        case Verb::Ping:
+            replyPong();
+            return;
+        case Verb::Servo:
+            handleServoCommand(args[0], args[1]);
+            return;
+        case Verb::Sweep:
+            handleSweepCommand(args[0], args[1]);
+            return;
+        case Verb::Slew:
+            handleSlewCommand(args[0], args[1]);
+            return;
+        case Verb::Trim:
+            handleTrimCommand(args[0], args[1]);
+            return;
+        case Verb::Limit:
+            handleLimitCommand(args);
+            return;
+        case Verb::Config:
+            handleConfigCommand(args[0]);
+            return;
+        case Verb::Power:
+            handlePowerCommand(args[0], args[1]);
+            return;
+        case Verb::Log:
+            handleTelemetryCommand(args[0], args[1]);
+            return;
+        case Verb::Motor:
+            handleMotorCommand(args[0], args[1], args[2]);
+            return;
+        case Verb::Drive:
+            handleDriveCommand(args);
+            return;
+        case Verb::Steer:
+            handleSteerCommand(args[0]);
+            return;
+        case Verb::Ack:
+            handleAckCommand(args[0], args[1]);
+            return;
+        case Verb::Calibrate:
+            handleCalibrateCommand(args);
+            return;
+        case Verb::Stats:
+            handleStatsCommand(args[0]);
+            return;
+        case Verb::Latency:
+            handleLatencyCommand(args[0]);
+            return;
+        case Verb::Record:
+            handleRecordCommand(args[0]);
+            return;
+        case Verb::Health:
+            handleHealthCommand();
+            return;
+        case Verb::Segment:
+            handleSegmentCommand(args);
+            return;
+        case Verb::Baud:
+            handleBaudCommand(args[0]);
+            return;
+        case Verb::Help:
+            handleHelpCommand();
+            return;
+        }
+    }
+
+    void UARTCommandInput::handleFrame(const uint8_t *frameData)
+    {
+        const uint8_t *payload = &frameData[1];
+
+        switch (static_cast<frame::Opcode>(frameData[0]))
+        {
+        case frame::Opcode::Ping:
+            replyPong();
+            return;
+        case frame::Opcode::StopAll:
+            requestStopAll();
+            replyOk();
+            return;
+        case frame::Opcode::Drive:
+            handleDriveFrame(payload);
+            return;
+        case frame::Opcode::Servo:
+            handleServoFrame(payload);
+            return;
+        case frame::Opcode::Keyframe:
+            handleKeyframe(payload);
+            return;
+        case frame::Opcode::Delta:
+            handleDeltaFrame(payload);
+            return;
+        case frame::Opcode::Segment:
+            handleSegmentFrame(payload);
+            return;
+        }
+
+        reportError("Frame opcode");
+    }
+
+    void UARTCommandInput::handleDriveFrame(const uint8_t *payload)
+    {
+        // One frame, one reply -- this replaces six MOTOR lines and six OKs.
+        scheduler::MotorCommand command{};
+        command.kind = scheduler::MotorCommand::Kind::SetTargets;
+        for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
+        {
+            const int16_t raw = frame::readInt16(&payload[index * 2]);
+            command.targets[index] = static_cast<float>(raw) / static_cast<float>(frame::kSpeedScale);
+        }
+        submit(command);
+    }
+
+    void UARTCommandInput::handleServoFrame(const uint8_t *payload)
+    {
+        scheduler::ServoCommand command{};
+        command.kind = scheduler::ServoCommand::Kind::SetPulses;
+        for (uint8_t channel = 0; channel < outputs::ServoController::kServoCount; ++channel)
+        {
+            command.pulses[channel] = frame::readUint16(&payload[channel * 2]);
+        }
+        submit(command);
+    }
+
+    void UARTCommandInput::handleKeyframe(const uint8_t *payload)
+    {
+        int16_t speeds[outputs::MotorController::kMotorCount];
+        uint16_t pulses[outputs::ServoController::kServoCount];
+        const uint8_t *values = &payload[1];
+        for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
+        {
+            speeds[index] = frame::readInt16(&values[index * 2]);
+        }
+        values += outputs::MotorController::kMotorCount * 2;
+        for (uint8_t channel = 0; channel < outputs::ServoController::kServoCount; ++channel)
+        {
+            pulses[channel] = frame::readUint16(&values[channel * 2]);
+        }
+
+        if (!submitStream(speeds, pulses, true, true))
+        {
+            return;
+        }
+
+        m_stream.valid = true;
+        m_stream.sequence = payload[0];
+        memcpy(m_stream.speeds, speeds, sizeof(speeds));
+        memcpy(m_stream.pulses, pulses, sizeof(pulses));
+        replyOk();
+    }
+
+    void UARTCommandInput::handleDeltaFrame(const uint8_t *payload)
+    {
+        // A delta is only meaningful on top of the one before it. Once one is missed
+        // the mirror is stale, so everything is refused until the next keyframe.
+        const uint8_t sequence = payload[0];
+        if (!m_stream.valid || sequence != static_cast<uint8_t>(m_stream.sequence + 1))
+        {
+            m_stream.valid = false;
+            reportError("Delta sequence");
+            return;
+        }
+
+        const uint16_t mask = frame::readUint16(&payload[1]);
+        const int8_t *steps = reinterpret_cast<const int8_t *>(&payload[frame::kDeltaHeaderLength]);
+        size_t stepIndex = 0;
+
+        int16_t speeds[outputs::MotorController::kMotorCount];
+        memcpy(speeds, m_stream.speeds, sizeof(speeds));
+        bool motorsChanged = false;
+        for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
+        {
+            if ((mask & (1u << index)) == 0)
+            {
+                continue;
+            }
+            // Saturate, exactly as the sender's mirror must.
+            const int32_t speed = speeds[index] + steps[stepIndex++] * static_cast<int32_t>(frame::kDeltaSpeedStep);
+            speeds[index] = static_cast<int16_t>(std::clamp<int32_t>(speed, -frame::kSpeedScale, frame::kSpeedScale));
+            motorsChanged = true;
+        }
+
+        uint16_t pulses[outputs::ServoController::kServoCount];
+        memcpy(pulses, m_stream.pulses, sizeof(pulses));
+        bool servosChanged = false;
+        for (uint8_t channel = 0; channel < outputs::ServoController::kServoCount; ++channel)
+        {
+            if ((mask & (1u << (frame::kDeltaServoShift + channel))) == 0)
+            {
+                continue;
+            }
+            const int32_t pulse = pulses[channel] + steps[stepIndex++] * static_cast<int32_t>(frame::kDeltaPulseStepUs);
+            pulses[channel] = static_cast<uint16_t>(std::clamp<int32_t>(pulse, 0, UINT16_MAX));
+            servosChanged = true;
+        }
+
+        // An empty mask changes nothing but still advances the sequence and feeds the
+        // deadman, so it doubles as a keepalive.
+        if (!submitStream(speeds, pulses, motorsChanged, servosChanged))
+        {
+            return;
+        }
+
+        m_stream.sequence = sequence;
+        memcpy(m_stream.speeds, speeds, sizeof(speeds));
+        memcpy(m_stream.pulses, pulses, sizeof(pulses));
+        replyOk();
+    }
+
+    void UARTCommandInput::handleSegmentFrame(const uint8_t *payload)
+    {
+        motion::Segment segment{};
+        segment.durationMs = frame::readUint16(&payload[0]);
+        segment.profile = static_cast<motion::Segment::Profile>(payload[2]);
+        const uint8_t *values = &payload[3];
+        for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
+        {
+            // -32768 has no positive twin; keep the range symmetric like every other path.
+            const int16_t raw = frame::readInt16(&values[index * 2]);
+            segment.speedsQ15[index] = std::max<int16_t>(raw, -frame::kSpeedScale);
+        }
+        values += outputs::MotorController::kMotorCount * 2;
+        for (uint8_t channel = 0; channel < outputs::ServoController::kServoCount; ++channel)
+        {
+            segment.pulsesUs[channel] = frame::readUint16(&values[channel * 2]);
+        }
+        appendSegment(segment);
+    }
+
+    bool UARTCommandInput::submitStream(const int16_t speeds[outputs::MotorController::kMotorCount],
+                                        const uint16_t pulses[outputs::ServoController::kServoCount],
+                                        bool motorsChanged, bool servosChanged)
+    {
+        scheduler::MotorCommand motorCommand{};
+        motorCommand.kind = scheduler::MotorCommand::Kind::SetTargets;
+        for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
+        {
+            motorCommand.targets[index] = static_cast<float>(speeds[index]) / static_cast<float>(frame::kSpeedScale);
+        }
+        scheduler::ServoCommand servoCommand{};
+        servoCommand.kind = scheduler::ServoCommand::Kind::SetPulses;
+        memcpy(servoCommand.pulses, pulses, sizeof(servoCommand.pulses));
+
+        // Nothing is applied on a refusal, but the sender has already moved its
+        // reference on, so only a keyframe brings the two back in step.
+        if (motorsChanged && refuseShed(motorCommand))
+        {
+            m_stream.valid = false;
+            return false;
+        }
+        // Both halves or neither, as for STEER: this task is both queues' only
+        // producer, so slots free now are still free for the pushes.
+        if ((motorsChanged && m_queues.motor.acquire() == nullptr) ||
+            (servosChanged && m_queues.servo.acquire() == nullptr))
+        {
+            m_stream.valid = false;
+            diagnostics::Stats::increment(m_stats.counters().busyRejects);
+            reportError("Busy");
+            return false;
+        }
+
+        if (motorsChanged)
+        {
+            enqueue(motorCommand);
+        }
+        if (servosChanged)
+        {
+            enqueue(servoCommand);
+        }
+        return true;
+    }
+
+    void UARTCommandInput::handleServoCommand(char *channelToken, char *pulseToken)
+    {
+        uint32_t channel = 0;
+        if (!text::parseUnsigned(channelToken, channel) || channel > 15)
+        {
+            reportError("Servo channel");
+            return;
+        }
+
+        int32_t pulse = 0;
+        if (!text::parseSigned(pulseToken, pulse))
+        {
+            reportError("Servo pulse");
+            return;
+        }
+
+        scheduler::ServoCommand command{};
+        command.kind = scheduler::ServoCommand::Kind::SetPulse;
+        command.channel = static_cast<uint8_t>(channel);
+        command.pulseUs = static_cast<uint16_t>(pulse);
+        submit(command);
+    }
+
+    void UARTCommandInput::handleSweepCommand(char *stateToken, char *rangeToken)
+    {
+        if (stateToken == nullptr)
+        {
+            reportError("SWEEP arg");
+            return;
+        }
+
+        bool enable = false;
+        if (text::equalsIgnoreCase(stateToken, "ON"))
+        {
+            enable = true;
+        }
+        else if (text::equalsIgnoreCase(stateToken, "OFF"))
+        {
+            enable = false;
+        }
+        else
+        {
+            reportError("SWEEP arg");
+            return;
+        }
+
+        scheduler::ServoCommand command{};
+        command.enabled = enable;
+
+        if (rangeToken == nullptr)
+        {
+            command.kind = scheduler::ServoCommand::Kind::Sweep;
+            submit(command);
+            return;
+        }
+
+        uint8_t startChannel = 0;
+        uint8_t endChannel = 0;
+        bool isAll = false;
+        if (!parseSweepRangeToken(rangeToken, startChannel, endChannel, isAll))
+        {
+            reportError("SWEEP range");
+            return;
+        }
+
+        // ALL comes back as the full channel range, so one kind covers both.
+        command.kind = scheduler::ServoCommand::Kind::SweepRange;
+        command.channel = startChannel;
+        command.endChannel = endChannel;
+        submit(command);
+    }
+
+    void UARTCommandInput::handleSlewCommand(char *rangeToken, char *rateToken)
+    {
+        if (rangeToken == nullptr)
+        {
+            m_serial.print("SLEW");
+            for (uint8_t channel = 0; channel < outputs::ServoController::kServoCount; ++channel)
+            {
+                m_serial.print(' ');
+                m_serial.print(m_servoController.slewRate(channel));
+            }
+            m_serial.println();
+            return;
+        }
+
+        if (rateToken == nullptr)
+        {
+            reportError("SLEW cmd syntax");
+            return;
+        }
+
+        uint8_t startChannel = 0;
+        uint8_t endChannel = 0;
+        bool isAll = false;
+        if (!parseSweepRangeToken(rangeToken, startChannel, endChannel, isAll))
+        {
+            reportError("SLEW range");
+            return;
+        }
+
+        uint32_t rate = 0;
+        if (!text::parseUnsigned(rateToken, rate) || rate > UINT16_MAX)
+        {
+            reportError("SLEW rate");
+            return;
+        }
+
+        scheduler::ServoCommand command{};
+        command.kind = scheduler::ServoCommand::Kind::SlewRate;
+        command.channel = startChannel;
+        command.endChannel = endChannel;
+        command.pulseUs = static_cast<uint16_t>(rate);
+        submit(command);
+    }
+
+    void UARTCommandInput::handleTrimCommand(char *rangeToken, char *trimToken)
+    {
+        if (rangeToken == nullptr)
+        {
+            m_serial.print("TRIM");
+            for (uint8_t channel = 0; channel < outputs::ServoController::kServoCount; ++channel)
+            {
+                m_serial.print(' ');
+                m_serial.print(m_servoController.channelConfig(channel).trimUs);
+            }
+            m_serial.println();
+            return;
+        }
+
+        if (trimToken == nullptr)
+        {
+            reportError("TRIM cmd syntax");
+            return;
+        }
+
+        uint8_t startChannel = 0;
+        uint8_t endChannel = 0;
+        bool isAll = false;
+        if (!parseSweepRangeToken(rangeToken, startChannel, endChannel, isAll))
+        {
+            reportError("TRIM range");
+            return;
+        }
+
+        int32_t trim = 0;
+        if (!text::parseSigned(trimToken, trim) || trim < -outputs::ServoController::kMaxTrimUs ||
+            trim > outputs::ServoController::kMaxTrimUs)
+        {
+            reportError("TRIM value");
+            return;
+        }
+
+        scheduler::ServoCommand command{};
+        command.kind = scheduler::ServoCommand::Kind::Trim;
+        command.channel = startChannel;
+        command.endChannel = endChannel;
+        command.trimUs = static_cast<int16_t>(trim);
+        submit(command);
+    }
+
+    void UARTCommandInput::handleLimitCommand(const text::Args &args)
+    {
+        if (args.count == 0)
+        {
+            m_serial.print("LIMIT");
+            for (uint8_t channel = 0; channel < outputs::ServoController::kServoCount; ++channel)
+            {
+                const outputs::ServoController::ChannelConfig config = m_servoController.channelConfig(channel);
+                m_serial.printf(" %u-%u", config.minPulseUs, config.maxPulseUs);
+            }
+            m_serial.println();
+            return;
+        }
+
+        if (args.count != 3)
+        {
+            reportError("LIMIT cmd syntax");
+            return;
+        }
+
+        uint8_t startChannel = 0;
+        uint8_t endChannel = 0;
+        bool isAll = false;
+        if (!parseSweepRangeToken(args[0], startChannel, endChannel, isAll))
+        {
+            reportError("LIMIT range");
+            return;
+        }
+
+        uint32_t minUs = 0;
+        uint32_t maxUs = 0;
+        if (!text::parseUnsigned(args[1], minUs) || !text::parseUnsigned(args[2], maxUs) ||
+            minUs < outputs::ServoController::kMinLimitUs || minUs >= maxUs ||
+            maxUs > outputs::ServoController::kMaxLimitUs)
+        {
+            reportError("LIMIT values");
+            return;
+        }
+
+        scheduler::ServoCommand command{};
+        command.kind = scheduler::ServoCommand::Kind::PulseLimits;
+        command.channel = startChannel;
+        command.endChannel = endChannel;
+        command.pulses[0] = static_cast<uint16_t>(minUs);
+        command.pulses[1] = static_cast<uint16_t>(maxUs);
+        submit(command);
+    }
+
+    void UARTCommandInput::handleConfigCommand(char *actionToken)
+    {
+        if (text::equalsIgnoreCase(actionToken, "SAVE"))
+        {
+            if (saveConfig("CONFIG busy", "CONFIG save failed"))
+            {
+                replyOk();
+            }
+            return;
+        }
+
+        if (text::equalsIgnoreCase(actionToken, "CLEAR"))
+        {
+            if (m_motorController.driverEnabled())
+            {
+                reportError("CONFIG busy");
+                return;
+            }
+            if (!outputs::config_store::clear())
+            {
+                reportError("CONFIG clear failed");
+                return;
+            }
+            replyOk();
+            return;
+        }
+
+        reportError("CONFIG arg");
+    }
+
+    bool UARTCommandInput::saveConfig(const char *busyError, const char *failedError)
+    {
+        if (m_motorController.driverEnabled() || !m_queues.motor.empty() || !m_queues.servo.empty())
+        {
+            reportError(busyError);
+            return false;
+        }
+
+        outputs::StoredConfig config;
+        for (uint8_t channel = 0; channel < outputs::ServoController::kServoCount; ++channel)
+        {
+            config.servos[channel] = m_servoController.channelConfig(channel);
+        }
+        for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
+        {
+            config.motors[index] = m_motorController.calibration(index);
+        }
+        if (!outputs::config_store::save(config))
+        {
+            reportError(failedError);
+            return false;
+        }
+        return true;
+    }
+
+    void UARTCommandInput::handlePowerCommand(char *subToken, char *valueToken)
+    {
+        if (subToken == nullptr)
+        {
+            m_serial.printf("POWER budget_ma=%lu motor_ma=%lu servo_ma=%lu",
+                            static_cast<unsigned long>(m_powerBudget.budgetMa()),
+                            static_cast<unsigned long>(m_powerBudget.motorMa()),
+                            static_cast<unsigned long>(m_powerBudget.servoMa()));
+            if (m_powerBudget.senseFitted())
+            {
+                m_serial.printf(" measured_ma=%lu", static_cast<unsigned long>(m_powerBudget.measuredMa()));
+            }
+            m_serial.printf(" motor_holds=%lu servo_holds=%lu\n",
+                            static_cast<unsigned long>(m_powerBudget.motorHolds()),
+                            static_cast<unsigned long>(m_powerBudget.servoHolds()));
+            return;
+        }
+
+        if (!text::equalsIgnoreCase(subToken, "BUDGET") || valueToken == nullptr)
+        {
+            reportError("POWER cmd syntax");
+            return;
+        }
+
+        uint32_t budgetMa = 0;
+        if (!text::parseUnsigned(valueToken, budgetMa) || budgetMa > kMaxPowerBudgetMa)
+        {
+            reportError("POWER budget");
+            return;
+        }
+
+        m_powerBudget.setBudgetMa(budgetMa);
+        replyOk();
+    }
+
+    void UARTCommandInput::handleTelemetryCommand(char *stateToken, char *rateToken)
+    {
+        if (text::equalsIgnoreCase(stateToken, "OFF"))
+        {
+            if (rateToken != nullptr)
+            {
+                reportError("LOG extra args");
+                return;
+            }
+            m_telemetryReporter.setRateHz(0);
+            replyOk();
+            return;
+        }
+
+        if (!text::equalsIgnoreCase(stateToken, "ON"))
+        {
+            reportError("LOG arg");
+            return;
+        }
+
+        uint32_t rateHz = telemetry::TelemetryReporter::kDefaultRateHz;
+        if (rateToken != nullptr)
+        {
+            if (!text::parseUnsigned(rateToken, rateHz) || rateHz == 0 || rateHz > telemetry::TelemetryReporter::kMaxRateHz)
+            {
+                reportError("LOG rate");
+                return;
+            }
+        }
+
+        // Owned by this task, so the change takes effect on the very next update().
+        m_telemetryReporter.setRateHz(static_cast<uint16_t>(rateHz));
+        replyOk();
+    }
+
+    void UARTCommandInput::handleMotorCommand(char *targetToken, char *modeToken, char *valueToken)
+    {
+        uint8_t motorIndex = 0;
+        bool targetAll = false;
+        if (!parseMotorTargetToken(targetToken, motorIndex, targetAll))
+        {
+            reportError("MOTOR target");
+            return;
+        }
+
+        if (text::equalsIgnoreCase(modeToken, "STOP"))
+        {
+            if (valueToken != nullptr)
+            {
+                reportError("MOTOR STOP args");
+                return;
+            }
+            if (targetAll)
+            {
+                requestStopAll();
+                replyOk();
+                return;
+            }
+            scheduler::MotorCommand command{};
+            command.kind = scheduler::MotorCommand::Kind::Stop;
+            command.motorIndex = motorIndex;
+            submit(command);
+            return;
+        }
+
+        if (text::equalsIgnoreCase(modeToken, "START"))
+        {
+            if (valueToken != nullptr)
+            {
+                reportError("MOTOR START args");
+                return;
+            }
+            scheduler::MotorCommand command{};
+            command.kind = targetAll ? scheduler::MotorCommand::Kind::StartAll : scheduler::MotorCommand::Kind::Start;
+            command.motorIndex = motorIndex;
+            submit(command);
+            return;
+        }
+
+        outputs::MotorController::Direction direction;
+        if (text::equalsIgnoreCase(modeToken, "FORWARD"))
+        {
+            direction = outputs::MotorController::Direction::Forward;
+        }
+        else if (text::equalsIgnoreCase(modeToken, "BACKWARD"))
+        {
+            direction = outputs::MotorController::Direction::Backward;
+        }
+        else
+        {
+            reportError("MOTOR arg");
+            return;
+        }
+
+        float speed = 1.0f;
+        if (valueToken != nullptr)
+        {
+            float parsed = 0.0f;
+            if (!text::parseFixed(valueToken, parsed) || parsed < 0.0f || parsed > 1.0f)
+            {
+                reportError("MOTOR speed");
+                return;
+            }
+            speed = parsed;
+        }
+
+        scheduler::MotorCommand command{};
+        command.kind = targetAll ? scheduler::MotorCommand::Kind::RunAll : scheduler::MotorCommand::Kind::Run;
+        command.motorIndex = motorIndex;
+        command.direction = direction;
+        command.speed = speed;
+        submit(command);
+    }
+
+    void UARTCommandInput::handleDriveCommand(const text::Args &args)
+    {
+        // Parse every speed before touching the controller: a bad token rejects the whole
+        // line rather than leaving the rover half-updated.
+        scheduler::MotorCommand command{};
+        command.kind = scheduler::MotorCommand::Kind::SetTargets;
+        for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
+        {
+            float parsed = 0.0f;
+            if (!text::parseFixed(args[index], parsed) || parsed < -1.0f || parsed > 1.0f)
+            {
+                reportError("DRIVE speed");
+                return;
+            }
+            command.targets[index] = parsed;
+        }
+
+        submit(command);
+    }
+
+    void UARTCommandInput::handleSteerCommand(char *radiusToken)
+    {
+        float radius = 0.0f;
+        if (!text::parseFixed(radiusToken, radius))
+        {
+            reportError("STEER radius");
+            return;
+        }
+
+        // Servo angles and wheel speed ratios come from the same table entry. The
+        // servo task re-solves the angles from the radius; the ratios go to the motor
+        // task from here. One line, one reply, for every actuator.
+        scheduler::ServoCommand servoCommand{};
+        servoCommand.kind = scheduler::ServoCommand::Kind::SteeringRadius;
+        servoCommand.radiusM = radius;
+
+        const outputs::steering::Entry entry = outputs::steering::lookup(radius);
+        scheduler::MotorCommand motorCommand{};
+        motorCommand.kind = scheduler::MotorCommand::Kind::SetSpeedScales;
+        for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
+        {
+            motorCommand.targets[index] = entry.speedRatio[index];
+        }
+
+        // All or nothing: steering the servos without the matching wheel ratios would
+        // scrub the tyres. This task is both queues' only producer, so slots free now
+        // are still free for the pushes.
+        if (refuseShed(motorCommand))
+        {
+            return;
+        }
+        if (m_queues.servo.acquire() == nullptr || m_queues.motor.acquire() == nullptr)
+        {
+            diagnostics::Stats::increment(m_stats.counters().busyRejects);
+            reportError("Busy");
+            return;
+        }
+        enqueue(servoCommand);
+        enqueue(motorCommand);
+        replyOk();
+    }
+
+    void UARTCommandInput::handleAckCommand(char *stateToken, char *intervalToken)
+    {
+        if (text::equalsIgnoreCase(stateToken, "OFF"))
+        {
+            if (intervalToken != nullptr)
+            {
+                reportError("ACK extra args");
+                return;
+            }
+            // Anything still coalesced is owed an answer before the mode goes away.
+            if (m_ackPending)
+            {
+                m_serial.print("ACK ");
+                m_serial.println(static_cast<unsigned long>(m_ackSequence));
+                m_ackPending = false;
+            }
+            m_ackMode = false;
+            m_serial.println("OK");
+            return;
+        }
+
+        if (!text::equalsIgnoreCase(stateToken, "ON"))
+        {
+            reportError("ACK arg");
+            return;
+        }
+
+        uint32_t intervalMs = kDefaultAckIntervalMs;
+        if (intervalToken != nullptr)
+        {
+            if (!text::parseUnsigned(intervalToken, intervalMs) || intervalMs == 0 || intervalMs > kMaxAckIntervalMs)
+            {
+                reportError("ACK interval");
+                return;
+            }
+        }
+
+        m_ackIntervalMs = intervalMs;
+        m_ackMode = true;
+        m_ackPending = false;
+        // The mode switch itself always gets a plain OK, so the sender knows it took.
+        m_serial.println("OK");
+    }
+
+    void UARTCommandInput::handleBaudCommand(char *rateToken)
+    {
+        if (rateToken == nullptr)
+        {
+            m_serial.print("BAUD ");
+            m_serial.println(m_baudRate);
+            return;
+        }
+
+        uint32_t baudRate = 0;
+        bool supported = false;
+        if (text::parseUnsigned(rateToken, baudRate))
+        {
+            for (unsigned long candidate : kSupportedBaudRates)
+            {
+                supported = supported || (candidate == baudRate);
+            }
+        }
+        if (!supported)
+        {
+            reportError("BAUD rate");
+            return;
+        }
+
+        // Confirmed at the old rate, whatever the ACK mode, so the host knows exactly
+        // when to switch its end.
+        m_serial.print("BAUD ");
+        m_serial.println(baudRate);
+        switchBaudRate(baudRate);
+        m_baudTrial = (baudRate != m_baseBaudRate);
+        m_baudTrialStartMs = millis();
+    }
+
+    void UARTCommandInput::handleSegmentCommand(const text::Args &args)
+    {
+        char *actionToken = args[0];
+        if (actionToken == nullptr)
+        {
+            m_serial.printf("SEG queued=%u playing=%u\n", static_cast<unsigned>(m_segments.queued()),
+                            m_segmentOutputActive ? 1u : 0u);
+            return;
+        }
+
+        if (text::equalsIgnoreCase(actionToken, "GO") || text::equalsIgnoreCase(actionToken, "CLEAR"))
+        {
+            if (args.count > 1)
+            {
+                reportError("SEG extra args");
+                return;
+            }
+            if (text::equalsIgnoreCase(actionToken, "GO"))
+            {
+                startSegments();
+                return;
+            }
+            // Stopping mid-manoeuvre leaves the rover wherever the plan had it heading,
+            // so a clear during playback stops the motors too.
+            if (m_segmentOutputActive)
+            {
+                requestStopAll();
+            }
+            abortSegments();
+            replyOk();
+            return;
+        }
+
+        if (!text::equalsIgnoreCase(actionToken, "ADD"))
+        {
+            reportError("SEG arg");
+            return;
+        }
+
+        // SEG ADD <ms> TRAP|SCURVE <speed> [radius_m]: one chassis speed and a steer
+        // radius, spread across the wheels by the same Ackermann table as STEER.
+        // The verb table already capped the line at ADD's five arguments.
+        char *durationToken = args[1];
+        char *profileToken = args[2];
+        char *speedToken = args[3];
+        char *radiusToken = args[4];
+        if (speedToken == nullptr)
+        {
+            reportError("SEG cmd syntax");
+            return;
+        }
+
+        motion::Segment segment{};
+        uint32_t duration = 0;
+        if (!text::parseUnsigned(durationToken, duration) || duration > UINT16_MAX)
+        {
+            reportError("SEG duration");
+            return;
+        }
+        segment.durationMs = static_cast<uint16_t>(duration);
+
+        if (text::equalsIgnoreCase(profileToken, "TRAP"))
+        {
+            segment.profile = motion::Segment::Profile::Trapezoid;
+        }
+        else if (text::equalsIgnoreCase(profileToken, "SCURVE"))
         {
-            const char incoming = static_cast<char>(m_serial.read());
-
-            if (incoming == '\r')
-            {
-                continue;
-            }
+            segment.profile = motion::Segment::Profile::SCurve;
+        }
+        else
+        {
+            reportError("SEG profile");
+            return;
+        }
 
-            if (incoming == '\n')
-            {
-                if (m_bufferLength > 0)
-                {
-                    m_buffer[m_bufferLength] = '\0';
-                    // A complete command arrived: feed the deadman and clear any
-                    // active failsafe so the link is considered alive again.
-                    m_lastCommandMillis = millis();
-                    m_hasReceivedCommand = true;
-                    m_failsafeActive = false;
-                    handleLine();
-                }
-                resetBuffer();
-                continue;
-            }
+        float speed = 0.0f;
+        if (!text::parseFixed(speedToken, speed) || speed < -1.0f || speed > 1.0f)
+        {
+            reportError("SEG speed");
+            return;
+        }
 
-            if (m_bufferLength >= kBufferSize - 1)
+        float radius = 0.0f;
+        if (radiusToken != nullptr)
+        {
+            if (!text::parseFixed(radiusToken, radius))
             {
-                reportError("Line too long");
-                resetBuffer();
-                continue;
+                reportError("SEG radius");
+                return;
             }
+        }
 
-            m_buffer[m_bufferLength++] = incoming;
+        const outputs::steering::Entry entry = outputs::steering::lookup(radius);
+        for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
+        {
+            segment.speedsQ15[index] = static_cast<int16_t>(lroundf(speed * entry.speedRatio[index] * frame::kSpeedScale));
         }
+        memcpy(segment.pulsesUs, entry.pulseUs, sizeof(segment.pulsesUs));
+        appendSegment(segment);
     }
 
-    void UARTCommandInput::update(unsigned long nowMillis)
+    void UARTCommandInput::appendSegment(const motion::Segment &segment)
     {
-        // Deadman failsafe: once we have started receiving commands, stop the
-        // motors if the link goes silent for longer than the deadman window.
-        // Servos are intentionally left holding their last position.
-        if (!m_hasReceivedCommand || m_failsafeActive)
+        if (segment.durationMs == 0 || segment.durationMs > motion::SegmentPlayer::kMaxDurationMs)
         {
+            reportError("SEG duration");
             return;
         }
-
-        if (nowMillis - m_lastCommandMillis >= kDeadmanTimeoutMs)
+        if (segment.profile != motion::Segment::Profile::Trapezoid && segment.profile != motion::Segment::Profile::SCurve)
         {
-            m_failsafeActive = true;
-            m_motorController.stopAll();
-            m_serial.println("FAILSAFE STOP: link lost");
+            reportError("SEG profile");
+            return;
         }
+        if (!m_segments.append(segment))
+        {
+            reportError("SEG full");
+            return;
+        }
+        replyOk();
     }
 
-    void UARTCommandInput::resetBuffer()
-    {
-        memset(m_buffer, 0, sizeof(m_buffer));
-        m_bufferLength = 0;
-    }
-
-    void UARTCommandInput::handleLine()
+    void UARTCommandInput::startSegments()
     {
-        char *savePtr = nullptr;
-        char *token = strtok_r(m_buffer, " \t", &savePtr);
-        if (token == nullptr)
+        if (m_segmentOutputActive)
         {
+            reportError("SEG playing");
             return;
         }
-
-        if (strcasecmp(token, "PING") == 0)
+        if (m_segments.queued() == 0)
         {
-            m_serial.println("PONG");
+            reportError("SEG empty");
             return;
         }
 
-        if (strcasecmp(token, "S") == 0)
+        // Segments carry per-wheel speeds, so any STEER speed scaling is dropped first,
+        // and the first segment blends from what the controllers are doing now.
+        scheduler::MotorCommand scales{};
+        scales.kind = scheduler::MotorCommand::Kind::SetSpeedScales;
+        for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
         {
-            char *channelToken = strtok_r(nullptr, " \t", &savePtr);
-            char *pulseToken = strtok_r(nullptr, " \t", &savePtr);
-            if (channelToken == nullptr || pulseToken == nullptr)
-            {
-                reportError("S cmd syntax");
-                return;
-            }
-            handleServoCommand(channelToken, pulseToken);
+            scales.targets[index] = 1.0f;
+            m_segmentSpeeds[index] = m_motorController.targetSpeedQ15(index);
+        }
+        if (refuseShed(scales))
+        {
+            return;
+        }
+        if (!m_queues.motor.push(scales))
+        {
+            diagnostics::Stats::increment(m_stats.counters().busyRejects);
+            reportError("Busy");
             return;
         }
+        markMotionCommand();
+        for (uint8_t channel = 0; channel < outputs::ServoController::kServoCount; ++channel)
+        {
+            m_segmentPulses[channel] = m_servoController.currentPulseUs(channel);
+        }
+
+        const unsigned long nowMillis = millis();
+        m_segments.start(nowMillis, m_segmentSpeeds, m_segmentPulses);
+        m_segmentOutputActive = true;
+        m_lastSegmentSampleMs = nowMillis - kSegmentSamplePeriodMs;
+        m_lastSegmentServoMs = nowMillis - kSegmentServoPeriodMs;
+        replyOk();
+    }
 
-        if (strcasecmp(token, "SWEEP") == 0)
+    void UARTCommandInput::playSegments(unsigned long nowMillis)
+    {
+        if (!m_segmentOutputActive || nowMillis - m_lastSegmentSampleMs < kSegmentSamplePeriodMs)
         {
-            char *stateToken = strtok_r(nullptr, " \t", &savePtr);
-            if (stateToken == nullptr)
-            {
-                reportError("SWEEP cmd syntax");
-                return;
-            }
-            char *rangeToken = strtok_r(nullptr, " \t", &savePtr);
-            char *extraToken = strtok_r(nullptr, " \t", &savePtr);
-            if (extraToken != nullptr)
-            {
-                reportError("SWEEP extra args");
-                return;
-            }
-            handleSweepCommand(stateToken, rangeToken);
             return;
         }
+        m_lastSegmentSampleMs = nowMillis;
+
+        int16_t speeds[outputs::MotorController::kMotorCount];
+        uint16_t pulses[outputs::ServoController::kServoCount];
+        m_segments.sample(nowMillis, speeds, pulses);
+        const bool finished = !m_segments.playing();
 
-        if (strcasecmp(token, "LOG") == 0)
+        // A full queue just means this sample is retried on the next; the plan runs
+        // on its own timeline either way.
+        if (memcmp(speeds, m_segmentSpeeds, sizeof(speeds)) != 0)
         {
-            char *stateToken = strtok_r(nullptr, " \t", &savePtr);
-            if (stateToken == nullptr)
+            scheduler::MotorCommand command{};
+            command.kind = scheduler::MotorCommand::Kind::SetTargets;
+            for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
             {
-                reportError("LOG cmd syntax");
-                return;
+                command.targets[index] = static_cast<float>(speeds[index]) / static_cast<float>(frame::kSpeedScale);
+            }
+            if (m_queues.motor.push(command))
+            {
+                memcpy(m_segmentSpeeds, speeds, sizeof(speeds));
             }
-            handleTelemetryCommand(stateToken);
-            return;
         }
 
-        if (strcasecmp(token, "MOTOR") == 0)
+        if (memcmp(pulses, m_segmentPulses, sizeof(pulses)) != 0 &&
+            (finished || nowMillis - m_lastSegmentServoMs >= kSegmentServoPeriodMs))
         {
-            char *targetToken = strtok_r(nullptr, " \t", &savePtr);
-            char *modeToken = strtok_r(nullptr, " \t", &savePtr);
-            char *valueToken = strtok_r(nullptr, " \t", &savePtr);
-            char *extraToken = strtok_r(nullptr, " \t", &savePtr);
-            if (targetToken == nullptr || modeToken == nullptr)
+            scheduler::ServoCommand command{};
+            command.kind = scheduler::ServoCommand::Kind::SetPulses;
+            memcpy(command.pulses, pulses, sizeof(command.pulses));
+            if (m_queues.servo.push(command))
             {
-                reportError("MOTOR cmd syntax");
-                return;
+                memcpy(m_segmentPulses, pulses, sizeof(pulses));
+                m_lastSegmentServoMs = nowMillis;
             }
-            handleMotorCommand(targetToken, modeToken, valueToken, extraToken);
-            return;
         }
 
-        if (strcasecmp(token, "HELP") == 0 || strcmp(token, "?") == 0)
+        if (finished && memcmp(speeds, m_segmentSpeeds, sizeof(speeds)) == 0 &&
+            memcmp(pulses, m_segmentPulses, sizeof(pulses)) == 0)
         {
-            handleHelpCommand();
-            return;
+            m_segmentOutputActive = false;
         }
+    }
 
-        reportError("Unknown command");
+    void UARTCommandInput::abortSegments()
+    {
+        m_segments.clear();
+        m_segmentOutputActive = false;
     }
 
-    void UARTCommandInput::handleServoCommand(char *channelToken, char *pulseToken)
+    void UARTCommandInput::replyPong()
+    {
+        m_baudTrial = false;
+        m_serial.println("PONG");
+    }
+
+    void UARTCommandInput::switchBaudRate(unsigned long baudRate)
+    {
+        // The command task is the only writer, so once the TX drains nothing is cut
+        // off mid-frame. Draining the 128-byte TX FIFO stalls this task up to ~11 ms
+        // at 115200, once per switch; the motor task is on the other core.
+        m_serial.flush();
+        m_serial.updateBaudRate(baudRate);
+        m_baudRate = baudRate;
+        m_baudTrial = false;
+    }
+
+    void UARTCommandInput::handleStatsCommand(char *actionToken)
     {
-        char *endChannel = nullptr;
-        long channel = strtol(channelToken, &endChannel, 10);
-        if (endChannel == nullptr || *endChannel != '\0' || channel < 0 || channel > 15)
+        if (actionToken == nullptr)
         {
-            reportError("Servo channel");
+            m_stats.print(m_serial, millis(), m_telemetryReporter.skippedFrames());
+            replyOk();
             return;
         }
 
-        char *endPulse = nullptr;
-        long pulse = strtol(pulseToken, &endPulse, 10);
-        if (endPulse == nullptr || *endPulse != '\0')
+        if (text::equalsIgnoreCase(actionToken, "RESET"))
         {
-            reportError("Servo pulse");
+            m_stats.reset(millis());
+            m_telemetryReporter.resetSkippedFrames();
+            replyOk();
             return;
         }
 
-        m_servoController.setTargetMicroseconds(static_cast<uint8_t>(channel), static_cast<uint16_t>(pulse));
-        m_serial.println("OK");
+        reportError("STATS arg");
     }
 
-    void UARTCommandInput::handleSweepCommand(char *stateToken, char *rangeToken)
+    void UARTCommandInput::handleLatencyCommand(char *actionToken)
     {
-        if (stateToken == nullptr)
+        diagnostics::ActuationLatency &latency = m_stats.actuation();
+        if (actionToken == nullptr)
         {
-            reportError("SWEEP arg");
+            m_serial.printf("LAT enabled=%d\n", latency.enabled() ? 1 : 0);
+            latency.print(m_serial);
+            replyOk();
             return;
         }
 
-        bool enable = false;
-        if (strcasecmp(stateToken, "ON") == 0)
+        if (text::equalsIgnoreCase(actionToken, "ON") || text::equalsIgnoreCase(actionToken, "OFF"))
         {
-            enable = true;
-        }
-        else if (strcasecmp(stateToken, "OFF") == 0)
-        {
-            enable = false;
-        }
-        else
-        {
-            reportError("SWEEP arg");
+            latency.setEnabled(text::equalsIgnoreCase(actionToken, "ON"));
+            replyOk();
             return;
         }
 
-        if (rangeToken == nullptr)
+        if (text::equalsIgnoreCase(actionToken, "RESET"))
         {
-            m_servoController.enableSweep(enable);
-            m_serial.println("OK");
+            latency.reset();
+            replyOk();
             return;
         }
 
-        uint8_t startChannel = 0;
-        uint8_t endChannel = 0;
-        bool isAll = false;
-        if (!parseSweepRangeToken(rangeToken, startChannel, endChannel, isAll))
+        reportError("LAT arg");
+    }
+
+    void UARTCommandInput::handleRecordCommand(char *actionToken)
+    {
+        if (m_commandLog == nullptr)
         {
-            reportError("SWEEP range");
+            reportError("RECORD not on this port");
             return;
         }
 
-        if (isAll)
+        if (actionToken == nullptr)
         {
-            m_servoController.setSweepEnabledAll(enable);
+            m_serial.printf("RECORD enabled=%d entries=%lu overwritten=%lu bytes=%lu/%lu\n",
+                            m_commandLog->enabled() ? 1 : 0, static_cast<unsigned long>(m_commandLog->entryCount()),
+                            static_cast<unsigned long>(m_commandLog->overwritten()),
+                            static_cast<unsigned long>(m_commandLog->usedBytes()),
+                            static_cast<unsigned long>(diagnostics::CommandLog::kCapacityBytes));
+            replyOk();
+            return;
         }
-        else
+
+        if (text::equalsIgnoreCase(actionToken, "ON") || text::equalsIgnoreCase(actionToken, "OFF"))
         {
-            m_servoController.setSweepEnabledRange(startChannel, endChannel, enable);
+            m_commandLog->setEnabled(text::equalsIgnoreCase(actionToken, "ON"));
+            replyOk();
+            return;
         }
 
-        m_serial.println("OK");
-    }
-
-    void UARTCommandInput::handleTelemetryCommand(char *stateToken)
-    {
-        if (strcasecmp(stateToken, "ON") == 0)
+        if (text::equalsIgnoreCase(actionToken, "DUMP"))
         {
-            m_servoController.enableTelemetry(true);
-            m_serial.println("OK");
+            // Blocks this task until the dump has gone out (~8 KB): nothing else on
+            // this port is parsed meanwhile, so take one with the rover stopped.
+            m_commandLog->dump(m_serial);
+            replyOk();
             return;
         }
 
-        if (strcasecmp(stateToken, "OFF") == 0)
+        if (text::equalsIgnoreCase(actionToken, "CLEAR"))
         {
-            m_servoController.enableTelemetry(false);
-            m_serial.println("OK");
+            m_commandLog->clear();
+            replyOk();
             return;
         }
 
-        reportError("LOG arg");
+        reportError("RECORD arg");
     }
 
-    void UARTCommandInput::handleMotorCommand(char *targetToken, char *modeToken, char *valueToken, char *extraToken)
+    void UARTCommandInput::handleHealthCommand()
     {
-        uint8_t motorIndex = 0;
-        bool targetAll = false;
-        if (!parseMotorTargetToken(targetToken, motorIndex, targetAll))
+        if (m_healthMonitor == nullptr)
         {
-            reportError("MOTOR target");
+            reportError("HEALTH not on this port");
             return;
         }
+        m_healthMonitor->print(m_serial, millis());
+        replyOk();
+    }
 
-        if (modeToken == nullptr)
-        {
-            reportError("MOTOR arg");
-            return;
-        }
+    void UARTCommandInput::handleCalibrateCommand(const text::Args &args)
+    {
+        char *firstToken = args[0];
+
+        scheduler::MotorCommand command{};
 
-        if (strcasecmp(modeToken, "STOP") == 0)
+        if (text::equalsIgnoreCase(firstToken, "SHOW") || text::equalsIgnoreCase(firstToken, "SAVE") ||
+            text::equalsIgnoreCase(firstToken, "MARK") || text::equalsIgnoreCase(firstToken, "ABORT"))
         {
-            if (valueToken != nullptr || extraToken != nullptr)
+            if (args.count > 1)
             {
-                reportError("MOTOR STOP args");
+                reportError("CALIBRATE extra args");
                 return;
             }
-            if (targetAll)
+
+            if (text::equalsIgnoreCase(firstToken, "SHOW"))
             {
-                m_motorController.stopAll();
+                printCalibration();
+                replyOk();
+                return;
             }
-            else
+
+            if (text::equalsIgnoreCase(firstToken, "SAVE"))
             {
-                m_motorController.stop(motorIndex);
+                // The curves share one blob with the servo tuning, so this saves
+                // both, exactly as CONFIG SAVE does.
+                if (saveConfig("CALIBRATE motors busy", "CALIBRATE save failed"))
+                {
+                    replyOk();
+                }
+                return;
             }
-            m_serial.println("OK");
+
+            command.kind = (text::equalsIgnoreCase(firstToken, "MARK"))
+                               ? scheduler::MotorCommand::Kind::CalibrationMark
+                               : scheduler::MotorCommand::Kind::CalibrationAbort;
+            submit(command);
             return;
         }
 
-        if (strcasecmp(modeToken, "START") == 0)
+        uint8_t motorIndex = 0;
+        bool targetAll = false;
+        if (!parseMotorTargetToken(firstToken, motorIndex, targetAll) || targetAll)
         {
-            if (valueToken != nullptr || extraToken != nullptr)
-            {
-                reportError("MOTOR START args");
-                return;
-            }
-            if (targetAll)
-            {
-                m_motorController.startAll();
-            }
-            else
-            {
-                m_motorController.start(motorIndex);
-            }
-            m_serial.println("OK");
+            reportError("CALIBRATE target");
             return;
         }
+        command.motorIndex = motorIndex;
 
-        outputs::MotorController::Direction direction;
-        if (strcasecmp(modeToken, "FORWARD") == 0)
+        char *modeToken = args[1];
+        if (modeToken == nullptr)
         {
-            direction = outputs::MotorController::Direction::Forward;
+            reportError("CALIBRATE arg");
+            return;
         }
-        else if (strcasecmp(modeToken, "BACKWARD") == 0)
+
+        if (text::equalsIgnoreCase(modeToken, "SWEEP"))
         {
-            direction = outputs::MotorController::Direction::Backward;
+            if (args.count > 2)
+            {
+                reportError("CALIBRATE extra args");
+                return;
+            }
+            command.kind = scheduler::MotorCommand::Kind::CalibrationSweep;
+            submit(command);
+            return;
         }
-        else
+
+        if (!text::equalsIgnoreCase(modeToken, "SET"))
         {
-            reportError("MOTOR arg");
+            reportError("CALIBRATE arg");
             return;
         }
 
-        float speed = 1.0f;
-        if (valueToken != nullptr)
+        // deadband gain curve, all required, checked here so a bad line is an ERR
+        // rather than a silent no-op on the motor task.
+        // Five arguments at most, so SET can not have trailing extras by now.
+        float values[3];
+        for (uint8_t index = 0; index < 3; ++index)
         {
-            char *endPtr = nullptr;
-            const float parsed = strtof(valueToken, &endPtr);
-            if (endPtr == nullptr || *endPtr != '\0')
-            {
-                reportError("MOTOR speed");
-                return;
-            }
-            if (parsed < 0.0f || parsed > 1.0f)
+            char *token = args[static_cast<uint8_t>(2 + index)];
+            if (token == nullptr || !text::parseFixed(token, values[index]))
             {
-                reportError("MOTOR speed");
+                reportError("CALIBRATE SET syntax");
                 return;
             }
-            speed = parsed;
         }
 
-        if (extraToken != nullptr)
+        outputs::MotorCalibration calibration;
+        calibration.deadband = values[0];
+        calibration.gain = values[1];
+        calibration.curve = values[2];
+        if (!calibration.valid())
         {
-            reportError("MOTOR extra args");
+            reportError("CALIBRATE values");
             return;
         }
 
-        if (targetAll)
+        command.kind = scheduler::MotorCommand::Kind::SetCalibration;
+        command.targets[0] = calibration.deadband;
+        command.targets[1] = calibration.gain;
+        command.targets[2] = calibration.curve;
+        submit(command);
+    }
+
+    void UARTCommandInput::printCalibration()
+    {
+        for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
         {
-            m_motorController.runAll(direction, speed, true);
+            const outputs::MotorCalibration &calibration = m_motorController.calibration(index);
+            m_serial.printf("CAL %u deadband=%.3f gain=%.3f curve=%.2f\n",
+                            index, calibration.deadband, calibration.gain, calibration.curve);
         }
-        else
+        if (m_motorController.sweepActive())
         {
-            m_motorController.run(motorIndex, direction, speed, true);
+            m_serial.printf("CAL SWEEP %u duty=%.3f\n", m_motorController.sweepMotor(), m_motorController.sweepDuty());
         }
-        m_serial.println("OK");
     }
 
     void UARTCommandInput::handleHelpCommand()
@@ -388,21 +1992,15 @@ namespace inputs
 
         isAllRequest = false;
 
-        if (strcasecmp(token, "ALL") == 0 || strcasecmp(token, "[ALL]") == 0)
+        if (text::equalsIgnoreCase(token, "ALL") || text::equalsIgnoreCase(token, "[ALL]"))
         {
             motorIndex = 0;
             isAllRequest = true;
             return true;
         }
 
-        char *endPtr = nullptr;
-        const long parsed = strtol(token, &endPtr, 10);
-        if (endPtr == nullptr || *endPtr != '\0')
-        {
-            return false;
-        }
-
-        if (parsed < 0 || parsed >= outputs::MotorController::kMotorCount)
+        uint32_t parsed = 0;
+        if (!text::parseUnsigned(token, parsed) || parsed >= outputs::MotorController::kMotorCount)
         {
             return false;
         }
@@ -420,7 +2018,7 @@ namespace inputs
 
         isAllRequest = false;
 
-        if (strcasecmp(token, "ALL") == 0 || strcasecmp(token, "[ALL]") == 0)
+        if (text::equalsIgnoreCase(token, "ALL") || text::equalsIgnoreCase(token, "[ALL]"))
         {
             startChannel = 0;
             endChannel = outputs::ServoController::kServoCount - 1;
@@ -435,30 +2033,16 @@ namespace inputs
             char *startToken = token;
             char *endToken = dash + 1;
 
-            char *endPtr = nullptr;
-            long startValue = strtol(startToken, &endPtr, 10);
-            if (endPtr == nullptr || *endPtr != '\0')
-            {
-                return false;
-            }
-
-            endPtr = nullptr;
-            long endValue = strtol(endToken, &endPtr, 10);
-            if (endPtr == nullptr || *endPtr != '\0')
-            {
-                return false;
-            }
-
-            if (startValue < 0 || endValue < 0)
+            uint32_t startValue = 0;
+            uint32_t endValue = 0;
+            if (!text::parseUnsigned(startToken, startValue) || !text::parseUnsigned(endToken, endValue))
             {
                 return false;
             }
 
             if (startValue > endValue)
             {
-                long temp = startValue;
-                startValue = endValue;
-                endValue = temp;
+                std::swap(startValue, endValue);
             }
 
             if (endValue >= outputs::ServoController::kServoCount)
@@ -471,14 +2055,8 @@ namespace inputs
             return true;
         }
 
-        char *endPtr = nullptr;
-        long channelValue = strtol(token, &endPtr, 10);
-        if (endPtr == nullptr || *endPtr != '\0')
-        {
-            return false;
-        }
-
-        if (channelValue < 0 || channelValue >= outputs::ServoController::kServoCount)
+        uint32_t channelValue = 0;
+        if (!text::parseUnsigned(token, channelValue) || channelValue >= outputs::ServoController::kServoCount)
         {
             return false;
         }
@@ -490,8 +2068,141 @@ namespace inputs
 
     void UARTCommandInput::reportError(const char *message)
     {
+        // Errors are never coalesced, in either reply mode.
+        diagnostics::Stats::increment(m_stats.counters().errorReplies);
         m_serial.print("ERR ");
+        if (m_hasSequence)
+        {
+            m_serial.print('#');
+            m_serial.print(static_cast<unsigned long>(m_sequence));
+            m_serial.print(' ');
+        }
         m_serial.println(message);
     }
 
+    void UARTCommandInput::replyOk()
+    {
+        // Only a tagged command can be folded into an ACK <seq>. An untagged line or
+        // a binary frame, which has no tag to carry, still gets its OK.
+        if (!m_ackMode || !m_hasSequence)
+        {
+            m_serial.println("OK");
+            return;
+        }
+
+        m_ackSequence = m_sequence;
+        m_ackPending = true;
+    }
+
+    void UARTCommandInput::flushAck(unsigned long nowMillis)
+    {
+        if (!m_ackMode || !m_ackPending)
+        {
+            return;
+        }
+
+        if (nowMillis - m_lastAckMillis < m_ackIntervalMs)
+        {
+            return;
+        }
+
+        m_lastAckMillis = nowMillis;
+        m_ackPending = false;
+        m_serial.print("ACK ");
+        m_serial.println(static_cast<unsigned long>(m_ackSequence));
+    }
+
+    bool UARTCommandInput::enqueue(const scheduler::MotorCommand &command)
+    {
+        if (m_segmentOutputActive)
+        {
+            abortSegments();
+        }
+        scheduler::MotorCommand stamped = command;
+        stamped.stampUs = m_dispatchStampUs;
+        if (!m_queues.motor.push(stamped))
+        {
+            return false;
+        }
+        markMotionCommand();
+        return true;
+    }
+
+    bool UARTCommandInput::enqueue(const scheduler::ServoCommand &command)
+    {
+        if (m_segmentOutputActive)
+        {
+            abortSegments();
+        }
+        scheduler::ServoCommand stamped = command;
+        stamped.stampUs = m_dispatchStampUs;
+        return m_queues.servo.push(stamped);
+    }
+
+    void UARTCommandInput::submit(const scheduler::MotorCommand &command)
+    {
+        if (refuseShed(command))
+        {
+            return;
+        }
+        if (!enqueue(command))
+        {
+            diagnostics::Stats::increment(m_stats.counters().busyRejects);
+            reportError("Busy");
+            return;
+        }
+        replyOk();
+    }
+
+    void UARTCommandInput::submit(const scheduler::ServoCommand &command)
+    {
+        if (refuseShed(command))
+        {
+            return;
+        }
+        if (!enqueue(command))
+        {
+            diagnostics::Stats::increment(m_stats.counters().busyRejects);
+            reportError("Busy");
+            return;
+        }
+        replyOk();
+    }
+
+    bool UARTCommandInput::refuseShed(const scheduler::MotorCommand &command)
+    {
+        if (m_healthMonitor == nullptr || !scheduler::sheds(m_healthMonitor->level(), command))
+        {
+            return false;
+        }
+        diagnostics::Stats::increment(m_stats.counters().shedCommands);
+        reportError("Shed");
+        return true;
+    }
+
+    bool UARTCommandInput::refuseShed(const scheduler::ServoCommand &command)
+    {
+        if (m_healthMonitor == nullptr || !scheduler::sheds(m_healthMonitor->level(), command))
+        {
+            return false;
+        }
+        diagnostics::Stats::increment(m_stats.counters().shedCommands);
+        reportError("Shed");
+        return true;
+    }
+
+    void UARTCommandInput::requestStopAll()
+    {
+        m_stream.valid = false;
+        // Queued segments too: nothing planned before a stop should run after it.
+        abortSegments();
+        scheduler::MotorCommand command{};
+        command.kind = scheduler::MotorCommand::Kind::StopAll;
+        command.stampUs = m_dispatchStampUs;
+        if (!m_queues.motor.push(command))
+        {
+            m_queues.stopAllPending.store(true);
+        }
+    }
+
 } // namespace inputs
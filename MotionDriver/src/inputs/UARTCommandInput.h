@@ -1,9 +1,21 @@
 #pragma once
 
 #include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
+#include "diagnostics/CommandLog.h"
+#include "diagnostics/Stats.h"
+#include "inputs/BinaryFrame.h"
+#include "inputs/TextCommand.h"
+#include "motion/SegmentPlayer.h"
 #include "outputs/ServoController.h"
 #include "outputs/MotorController.h"
+#include "scheduler/Commands.h"
+#include "scheduler/HealthMonitor.h"
+#include "scheduler/SpscQueue.h"
+#include "telemetry/TelemetryReporter.h"
 
 namespace inputs
 {
@@ -11,39 +23,286 @@ namespace inputs
     class UARTCommandInput
     {
     public:
-        UARTCommandInput(HardwareSerial &serial, outputs::ServoController &servoController, outputs::MotorController &motorController);
+        // Parsed commands are not applied here: they are queued for the tasks that own
+        // the controllers (see scheduler::ControlScheduler).
+        // LOG only retunes the telemetry reporter, which the command task drives. Stats
+        // is counted into as events happen and printed by STATS. The controllers are
+        // read-only here: for CALIBRATE SHOW/SAVE, and where SEG GO blends from. POWER
+        // sets the budget directly, since both tasks only ever read it.
+        UARTCommandInput(HardwareSerial &serial, scheduler::CommandQueues &queues,
+                         telemetry::TelemetryReporter &telemetryReporter,
+                         diagnostics::Stats &stats,
+                         const outputs::MotorController &motorController,
+                         const outputs::ServoController &servoController,
+                         outputs::PowerBudget &powerBudget);
 
-        void begin(unsigned long baudRate);
+        // What arms a port's deadman. A port the Pi drives arms on any command, so a
+        // silent link always stops the rover; a console arms only once it has moved
+        // something itself, so a HELP typed there never stops what the Pi is doing.
+        enum class DeadmanPolicy : uint8_t
+        {
+            AnyCommand,
+            MotionCommands,
+            Off
+        };
+
+        // Per-port setup, before begin(). Defaults suit the Pi's control link: any
+        // command arms the deadman, and input is timed for LAT. Each LAT histogram has
+        // a single writer, so at most one port may be timed.
+        void setDeadmanPolicy(DeadmanPolicy policy) { m_deadmanPolicy = policy; }
+        void setLatencyTimed(bool timed) { m_latencyTimed = timed; }
+        // Records what this port receives for RECORD DUMP. The log is written and
+        // dumped from this port's command task only, so give each port its own.
+        void setCommandLog(diagnostics::CommandLog *log) { m_commandLog = log; }
+        // Answers HEALTH, and prints a HEALTH line from update() whenever the level
+        // changes. Only read here, so every port may share the scheduler's.
+        void setHealthMonitor(const scheduler::HealthMonitor *monitor) { m_healthMonitor = monitor; }
+
+        // Opens the port and hooks its receive event. From then on bytes are framed as
+        // they arrive, off the command task, into a ring of complete lines/frames.
+        // baudRate is also the base rate BAUD falls back to; the pins default to the
+        // port's own.
+        void begin(unsigned long baudRate, int8_t rxPin = -1, int8_t txPin = -1);
+        // Parses every complete line or frame waiting in the ring.
         void poll();
 
-        // Deadman failsafe: call every loop with the current millis(). If no
-        // command has arrived within the deadman window, all motors are stopped
-        // (servos are left holding their position).
+        // Deadman failsafe, coalesced ACK flush, BAUD fallback and segment playback:
+        // call every tick with the current millis(). If no command has arrived within
+        // the deadman window once armed, all motors are stopped (servos are left
+        // holding their position) and the link drops back to the base baud rate for
+        // whoever reconnects.
         void update(unsigned long nowMillis);
+        // How long until update() next has work of its own -- the deadman window
+        // closing, a coalesced ACK, BAUD fallback, the next segment sample: 0 if due
+        // now, UINT32_MAX if nothing is pending. New input is signalled separately.
+        uint32_t msUntilDue(unsigned long nowMillis) const;
+        // Task notified (xTaskNotifyGive) each time the receive event drains bytes, so
+        // the command task can block between units instead of polling the ring.
+        void setReceiveWaiter(TaskHandle_t task) { m_receiveWaiter.store(task, std::memory_order_release); }
+
+        bool failsafeActive() const { return m_failsafeActive; }
+
+        // E-STOP: this byte outside a binary frame stops the motors from the receive
+        // event itself -- STBY low and a stop-all flagged to the motor task -- ahead
+        // of anything still waiting to be parsed, which is then dropped. A line it
+        // interrupts is discarded. Ctrl-C, so it also works from a terminal.
+        static constexpr uint8_t kEmergencyStopByte = 0x03;
 
     private:
-        void resetBuffer();
-        void handleLine();
+        static constexpr size_t kBufferSize = 64;
+        static constexpr size_t kReceiveSlots = 8;
+
+        // One complete unit off the wire, framed on the receive side. Errors found
+        // while framing are queued as slots too, so they are reported in order.
+        struct ReceivedFrame
+        {
+            enum class Kind : uint8_t
+            {
+                Text,   // NUL-terminated line, no CR/LF
+                Binary, // opcode + payload + crc, CRC already checked
+                LineTooLong,
+                FrameOpcode,
+                FrameLength,
+                FrameCrc
+            };
+
+            Kind kind;
+            uint8_t length;
+            // LAT receive stamp (micros() when framed); 0 while LAT is off.
+            uint32_t receivedUs;
+            // micros() when framed, for the command log; 0 with no log attached.
+            uint32_t framedUs;
+            char data[kBufferSize];
+        };
+
+        void receive();
+        void receiveByte(uint8_t incoming);
+        void commitSlot(ReceivedFrame::Kind kind);
+        void queueError(ReceivedFrame::Kind kind);
+        // Receive side of E-STOP; takeEmergencyStop() is the command task's.
+        void triggerEmergencyStop();
+        bool takeEmergencyStop();
+        void dispatch(ReceivedFrame &received);
+        void record(diagnostics::CommandLog::Kind kind, uint32_t atUs, const char *text);
+        void markCommandReceived();
+        // A command that moves the motors was accepted; arms a MotionCommands deadman.
+        void markMotionCommand();
+        // Splits the line, finds its verb in the verb table and checks the argument
+        // count against the verb's schema before calling its handler.
+        void handleLine(char *line);
+        void handleFrame(const uint8_t *frameData);
+        void handleDriveFrame(const uint8_t *payload);
+        void handleServoFrame(const uint8_t *payload);
+        void handleKeyframe(const uint8_t *payload);
+        void handleDeltaFrame(const uint8_t *payload);
+        void handleSegmentFrame(const uint8_t *payload);
+        // Queues the mirrored stream targets for whichever groups changed, all of them
+        // or none; false (reply already sent) if a queue was full or the level sheds them.
+        bool submitStream(const int16_t speeds[outputs::MotorController::kMotorCount],
+                          const uint16_t pulses[outputs::ServoController::kServoCount],
+                          bool motorsChanged, bool servosChanged);
         void handleServoCommand(char *channelToken, char *pulseToken);
         void handleSweepCommand(char *stateToken, char *rangeToken);
-        void handleTelemetryCommand(char *stateToken);
-        void handleMotorCommand(char *targetToken, char *modeToken, char *valueToken, char *extraToken);
+        void handleSlewCommand(char *rangeToken, char *rateToken);
+        void handleTrimCommand(char *rangeToken, char *trimToken);
+        void handleLimitCommand(const text::Args &args);
+        void handleConfigCommand(char *actionToken);
+        // Snapshots every servo's and motor's tuning and writes it to NVS. Only from
+        // rest (reply already sent when false): a flash write stalls both cores, and
+        // a tuning command still queued would be missed.
+        bool saveConfig(const char *busyError, const char *failedError);
+        void handlePowerCommand(char *subToken, char *valueToken);
+        void handleTelemetryCommand(char *stateToken, char *rateToken);
+        void handleMotorCommand(char *targetToken, char *modeToken, char *valueToken);
+        void handleDriveCommand(const text::Args &args);
+        void handleSteerCommand(char *radiusToken);
+        void handleAckCommand(char *stateToken, char *intervalToken);
+        void handleStatsCommand(char *actionToken);
+        void handleLatencyCommand(char *actionToken);
+        void handleRecordCommand(char *actionToken);
+        void handleHealthCommand();
+        // Records the unit's parse latency and carries its stamp into enqueue().
+        void beginLatencyStamp(uint32_t receivedUs);
+        void handleBaudCommand(char *rateToken);
+        void handleSegmentCommand(const text::Args &args);
+        void appendSegment(const motion::Segment &segment);
+        void startSegments();
+        // Samples the playing segment and queues whatever changed. Pushes straight to
+        // the queues: enqueue() would read the player's own output as an override.
+        void playSegments(unsigned long nowMillis);
+        void abortSegments();
+        // PING reply; also confirms a BAUD switch on trial.
+        void replyPong();
+        void switchBaudRate(unsigned long baudRate);
+        void handleCalibrateCommand(const text::Args &args);
+        void printCalibration();
         void handleHelpCommand();
         bool parseSweepRangeToken(char *token, uint8_t &startChannel, uint8_t &endChannel, bool &isAllRequest);
         bool parseMotorTargetToken(char *token, uint8_t &motorIndex, bool &isAllRequest);
         void reportError(const char *message);
+        // Success reply: OK in the default mode; in ACK mode, folds a tagged command's
+        // sequence number into the next coalesced ACK instead.
+        void replyOk();
+        void flushAck(unsigned long nowMillis);
+        // Queue a command for its controller's task; false if its queue is full. Any
+        // such direct command takes over from a playing segment list.
+        bool enqueue(const scheduler::MotorCommand &command);
+        bool enqueue(const scheduler::ServoCommand &command);
+        // enqueue() and reply OK, or ERR Busy if the queue was full.
+        void submit(const scheduler::MotorCommand &command);
+        void submit(const scheduler::ServoCommand &command);
+        // True, after replying ERR Shed, if the health level drops this command.
+        bool refuseShed(const scheduler::MotorCommand &command);
+        bool refuseShed(const scheduler::ServoCommand &command);
+        // Stop-all cannot be refused: if the queue is full it is flagged instead. Also
+        // ends any stream, since its mirror no longer matches what the motors do, and
+        // drops every queued segment.
+        void requestStopAll();
 
-        static constexpr size_t kBufferSize = 64;
         static constexpr unsigned long kDeadmanTimeoutMs = 1000;
+        static constexpr unsigned long kDefaultAckIntervalMs = 20;
+        static constexpr unsigned long kMaxAckIntervalMs = 500;
+        // After a BAUD switch the host has this long to PING at the new rate before
+        // the link falls back to the base rate.
+        static constexpr unsigned long kBaudConfirmMs = 1000;
+        // Segment playback sample rates. Servo pulses only change once per 20 ms PWM
+        // frame, so sampling them faster would just be I2C traffic.
+        static constexpr unsigned long kSegmentSamplePeriodMs = 5;
+        static constexpr unsigned long kSegmentServoPeriodMs = 20;
+        // POWER BUDGET ceiling: the 15 A fuse at the battery, past which a budget means
+        // nothing.
+        static constexpr unsigned long kMaxPowerBudgetMa = 15000;
+        // What the USB-UART bridges we use lock onto reliably; a higher rate only helps
+        // if both ends hit it within a couple of percent.
+        static constexpr unsigned long kSupportedBaudRates[] = {115200, 230400, 460800, 921600, 1500000, 2000000};
+
+        static_assert(frame::kMaxFrameLength <= kBufferSize, "Binary frame must fit a receive slot");
 
         HardwareSerial &m_serial;
-        outputs::ServoController &m_servoController;
-        outputs::MotorController &m_motorController;
-        char m_buffer[kBufferSize];
-        size_t m_bufferLength;
+        scheduler::CommandQueues &m_queues;
+        telemetry::TelemetryReporter &m_telemetryReporter;
+        diagnostics::Stats &m_stats;
+        const outputs::MotorController &m_motorController;
+        const outputs::ServoController &m_servoController;
+        outputs::PowerBudget &m_powerBudget;
+
+        // Receive side, touched only from the serial event callback. m_slot is the
+        // ring slot being filled; nullptr means the ring was full and input is being
+        // discarded up to the next line/frame boundary.
+        scheduler::SpscQueue<ReceivedFrame, kReceiveSlots> m_received;
+        ReceivedFrame *m_slot;
+        size_t m_slotLength;
+        // Binary frame in progress: m_inFrame stays set from the sync byte until the
+        // frame completes or is dropped. The sync byte itself is not stored.
+        size_t m_frameExpected;
+        bool m_inFrame;
+        // Variable-length frames: the opcode and its length header, copied aside so
+        // the length is known even while the ring is full and bytes go nowhere.
+        uint8_t m_frameOpcode;
+        size_t m_frameHeaderBytes;
+        uint8_t m_frameHeader[frame::kMaxLengthHeaderBytes];
+        bool m_discardingLine;
+        std::atomic<uint32_t> m_droppedFrames;
+        // Units committed to the ring so far, and how many of them came before the
+        // last E-STOP; poll() drops those rather than run them after the stop.
+        uint32_t m_committedSlots;
+        std::atomic<uint32_t> m_emergencyStopCutoff;
+        std::atomic<uint32_t> m_emergencyStopUs;
+        std::atomic<bool> m_emergencyStopPending;
+        std::atomic<TaskHandle_t> m_receiveWaiter;
+
+        // Consumer side, touched only from poll()/update().
+        uint32_t m_reportedDroppedFrames;
+        uint32_t m_releasedSlots;
+        // Receive stamp of the unit being dispatched, copied onto everything it queues
+        // so the output task can time it; 0 outside dispatch and while LAT is off.
+        uint32_t m_dispatchStampUs;
+
+        // Asynchronous reply mode. m_sequence is the "#<seq>" tag of the command being
+        // handled, if it had one; m_ackSequence is the latest success not yet ACKed.
+        bool m_ackMode;
+        unsigned long m_ackIntervalMs;
+        unsigned long m_lastAckMillis;
+        bool m_hasSequence;
+        uint32_t m_sequence;
+        bool m_ackPending;
+        uint32_t m_ackSequence;
         unsigned long m_lastCommandMillis;
-        bool m_hasReceivedCommand;
+        DeadmanPolicy m_deadmanPolicy;
+        bool m_deadmanArmed;
         bool m_failsafeActive;
+        bool m_latencyTimed;
+        diagnostics::CommandLog *m_commandLog;
+        const scheduler::HealthMonitor *m_healthMonitor;
+        scheduler::HealthLevel m_reportedHealth;
+
+        // BAUD negotiation. A switch stays on trial until a PING arrives at the new
+        // rate; kBaudConfirmMs without one, or a deadman trip, returns to base.
+        unsigned long m_baseBaudRate;
+        unsigned long m_baudRate;
+        bool m_baudTrial;
+        unsigned long m_baudTrialStartMs;
+
+        // Stream mode mirror (Keyframe/Delta): the targets as the sender believes
+        // they were last applied. Invalid until a keyframe arrives, and again after a
+        // sequence gap, a refused enqueue or a stop.
+        struct StreamState
+        {
+            bool valid;
+            uint8_t sequence;
+            int16_t speeds[outputs::MotorController::kMotorCount];
+            uint16_t pulses[outputs::ServoController::kServoCount];
+        };
+        StreamState m_stream;
+
+        // Segment playback. m_segmentOutputActive outlives the player's own playing()
+        // until the final values have actually been queued.
+        motion::SegmentPlayer m_segments;
+        bool m_segmentOutputActive;
+        unsigned long m_lastSegmentSampleMs;
+        unsigned long m_lastSegmentServoMs;
+        int16_t m_segmentSpeeds[outputs::MotorController::kMotorCount];
+        uint16_t m_segmentPulses[outputs::ServoController::kServoCount];
     };
 
 } // namespace inputs
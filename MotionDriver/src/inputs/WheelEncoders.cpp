@@ -0,0 +1,118 @@
+#include "WheelEncoders.h"
+
+#include <driver/pcnt.h>
+
+namespace inputs
+{
+
+    namespace
+    {
+        // One unit per wheel; the ESP32 has eight.
+        static_assert(WheelEncoders::kWheelCount <= PCNT_UNIT_MAX, "Not enough PCNT units");
+
+        constexpr float kTwoPi = 6.28318530718f;
+    }
+
+    WheelEncoders::WheelEncoders()
+        : m_fittedMask(0)
+    {
+        for (uint8_t wheel = 0; wheel < kWheelCount; ++wheel)
+        {
+            auto &state = m_wheels[wheel];
+            state.pinA = board::Active::kEncoders[wheel].aPin;
+            state.pinB = board::Active::kEncoders[wheel].bPin;
+            state.count = 0;
+            state.speedRadPerSec = 0.0f;
+        }
+    }
+
+    bool WheelEncoders::begin()
+    {
+        bool ok = true;
+        m_fittedMask = 0;
+
+        for (uint8_t wheel = 0; wheel < kWheelCount; ++wheel)
+        {
+            const auto &state = m_wheels[wheel];
+            if (state.pinA < 0 || state.pinB < 0)
+            {
+                continue;
+            }
+
+            const pcnt_unit_t unit = static_cast<pcnt_unit_t>(wheel);
+
+            // Count both edges of A; B low reverses the count, so forward is positive
+            // whichever way round the motor turns. The PCNT does not wrap: it resets to
+            // 0 on reaching either limit. sample() reads and clears it every period, so
+            // it never gets near them.
+            pcnt_config_t config{};
+            config.pulse_gpio_num = state.pinA;
+            config.ctrl_gpio_num = state.pinB;
+            config.channel = PCNT_CHANNEL_0;
+            config.unit = unit;
+            config.pos_mode = PCNT_COUNT_INC;
+            config.neg_mode = PCNT_COUNT_DEC;
+            config.lctrl_mode = PCNT_MODE_REVERSE;
+            config.hctrl_mode = PCNT_MODE_KEEP;
+            config.counter_h_lim = INT16_MAX;
+            config.counter_l_lim = INT16_MIN;
+
+            if (pcnt_unit_config(&config) != ESP_OK ||
+                pcnt_set_filter_value(unit, kGlitchFilterCycles) != ESP_OK ||
+                pcnt_filter_enable(unit) != ESP_OK ||
+                pcnt_counter_pause(unit) != ESP_OK ||
+                pcnt_counter_clear(unit) != ESP_OK ||
+                pcnt_counter_resume(unit) != ESP_OK)
+            {
+                ok = false;
+                continue;
+            }
+
+            m_fittedMask |= static_cast<uint8_t>(1u << wheel);
+        }
+
+        return ok;
+    }
+
+    void WheelEncoders::sample(uint32_t elapsedUs)
+    {
+        if (m_fittedMask == 0 || elapsedUs == 0)
+        {
+            return;
+        }
+
+        const float radPerCountPerUs = kTwoPi / kCountsPerWheelRev * 1.0e6f / static_cast<float>(elapsedUs);
+
+        for (uint8_t wheel = 0; wheel < kWheelCount; ++wheel)
+        {
+            if (!fitted(wheel))
+            {
+                continue;
+            }
+
+            auto &state = m_wheels[wheel];
+            const pcnt_unit_t unit = static_cast<pcnt_unit_t>(wheel);
+            int16_t delta = 0;
+            // An edge landing between the read and the clear is lost; the window is a
+            // few APB cycles, against hundreds of microseconds between edges at full speed.
+            if (pcnt_get_counter_value(unit, &delta) != ESP_OK || pcnt_counter_clear(unit) != ESP_OK)
+            {
+                continue;
+            }
+
+            state.count += delta;
+            state.speedRadPerSec = static_cast<float>(delta) * radPerCountPerUs;
+        }
+    }
+
+    int32_t WheelEncoders::count(uint8_t wheel) const
+    {
+        return (wheel < kWheelCount) ? m_wheels[wheel].count : 0;
+    }
+
+    float WheelEncoders::speedRadPerSec(uint8_t wheel) const
+    {
+        return (wheel < kWheelCount) ? m_wheels[wheel].speedRadPerSec : 0.0f;
+    }
+
+} // namespace inputs
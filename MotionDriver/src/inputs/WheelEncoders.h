@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "board.h"
+
+namespace inputs
+{
+
+    // Quadrature wheel encoders counted by the PCNT peripheral, one unit per wheel, so
+    // edges cost no CPU. Only wheels with both pins assigned in the board's encoder
+    // map are set up; the rest report as not fitted and their motors stay open-loop.
+    //
+    // Written by the motor task (sample()), read from anywhere: every published value
+    // is a single aligned word.
+    class WheelEncoders
+    {
+    public:
+        static constexpr uint8_t kWheelCount = board::Active::kWheelCount;
+
+        // JGA25-370: 11 pulses per motor revolution on each channel. Counting both
+        // edges of A, with B for direction, gives 2 counts per pulse. The gear ratio
+        // depends on the variant and is a placeholder until one is measured.
+        static constexpr float kPulsesPerMotorRev = 11.0f;
+        static constexpr float kCountsPerPulse = 2.0f;
+        static constexpr float kGearRatio = 34.0f;
+        static constexpr float kCountsPerWheelRev = kPulsesPerMotorRev * kCountsPerPulse * kGearRatio;
+
+        WheelEncoders();
+
+        // Configures a PCNT unit for each fitted wheel. False if the driver rejects one;
+        // that wheel is then treated as not fitted.
+        bool begin();
+
+        // Reads every fitted counter and updates its odometry and speed estimate over
+        // the elapsedUs since the previous call. Call at a fixed period.
+        void sample(uint32_t elapsedUs);
+
+        bool fitted(uint8_t wheel) const { return wheel < kWheelCount && (m_fittedMask & (1u << wheel)) != 0; }
+        uint8_t fittedMask() const { return m_fittedMask; }
+        bool anyFitted() const { return m_fittedMask != 0; }
+
+        // Counts since boot, signed forward-positive, and the last speed estimate.
+        int32_t count(uint8_t wheel) const;
+        float speedRadPerSec(uint8_t wheel) const;
+
+    private:
+        // Rejects glitches shorter than this many APB (80 MHz) cycles: ~1.25 us.
+        static constexpr uint16_t kGlitchFilterCycles = 100;
+
+        struct WheelState
+        {
+            int pinA;
+            int pinB;
+            int32_t count;
+            float speedRadPerSec;
+        };
+
+        uint8_t m_fittedMask;
+        WheelState m_wheels[kWheelCount];
+    };
+
+} // namespace inputs
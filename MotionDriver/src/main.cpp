@@ -1,35 +1,85 @@
 #include <Arduino.h>
 #include <Wire.h>
 
+#include "build_config.h"
+#include "diagnostics/CommandLog.h"
+#include "diagnostics/Stats.h"
 #include "inputs/UARTCommandInput.h"
+#include "inputs/WheelEncoders.h"
+#include "outputs/ConfigStore.h"
 #include "outputs/MotorController.h"
+#include "outputs/PowerBudget.h"
 #include "outputs/ServoController.h"
 #include "pins.h"
+#include "scheduler/Commands.h"
+#include "scheduler/ControlScheduler.h"
+#include "scheduler/LoopTiming.h"
+#include "telemetry/TelemetryReporter.h"
 
 namespace
 {
-    constexpr unsigned long kSerialBaudRate = 115200;
+    constexpr unsigned long kConsoleBaudRate = 115200;
+    // Boot rate of the Pi link; the bridge negotiates it up with BAUD once connected.
+    constexpr unsigned long kControlBaudRate = 115200;
 }
 
+outputs::PowerBudget g_powerBudget;
 outputs::ServoController g_servoController;
 outputs::MotorController g_motorController;
-// Command input runs over USB Serial (UART0) - the Raspberry Pi connects via USB.
-inputs::UARTCommandInput g_uartInput(Serial, g_servoController, g_motorController);
+inputs::WheelEncoders g_wheelEncoders;
+scheduler::CommandQueues g_controlQueues;
+scheduler::CommandQueues g_consoleQueues;
+scheduler::LoopTiming g_motorTiming;
+diagnostics::Stats g_stats;
+// What the Pi sent, for RECORD DUMP; the console is not recorded.
+diagnostics::CommandLog g_controlLog;
+// Each port streams its own telemetry, off until that side sends LOG ON.
+telemetry::TelemetryReporter g_controlTelemetry(Serial2, g_servoController, g_motorController, g_wheelEncoders,
+                                                g_motorTiming);
+telemetry::TelemetryReporter g_consoleTelemetry(Serial, g_servoController, g_motorController, g_wheelEncoders,
+                                                g_motorTiming);
+// The Raspberry Pi's control link is UART2 on its GPIO header (/dev/serial0); USB
+// Serial (UART0) stays a text console for bring-up and debugging.
+inputs::UARTCommandInput g_controlInput(Serial2, g_controlQueues, g_controlTelemetry, g_stats, g_motorController,
+                                        g_servoController, g_powerBudget);
+inputs::UARTCommandInput g_consoleInput(Serial, g_consoleQueues, g_consoleTelemetry, g_stats, g_motorController,
+                                        g_servoController, g_powerBudget);
+scheduler::ControlScheduler g_scheduler(g_controlInput, g_servoController, g_motorController, g_wheelEncoders,
+                                        g_controlQueues, g_controlTelemetry, g_motorTiming, g_stats);
+
+// The task watchdog is about to reset the chip, after which STBY floats (see the
+// brownout notes in HARDWARE.md): pull it low first.
+extern "C" void esp_task_wdt_isr_user_handler(void)
+{
+    g_motorController.cutDrivers();
+}
 
 void setup()
 {
-    // USB Serial (UART0) carries commands to/from the Raspberry Pi.
-    Serial.begin(kSerialBaudRate);
-    while (!Serial && millis() < 3000)
-    {
-    } // Wait up to 3s for USB serial
+    // No wait for a console: UART0 sits behind the board's USB bridge, so Serial is
+    // ready as soon as begin() returns and there is no host connection to detect.
+    // Anything printed before a terminal opens is simply missed.
+    Serial.begin(kConsoleBaudRate);
 
-    g_uartInput.begin(kSerialBaudRate);
+    // Something typed at the console only arms its deadman by moving the rover, so
+    // a HELP there never trips a stop under the Pi. The Pi's link alone is timed.
+    g_consoleInput.setDeadmanPolicy(inputs::UARTCommandInput::DeadmanPolicy::MotionCommands);
+    g_consoleInput.setLatencyTimed(false);
+    g_consoleInput.begin(kConsoleBaudRate);
+    g_controlInput.setCommandLog(&g_controlLog);
+    g_consoleInput.setHealthMonitor(&g_scheduler.health());
+    g_controlInput.setHealthMonitor(&g_scheduler.health());
+    g_controlInput.begin(kControlBaudRate, PIN_UART2_RX, PIN_UART2_TX);
+    g_scheduler.attachConsole(g_consoleInput, g_consoleQueues, g_consoleTelemetry);
 
     Serial.println("Cheddar bring-up");
-    Serial.println("USB Serial (UART0) ready for Pi communication");
+    Serial.println("UART2 ready for Pi communication; USB Serial (UART0) is the console");
+
+    // All the tuning in one NVS read, applied before the first pulse or duty goes out.
+    outputs::StoredConfig config;
+    const bool configFromStore = outputs::config_store::load(config);
 
-    if (!g_servoController.begin(Wire))
+    if (!g_servoController.begin(Wire, config.servos))
     {
         Serial.println("Servo controller init failed. Halting.");
         while (true)
@@ -38,7 +88,7 @@ void setup()
         }
     }
 
-    if (!g_motorController.begin())
+    if (!g_motorController.begin(config.motors))
     {
         Serial.println("Motor controller init failed. Halting.");
         while (true)
@@ -47,14 +97,45 @@ void setup()
         }
     }
 
-    Serial.println("Servo controller ready. Sweep disabled (use 'SWEEP ON').");
-    Serial.println("Motor controller ready. Use 'MOTOR' commands to drive the motor.");
+    // Not fatal: a wheel whose encoder fails to configure just stays open-loop.
+    if (!g_wheelEncoders.begin())
+    {
+        Serial.println("Wheel encoder init failed; affected wheels stay open-loop.");
+    }
+    // Both controllers budget against one pack; the tasks that use it start below.
+    g_powerBudget.begin();
+    g_motorController.attachPowerBudget(g_powerBudget);
+    g_servoController.attachPowerBudget(g_powerBudget);
+
+    if (build::kDebugLog)
+    {
+        Serial.printf("Wheel encoders fitted: mask 0x%02X.\n", g_wheelEncoders.fittedMask());
+
+        Serial.println(configFromStore
+                           ? "Servo and motor tuning loaded from NVS."
+                           : "No stored tuning; using defaults (see 'CONFIG SAVE').");
+        Serial.println("Servo controller ready. Sweep disabled (use 'SWEEP ON').");
+        Serial.println("Motor controller ready. Use 'MOTOR' commands to drive the motor.");
+    }
+
+    if (!g_scheduler.begin())
+    {
+        g_motorController.stopAll();
+        Serial.println("Control scheduler start failed. Halting.");
+        while (true)
+        {
+            delay(1000);
+        }
+    }
+
+    // From the start of the app, not the reset: the ROM and second-stage bootloader
+    // run before millis() starts.
+    Serial.printf("Ready in %lu ms.\n", static_cast<unsigned long>(millis()));
 }
 
 void loop()
 {
-    g_uartInput.poll();
-    g_uartInput.update(millis());
-    g_servoController.update(millis());
-    g_motorController.update(millis());
+    // All work runs in the scheduler's tasks; the Arduino loop task has nothing
+    // left to do, so it gives its stack back.
+    vTaskDelete(nullptr);
 }
@@ -0,0 +1,136 @@
+#include "SegmentPlayer.h"
+
+#include <cstring>
+
+namespace motion
+{
+
+    namespace
+    {
+        // Share of a trapezoid segment spent accelerating (and again decelerating).
+        constexpr float kTrapezoidRampFraction = 0.25f;
+    }
+
+    SegmentPlayer::SegmentPlayer()
+        : m_segments{},
+          m_head(0),
+          m_count(0),
+          m_playing(false),
+          m_segmentStartMs(0),
+          m_fromSpeeds{},
+          m_fromPulses{}
+    {
+    }
+
+    bool SegmentPlayer::append(const Segment &segment)
+    {
+        if (m_count >= kCapacity)
+        {
+            return false;
+        }
+        m_segments[(m_head + m_count) % kCapacity] = segment;
+        ++m_count;
+        return true;
+    }
+
+    void SegmentPlayer::clear()
+    {
+        m_head = 0;
+        m_count = 0;
+        m_playing = false;
+    }
+
+    bool SegmentPlayer::start(uint32_t nowMs, const int16_t speedsQ15[outputs::MotorController::kMotorCount],
+                              const uint16_t pulsesUs[outputs::ServoController::kServoCount])
+    {
+        if (m_count == 0)
+        {
+            return false;
+        }
+        memcpy(m_fromSpeeds, speedsQ15, sizeof(m_fromSpeeds));
+        memcpy(m_fromPulses, pulsesUs, sizeof(m_fromPulses));
+        m_segmentStartMs = nowMs;
+        m_playing = true;
+        return true;
+    }
+
+    void SegmentPlayer::sample(uint32_t nowMs, int16_t speedsQ15[outputs::MotorController::kMotorCount],
+                               uint16_t pulsesUs[outputs::ServoController::kServoCount])
+    {
+        while (m_playing && nowMs - m_segmentStartMs >= m_segments[m_head].durationMs)
+        {
+            m_segmentStartMs += m_segments[m_head].durationMs;
+            retireHead();
+        }
+
+        if (!m_playing)
+        {
+            memcpy(speedsQ15, m_fromSpeeds, sizeof(m_fromSpeeds));
+            memcpy(pulsesUs, m_fromPulses, sizeof(m_fromPulses));
+            return;
+        }
+
+        const Segment &segment = m_segments[m_head];
+        const float t = static_cast<float>(nowMs - m_segmentStartMs) / static_cast<float>(segment.durationMs);
+        const float blend = ease(segment.profile, t);
+        for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
+        {
+            const float from = m_fromSpeeds[index];
+            speedsQ15[index] = static_cast<int16_t>(lroundf(from + blend * (segment.speedsQ15[index] - from)));
+        }
+        for (uint8_t channel = 0; channel < outputs::ServoController::kServoCount; ++channel)
+        {
+            const float from = m_fromPulses[channel];
+            pulsesUs[channel] = static_cast<uint16_t>(lroundf(from + blend * (segment.pulsesUs[channel] - from)));
+        }
+    }
+
+    float SegmentPlayer::ease(Segment::Profile profile, float t)
+    {
+        if (t <= 0.0f)
+        {
+            return 0.0f;
+        }
+        if (t >= 1.0f)
+        {
+            return 1.0f;
+        }
+
+        switch (profile)
+        {
+        case Segment::Profile::Trapezoid:
+        {
+            // Area under a trapezoidal rate curve, normalised so the whole is 1.
+            constexpr float r = kTrapezoidRampFraction;
+            constexpr float peak = 1.0f / (1.0f - r);
+            if (t < r)
+            {
+                return peak * t * t / (2.0f * r);
+            }
+            if (t > 1.0f - r)
+            {
+                const float remaining = 1.0f - t;
+                return 1.0f - peak * remaining * remaining / (2.0f * r);
+            }
+            return peak * (t - r / 2.0f);
+        }
+        case Segment::Profile::SCurve:
+            return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+        }
+        return t;
+    }
+
+    void SegmentPlayer::retireHead()
+    {
+        const Segment &finished = m_segments[m_head];
+        memcpy(m_fromSpeeds, finished.speedsQ15, sizeof(m_fromSpeeds));
+        memcpy(m_fromPulses, finished.pulsesUs, sizeof(m_fromPulses));
+        m_head = (m_head + 1) % kCapacity;
+        --m_count;
+        if (m_count == 0)
+        {
+            m_playing = false;
+        }
+    }
+
+} // namespace motion
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "outputs/MotorController.h"
+#include "outputs/ServoController.h"
+
+namespace motion
+{
+
+    // One timed step of a scripted manoeuvre: over durationMs, blend every wheel
+    // speed and steering pulse from where the previous segment left them to the
+    // values here, eased by profile. A segment's end values are the next one's start.
+    struct Segment
+    {
+        enum class Profile : uint8_t
+        {
+            Trapezoid = 0, // constant accel over the first and last quarter, cruise between
+            SCurve = 1     // smootherstep: acceleration also ramps, so no jerk spikes
+        };
+
+        uint16_t durationMs;
+        Profile profile;
+        int16_t speedsQ15[outputs::MotorController::kMotorCount]; // signed, +-32767 = full
+        uint16_t pulsesUs[outputs::ServoController::kServoCount];
+    };
+
+    // Fixed-capacity ring of segments played on the firmware's own clock, so an
+    // uploaded manoeuvre needs no per-tick traffic from the host. Pure bookkeeping:
+    // the caller samples it and queues the results for the controllers. Touched only
+    // from the command task.
+    class SegmentPlayer
+    {
+    public:
+        static constexpr size_t kCapacity = 16;
+        static constexpr uint16_t kMaxDurationMs = 60000;
+
+        SegmentPlayer();
+
+        // False if the ring is full. Segments may be appended while playing.
+        bool append(const Segment &segment);
+        // Drops every queued segment and stops playback where it stands.
+        void clear();
+
+        // Begins with the oldest queued segment, blending from the given state.
+        // False (and nothing changes) if nothing is queued.
+        bool start(uint32_t nowMs, const int16_t speedsQ15[outputs::MotorController::kMotorCount],
+                   const uint16_t pulsesUs[outputs::ServoController::kServoCount]);
+
+        // Fills in the targets for nowMs, retiring finished segments. Segments run
+        // back to back on the ideal timeline, so a late sample never stretches the
+        // plan. When the last segment completes, playback ends holding its values.
+        void sample(uint32_t nowMs, int16_t speedsQ15[outputs::MotorController::kMotorCount],
+                    uint16_t pulsesUs[outputs::ServoController::kServoCount]);
+
+        bool playing() const { return m_playing; }
+        size_t queued() const { return m_count; }
+
+        // Blend fraction (0..1) at fraction t (0..1) of a segment's duration.
+        static float ease(Segment::Profile profile, float t);
+
+    private:
+        void retireHead();
+
+        Segment m_segments[kCapacity];
+        size_t m_head;
+        size_t m_count;
+        bool m_playing;
+        uint32_t m_segmentStartMs;
+        // Where the head segment blends from.
+        int16_t m_fromSpeeds[outputs::MotorController::kMotorCount];
+        uint16_t m_fromPulses[outputs::ServoController::kServoCount];
+    };
+
+} // namespace motion
@@ -0,0 +1,110 @@
+#include "ConfigStore.h"
+
+#include <Preferences.h>
+
+namespace outputs
+{
+
+    namespace
+    {
+        constexpr const char *kNamespace = "rovercfg";
+        constexpr const char *kKey = "config";
+        // Bump when the layout of StoredConfig (or anything in it) changes; an old
+        // blob is then ignored and everything falls back to the defaults.
+        constexpr uint8_t kBlobVersion = 1;
+
+        struct Blob
+        {
+            uint8_t version;
+            uint8_t servoCount;
+            uint8_t motorCount;
+            StoredConfig config;
+        };
+
+        bool valid(const StoredConfig &config)
+        {
+            for (const ServoController::ChannelConfig &servo : config.servos)
+            {
+                if (!servo.valid())
+                {
+                    return false;
+                }
+            }
+            for (const MotorCalibration &motor : config.motors)
+            {
+                if (!motor.valid())
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool eraseNamespace(const char *name)
+        {
+            Preferences preferences;
+            if (!preferences.begin(name, false))
+            {
+                return false;
+            }
+            const bool cleared = preferences.clear();
+            preferences.end();
+            return cleared;
+        }
+    }
+
+    namespace config_store
+    {
+        bool load(StoredConfig &config)
+        {
+            Preferences preferences;
+            if (!preferences.begin(kNamespace, true))
+            {
+                return false;
+            }
+
+            Blob blob{};
+            const size_t length = preferences.getBytes(kKey, &blob, sizeof(blob));
+            preferences.end();
+
+            if (length != sizeof(blob) || blob.version != kBlobVersion ||
+                blob.servoCount != ServoController::kServoCount || blob.motorCount != MotorController::kMotorCount ||
+                !valid(blob.config))
+            {
+                return false;
+            }
+
+            config = blob.config;
+            return true;
+        }
+
+        bool save(const StoredConfig &config)
+        {
+            if (!valid(config))
+            {
+                return false;
+            }
+
+            Blob blob{};
+            blob.version = kBlobVersion;
+            blob.servoCount = ServoController::kServoCount;
+            blob.motorCount = MotorController::kMotorCount;
+            blob.config = config;
+
+            Preferences preferences;
+            if (!preferences.begin(kNamespace, false))
+            {
+                return false;
+            }
+            const size_t written = preferences.putBytes(kKey, &blob, sizeof(blob));
+            preferences.end();
+            return written == sizeof(blob);
+        }
+
+        bool clear()
+        {
+            return eraseNamespace(kNamespace);
+        }
+    }
+
+} // namespace outputs
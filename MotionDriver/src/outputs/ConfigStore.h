@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "outputs/MotorCalibration.h"
+#include "outputs/MotorController.h"
+#include "outputs/ServoController.h"
+
+namespace outputs
+{
+
+    // Everything the rover is tuned with: each servo's pulse limits, trim and slew
+    // rate, and each motor's duty curve. Defaults until something is loaded.
+    struct StoredConfig
+    {
+        ServoController::ChannelConfig servos[ServoController::kServoCount];
+        MotorCalibration motors[MotorController::kMotorCount];
+    };
+
+    // NVS persistence for StoredConfig as one versioned blob, so boot costs a single
+    // read before either controller starts. Like any flash write, save() and clear()
+    // stall the flash cache on *both* cores while NVS erases; only call them with
+    // the motors stopped.
+    namespace config_store
+    {
+        // Fills config and returns true if a valid blob was stored. Otherwise (nothing stored, an old layout, or any value out of range)
+        // config is left untouched and this returns false.
+        bool load(StoredConfig &config);
+        bool save(const StoredConfig &config);
+        // Forgets everything stored; the defaults return at the next boot.
+        bool clear();
+    }
+
+} // namespace outputs
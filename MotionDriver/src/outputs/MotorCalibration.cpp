@@ -0,0 +1,16 @@
+#include "MotorCalibration.h"
+
+#include <cmath>
+
+namespace outputs
+{
+
+    bool MotorCalibration::valid() const
+    {
+        return std::isfinite(deadband) && std::isfinite(gain) && std::isfinite(curve) &&
+               deadband >= 0.0f && deadband <= kMaxDeadband &&
+               gain <= 1.0f && gain >= deadband + kMinSpan &&
+               curve >= kMinCurve && curve <= kMaxCurve;
+    }
+
+} // namespace outputs
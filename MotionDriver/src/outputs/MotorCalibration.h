@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace outputs
+{
+
+    // Per-motor duty curve: a non-zero speed s (0..1] drives
+    //
+    //     duty = deadband + (gain - deadband) * s^curve
+    //
+    // as a fraction of full LEDC output, and 0 is off. Deadband is where that wheel
+    // breaks loose, gain trims its top end to match the others, and curve > 1 spends
+    // more of the stick on the slow end.
+    struct MotorCalibration
+    {
+        // Measured on hardware 2026-07-16, below which the wheels sit and buzz. It is
+        // a fraction of whatever the rail happens to be, so it MUST be re-measured if
+        // the 8.4V unbucked motor rail changes -- notably if the ~6V motor buck in
+        // HARDWARE.md ever lands. CALIBRATE measures it per motor.
+        static constexpr float kDefaultDeadband = 0.80f;
+        static constexpr float kDefaultGain = 1.0f;
+        static constexpr float kDefaultCurve = 1.0f;
+
+        static constexpr float kMaxDeadband = 0.95f;
+        // Gain must sit at least this far above deadband, or the curve is a step.
+        static constexpr float kMinSpan = 0.05f;
+        static constexpr float kMinCurve = 0.25f;
+        static constexpr float kMaxCurve = 4.0f;
+
+        float deadband = kDefaultDeadband;
+        float gain = kDefaultGain;
+        float curve = kDefaultCurve;
+
+        bool valid() const;
+    };
+
+    // Persisted with the rest of the tuning in outputs/ConfigStore.h.
+
+} // namespace outputs
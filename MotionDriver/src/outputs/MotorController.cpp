@@ -1,82 +1,76 @@
 #include "MotorController.h"
 
+#include <cmath>
+
 namespace outputs
 {
 
-    namespace
-    {
-        // Wheel index -> DRV8833 channel, as the harness is physically wired.
-        // The loom does not follow M1..M6 in wheel order: M1/M2/M3 carry the right
-        // side front->rear, M4/M5/M6 the left side front->rear.
-        //
-        // Four of the six motors also have their leads reversed relative to the DRV8833
-        // forward contract, so IN1/IN2 are swapped for those to keep FORWARD driving the
-        // rover forward. Front Left and Middle Left are the exceptions and are wired the
-        // normal way round -- don't "tidy" them into matching the others.
-        //
-        // Verified against hardware 2026-07-17 by driving every index in both directions
-        // and watching which wheel turned and which way.
-        constexpr int kMotorIn1Pins[MotorController::kMotorCount] = {
-            PIN_M4_IN1, // 0 Front Left    (not reversed)
-            PIN_M1_IN2, // 1 Front Right   (reversed)
-            PIN_M5_IN1, // 2 Middle Left   (not reversed)
-            PIN_M2_IN2, // 3 Middle Right  (reversed)
-            PIN_M6_IN2, // 4 Rear Left     (reversed)
-            PIN_M3_IN2  // 5 Rear Right    (reversed)
-        };
-
-        constexpr int kMotorIn2Pins[MotorController::kMotorCount] = {
-            PIN_M4_IN2, // 0 Front Left
-            PIN_M1_IN1, // 1 Front Right
-            PIN_M5_IN2, // 2 Middle Left
-            PIN_M2_IN1, // 3 Middle Right
-            PIN_M6_IN1, // 4 Rear Left
-            PIN_M3_IN1  // 5 Rear Right
-        };
-    }
-
     MotorController::MotorController(int standbyPin)
         : m_standbyPin(standbyPin),
           m_initialized(false),
           m_driverEnabled(false),
-          m_lastUpdateMs(0)
+          m_lastUpdateMs(0),
+          m_sweepActive(false),
+          m_sweepMotor(0),
+          m_sweepDutyQ8(0),
+          m_powerBudget(nullptr),
+          m_rampCursor(0),
+          m_writtenMask(0)
     {
         for (uint8_t index = 0; index < kMotorCount; ++index)
         {
             auto &motor = m_motors[index];
-            motor.in1Pin = kMotorIn1Pins[index];
-            motor.in2Pin = kMotorIn2Pins[index];
             motor.channelA = index * kChannelsPerMotor;
             motor.channelB = motor.channelA + 1;
             motor.direction = Direction::Forward;
             motor.targetSpeed = 0.0f;
             motor.outputEnabled = false;
-            motor.currentSignedSpeed = 0.0f;
+            motor.speedScale = 1.0f;
+            motor.targetQ15 = 0;
+            motor.currentQ15 = 0;
+            motor.dutyA = 0;
+            motor.dutyB = 0;
+            motor.velocityIntegral = 0.0f;
+            motor.correctionQ15 = 0;
+            motor.rampGranted = false;
+            rebuildDutyTable(index);
         }
     }
 
-    bool MotorController::begin()
+    bool MotorController::begin(const MotorCalibration *calibrations)
     {
         pinMode(m_standbyPin, OUTPUT);
         digitalWrite(m_standbyPin, LOW);
 
+        for (uint8_t index = 0; calibrations != nullptr && index < kMotorCount; ++index)
+        {
+            if (calibrations[index].valid())
+            {
+                m_motors[index].calibration = calibrations[index];
+                rebuildDutyTable(index);
+            }
+        }
+
         for (uint8_t index = 0; index < kMotorCount; ++index)
         {
             auto &motor = m_motors[index];
+            const board::MotorWiring &wiring = board::Active::kMotors[index];
 
-            pinMode(motor.in1Pin, OUTPUT);
-            pinMode(motor.in2Pin, OUTPUT);
-            digitalWrite(motor.in1Pin, LOW);
-            digitalWrite(motor.in2Pin, LOW);
+            pinMode(wiring.channelAPin(), OUTPUT);
+            pinMode(wiring.channelBPin(), OUTPUT);
+            digitalWrite(wiring.channelAPin(), LOW);
+            digitalWrite(wiring.channelBPin(), LOW);
 
             ledcSetup(motor.channelA, kPwmFrequencyHz, kPwmResolutionBits);
             ledcSetup(motor.channelB, kPwmFrequencyHz, kPwmResolutionBits);
 
-            ledcAttachPin(motor.in1Pin, motor.channelA);
-            ledcAttachPin(motor.in2Pin, motor.channelB);
+            ledcAttachPin(wiring.channelAPin(), motor.channelA);
+            ledcAttachPin(wiring.channelBPin(), motor.channelB);
 
             ledcWrite(motor.channelA, 0);
             ledcWrite(motor.channelB, 0);
+            motor.dutyA = 0;
+            motor.dutyB = 0;
         }
 
         m_initialized = true;
@@ -101,32 +95,96 @@ namespace outputs
         m_lastUpdateMs = nowMs;
 
         const uint32_t stepMs = (elapsedMs > kMaxRampStepMs) ? kMaxRampStepMs : elapsedMs;
-        const float maxDelta = kSpeedRampPerSecond * (static_cast<float>(stepMs) / 1000.0f);
+        const int32_t maxDelta = static_cast<int32_t>(stepMs) * kRampStepQ15PerMs;
+
+        if (m_sweepActive)
+        {
+            updateSweep(stepMs);
+        }
 
         bool anyChanged = false;
+        // Stepping the ramp only ever moves the output toward the target, so a wheel
+        // whose magnitude would grow is the only kind that draws extra current.
+        bool accelerating[kMotorCount] = {};
+        uint32_t demandMa = 0;
 
+        // Wheels holding or slowing step freely: slowing sheds current.
         for (uint8_t index = 0; index < kMotorCount; ++index)
         {
             auto &motor = m_motors[index];
-            const float target = effectiveSignedTarget(index);
-            const float diff = target - motor.currentSignedSpeed;
+            if (motor.currentQ15 == motor.targetQ15)
+            {
+                motor.rampGranted = false;
+                demandMa += runningMa(motor.currentQ15);
+                continue;
+            }
 
-            if (diff == 0.0f)
+            const int16_t next = rampStep(motor, maxDelta);
+            if (abs(next) > abs(motor.currentQ15))
             {
+                accelerating[index] = true;
                 continue;
             }
 
-            if (fabsf(diff) <= maxDelta)
+            motor.rampGranted = false;
+            motor.currentQ15 = next;
+            applyOutput(index);
+            anyChanged = true;
+            demandMa += runningMa(motor.currentQ15);
+        }
+
+        // Accelerating wheels share what the servos leave. Wheels already mid-ramp go
+        // first, so ramps run to completion one batch at a time rather than all
+        // crawling together; the rest queue from a rotating start. One wheel always
+        // proceeds, so an over-budget rail slows drive rather than stalling it.
+        uint8_t order[kMotorCount];
+        uint8_t orderCount = 0;
+        for (uint8_t pass = 0; pass < 2; ++pass)
+        {
+            for (uint8_t offset = 0; offset < kMotorCount; ++offset)
             {
-                motor.currentSignedSpeed = target;
+                const uint8_t index = (m_rampCursor + offset) % kMotorCount;
+                if (accelerating[index] && m_motors[index].rampGranted == (pass == 0))
+                {
+                    order[orderCount++] = index;
+                }
             }
-            else
+        }
+
+        const bool budgeted = (m_powerBudget != nullptr) && m_powerBudget->enabled();
+        const uint32_t headroomMa = budgeted ? m_powerBudget->motorHeadroomMa() : UINT32_MAX;
+        bool anyAdmitted = false;
+        bool anyHeld = false;
+        for (uint8_t slot = 0; slot < orderCount; ++slot)
+        {
+            const uint8_t index = order[slot];
+            auto &motor = m_motors[index];
+            const int16_t next = rampStep(motor, maxDelta);
+            const uint32_t costMa = runningMa(next) + kMotorAccelMa;
+            if (anyAdmitted && demandMa + costMa > headroomMa)
             {
-                motor.currentSignedSpeed += (diff > 0.0f) ? maxDelta : -maxDelta;
+                motor.rampGranted = false;
+                demandMa += runningMa(motor.currentQ15);
+                anyHeld = true;
+                continue;
             }
 
+            motor.rampGranted = true;
+            motor.currentQ15 = next;
             applyOutput(index);
             anyChanged = true;
+            anyAdmitted = true;
+            demandMa += costMa;
+        }
+
+        if (anyHeld)
+        {
+            m_rampCursor = static_cast<uint8_t>((m_rampCursor + 1) % kMotorCount);
+            m_powerBudget->countMotorHold();
+        }
+        if (m_powerBudget != nullptr)
+        {
+            m_powerBudget->publishMotorMa(demandMa);
         }
 
         if (anyChanged)
@@ -135,6 +193,25 @@ namespace outputs
         }
     }
 
+    int16_t MotorController::rampStep(const MotorState &motor, int32_t maxDelta)
+    {
+        const int32_t diff = static_cast<int32_t>(motor.targetQ15) - motor.currentQ15;
+        if (diff > maxDelta)
+        {
+            return static_cast<int16_t>(motor.currentQ15 + maxDelta);
+        }
+        if (diff < -maxDelta)
+        {
+            return static_cast<int16_t>(motor.currentQ15 - maxDelta);
+        }
+        return motor.targetQ15;
+    }
+
+    uint32_t MotorController::runningMa(int16_t speedQ15)
+    {
+        return static_cast<uint32_t>(abs(speedQ15)) * kMotorRunMa / kQ15One;
+    }
+
     void MotorController::run(uint8_t motorIndex, Direction direction, float speed, bool autoEnable)
     {
         if (!m_initialized || !validIndex(motorIndex))
@@ -145,6 +222,7 @@ namespace outputs
         auto &motor = m_motors[motorIndex];
         motor.direction = direction;
         motor.targetSpeed = clampSpeed(speed);
+        motor.speedScale = 1.0f;
 
         if (motor.targetSpeed == 0.0f)
         {
@@ -155,6 +233,7 @@ namespace outputs
             motor.outputEnabled = true;
         }
 
+        refreshTarget(motorIndex);
         applyOutput(motorIndex);
         updateStandby();
     }
@@ -173,6 +252,7 @@ namespace outputs
             auto &motor = m_motors[index];
             motor.direction = direction;
             motor.targetSpeed = clamped;
+            motor.speedScale = 1.0f;
             if (motor.targetSpeed == 0.0f)
             {
                 motor.outputEnabled = false;
@@ -181,12 +261,61 @@ namespace outputs
             {
                 motor.outputEnabled = true;
             }
+            refreshTarget(index);
             applyOutput(index);
         }
 
         updateStandby();
     }
 
+    void MotorController::setTargets(const float signedTargets[kMotorCount], uint8_t motorMask)
+    {
+        if (!m_initialized)
+        {
+            return;
+        }
+
+        for (uint8_t index = 0; index < kMotorCount; ++index)
+        {
+            if ((motorMask & (1u << index)) == 0)
+            {
+                continue;
+            }
+            auto &motor = m_motors[index];
+            const float target = signedTargets[index];
+            motor.direction = (target < 0.0f) ? Direction::Backward : Direction::Forward;
+            motor.targetSpeed = clampSpeed(fabsf(target));
+            motor.speedScale = 1.0f;
+            motor.outputEnabled = motor.targetSpeed > 0.0f;
+            refreshTarget(index);
+        }
+
+        // No applyOutput() here: output follows the ramped speed, which update() walks
+        // toward these targets for all six motors in the same pass.
+        updateStandby();
+    }
+
+    void MotorController::setSpeedScales(const float scales[kMotorCount])
+    {
+        for (uint8_t index = 0; index < kMotorCount; ++index)
+        {
+            float scale = scales[index];
+            if (scale < -1.0f)
+            {
+                scale = -1.0f;
+            }
+            else if (scale > 1.0f)
+            {
+                scale = 1.0f;
+            }
+            m_motors[index].speedScale = scale;
+            refreshTarget(index);
+        }
+
+        // The ramp picks the new effective targets up on its next tick.
+        updateStandby();
+    }
+
     void MotorController::start(uint8_t motorIndex)
     {
         if (!m_initialized || !validIndex(motorIndex))
@@ -196,6 +325,7 @@ namespace outputs
 
         auto &motor = m_motors[motorIndex];
         motor.outputEnabled = motor.targetSpeed > 0.0f;
+        refreshTarget(motorIndex);
         applyOutput(motorIndex);
         updateStandby();
     }
@@ -211,6 +341,7 @@ namespace outputs
         {
             auto &motor = m_motors[index];
             motor.outputEnabled = motor.targetSpeed > 0.0f;
+            refreshTarget(index);
             applyOutput(index);
         }
 
@@ -226,10 +357,21 @@ namespace outputs
 
         auto &motor = m_motors[motorIndex];
         motor.outputEnabled = false;
+        refreshTarget(motorIndex);
         applyOutput(motorIndex);
         updateStandby();
     }
 
+    void MotorController::cutDrivers() const
+    {
+        if (m_initialized)
+        {
+            // Flag first: from here on updateStandby() leaves STBY low.
+            m_driversCut.store(true, std::memory_order_release);
+            digitalWrite(m_standbyPin, LOW);
+        }
+    }
+
     void MotorController::stopAll()
     {
         if (!m_initialized)
@@ -239,11 +381,15 @@ namespace outputs
 
         // Hard stop, deliberately un-ramped: this backs the deadman failsafe, E-STOP and
         // peer disconnect. Those must cut output now, not ease out of it. Per-motor
-        // stop() is the one that ramps.
+        // stop() is the one that ramps. A cut landing after this waits for the next.
+        m_driversCut.store(false, std::memory_order_relaxed);
+        m_sweepActive = false;
         for (uint8_t index = 0; index < kMotorCount; ++index)
         {
             m_motors[index].outputEnabled = false;
-            m_motors[index].currentSignedSpeed = 0.0f;
+            m_motors[index].currentQ15 = 0;
+            resetVelocityLoop(m_motors[index]);
+            refreshTarget(index);
             applyOutput(index);
         }
 
@@ -277,9 +423,38 @@ namespace outputs
         return m_motors[motorIndex].outputEnabled;
     }
 
-    bool MotorController::validIndex(uint8_t motorIndex) const
+    int16_t MotorController::currentSpeedQ15(uint8_t motorIndex) const
     {
-        return motorIndex < kMotorCount;
+        if (!validIndex(motorIndex))
+        {
+            return 0;
+        }
+        return m_motors[motorIndex].currentQ15;
+    }
+
+    bool MotorController::settled() const
+    {
+        if (m_sweepActive)
+        {
+            return false;
+        }
+        for (uint8_t index = 0; index < kMotorCount; ++index)
+        {
+            if (m_motors[index].currentQ15 != m_motors[index].targetQ15)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int16_t MotorController::targetSpeedQ15(uint8_t motorIndex) const
+    {
+        if (!validIndex(motorIndex))
+        {
+            return 0;
+        }
+        return m_motors[motorIndex].targetQ15;
     }
 
     float MotorController::clampSpeed(float speed) const
@@ -303,44 +478,289 @@ namespace outputs
         }
 
         // Driven by the ramped speed, not the commanded one -- update() walks
-        // currentSignedSpeed toward the target and calls back in here.
-        const auto &motor = m_motors[motorIndex];
-        const uint32_t maxDuty = (1u << kPwmResolutionBits) - 1u;
-        const float magnitude = fabsf(motor.currentSignedSpeed);
+        // currentQ15 toward the target and calls back in here.
+        auto &motor = m_motors[motorIndex];
+        const int16_t ramped = motor.currentQ15;
+
+        if (ramped == 0)
+        {
+            writeDuty(motor, 0, 0);
+            return;
+        }
+
+        // The closed-loop trim may slow a wheel but never reverses it against its ramp:
+        // a correction bigger than the speed just coasts it.
+        int32_t trimmed = static_cast<int32_t>(ramped) + motor.correctionQ15;
+        if ((ramped > 0) ? (trimmed <= 0) : (trimmed >= 0))
+        {
+            writeDuty(motor, 0, 0);
+            return;
+        }
+        if (trimmed > kQ15One)
+        {
+            trimmed = kQ15One;
+        }
+        else if (trimmed < -kQ15One)
+        {
+            trimmed = -kQ15One;
+        }
+        const int16_t speed = static_cast<int16_t>(trimmed);
 
-        if (magnitude <= 0.0f)
+        const uint16_t magnitude = static_cast<uint16_t>((speed < 0) ? -speed : speed);
+        const uint16_t duty = dutyFor(motor, magnitude);
+
+        if (speed > 0)
+        {
+            writeDuty(motor, duty, 0);
+        }
+        else
+        {
+            writeDuty(motor, 0, duty);
+        }
+    }
+
+    void MotorController::writeDuty(MotorState &motor, uint16_t dutyA, uint16_t dutyB)
+    {
+        // Most ramp ticks move the speed by less than one duty step; only touch the
+        // LEDC when the quantized duty actually changes. The channel heading to zero
+        // goes first so both half-bridge inputs are never driven at once.
+        bool written = false;
+        if (dutyA == 0 && motor.dutyA != 0)
         {
             ledcWrite(motor.channelA, 0);
-            ledcWrite(motor.channelB, 0);
+            motor.dutyA = 0;
+            written = true;
+        }
+        if (dutyB != motor.dutyB)
+        {
+            ledcWrite(motor.channelB, dutyB);
+            motor.dutyB = dutyB;
+            written = true;
+        }
+        if (dutyA != motor.dutyA)
+        {
+            ledcWrite(motor.channelA, dutyA);
+            motor.dutyA = dutyA;
+            written = true;
+        }
+        if (written)
+        {
+            m_writtenMask |= static_cast<uint8_t>(1u << (&motor - m_motors));
+        }
+    }
+
+    uint8_t MotorController::takeWrittenMask()
+    {
+        const uint8_t mask = m_writtenMask;
+        m_writtenMask = 0;
+        return mask;
+    }
+
+    void MotorController::setMeasuredSpeeds(const float radPerSec[kMotorCount], uint8_t fittedMask, uint32_t elapsedUs)
+    {
+        if (!m_initialized || fittedMask == 0 || elapsedUs == 0)
+        {
             return;
         }
 
+        const float dt = static_cast<float>(elapsedUs) * 1.0e-6f;
+        const float integralLimit = kMaxCorrection / kVelocityKi;
+
+        for (uint8_t index = 0; index < kMotorCount; ++index)
+        {
+            if ((fittedMask & (1u << index)) == 0 || (m_sweepActive && m_sweepMotor == index))
+            {
+                continue;
+            }
+
+            auto &motor = m_motors[index];
+            if (motor.currentQ15 == 0)
+            {
+                // At rest nothing is being asked for; don't let the loop hold torque.
+                resetVelocityLoop(motor);
+                continue;
+            }
+
+            // The setpoint follows the ramped speed, so the loop tracks the same slew
+            // the open-loop path would have produced.
+            const float setpoint = static_cast<float>(motor.currentQ15) * (kMaxWheelRadPerSec / kQ15One);
+            const float error = setpoint - radPerSec[index];
+
+            motor.velocityIntegral += error * dt;
+            if (motor.velocityIntegral > integralLimit)
+            {
+                motor.velocityIntegral = integralLimit;
+            }
+            else if (motor.velocityIntegral < -integralLimit)
+            {
+                motor.velocityIntegral = -integralLimit;
+            }
+
+            float correction = kVelocityKp * error + kVelocityKi * motor.velocityIntegral;
+            if (correction > kMaxCorrection)
+            {
+                correction = kMaxCorrection;
+            }
+            else if (correction < -kMaxCorrection)
+            {
+                correction = -kMaxCorrection;
+            }
+            motor.correctionQ15 = static_cast<int16_t>(correction * kQ15One);
+            applyOutput(index);
+        }
+    }
+
+    void MotorController::resetVelocityLoop(MotorState &motor)
+    {
+        motor.velocityIntegral = 0.0f;
+        motor.correctionQ15 = 0;
+    }
+
+    uint16_t MotorController::dutyFor(const MotorState &motor, uint16_t magnitudeQ15) const
+    {
+        // Q15 full scale is 32767, one short of the table's last knot; treat it as the
+        // knot so full speed really is full calibrated duty.
+        if (magnitudeQ15 >= static_cast<uint16_t>(kQ15One))
+        {
+            return motor.dutyTable[kDutyTableSize];
+        }
+
+        const uint16_t index = magnitudeQ15 >> kDutyIndexShift;
+        const int32_t fraction = magnitudeQ15 & kDutyFractionMask;
+        const int32_t low = motor.dutyTable[index];
+        const int32_t high = motor.dutyTable[index + 1];
+        return static_cast<uint16_t>(low + (((high - low) * fraction) >> kDutyIndexShift));
+    }
+
+    void MotorController::rebuildDutyTable(uint8_t motorIndex)
+    {
         // Speed is a fraction of the *usable* output, not of raw duty: 0 is stopped and
-        // anything above it starts at kMinMovingDuty, the point where the wheels break
+        // anything above it starts at the deadband, the point where the wheels break
         // loose. Ramping raw duty from zero just buzzed for most of the ramp.
-        const float scaledDuty = kMinMovingDuty + magnitude * (1.0f - kMinMovingDuty);
-        const uint32_t duty = static_cast<uint32_t>(scaledDuty * static_cast<float>(maxDuty) + 0.5f);
+        auto &motor = m_motors[motorIndex];
+        const MotorCalibration &calibration = motor.calibration;
+        for (size_t index = 0; index <= kDutyTableSize; ++index)
+        {
+            const float speed = static_cast<float>(index) / static_cast<float>(kDutyTableSize);
+            const float shaped = (calibration.curve == 1.0f) ? speed : powf(speed, calibration.curve);
+            const float duty = calibration.deadband + (calibration.gain - calibration.deadband) * shaped;
+            motor.dutyTable[index] = static_cast<uint16_t>(duty * static_cast<float>(kMaxDuty) + 0.5f);
+        }
+    }
 
-        if (motor.currentSignedSpeed > 0.0f)
+    const MotorCalibration &MotorController::calibration(uint8_t motorIndex) const
+    {
+        return m_motors[validIndex(motorIndex) ? motorIndex : 0].calibration;
+    }
+
+    bool MotorController::setCalibration(uint8_t motorIndex, const MotorCalibration &calibration)
+    {
+        if (!validIndex(motorIndex) || !calibration.valid())
         {
-            ledcWrite(motor.channelA, duty);
-            ledcWrite(motor.channelB, 0);
+            return false;
         }
-        else
+
+        m_motors[motorIndex].calibration = calibration;
+        rebuildDutyTable(motorIndex);
+        applyOutput(motorIndex);
+        return true;
+    }
+
+    void MotorController::startBreakawaySweep(uint8_t motorIndex)
+    {
+        if (!m_initialized || !validIndex(motorIndex))
         {
-            ledcWrite(motor.channelA, 0);
-            ledcWrite(motor.channelB, duty);
+            return;
+        }
+
+        // Every other wheel still and this one starting from rest, so the only thing
+        // moving is the wheel being measured.
+        stopAll();
+        m_sweepMotor = motorIndex;
+        m_sweepDutyQ8 = kSweepStartQ8;
+        m_sweepActive = true;
+        writeDuty(m_motors[motorIndex], static_cast<uint16_t>(m_sweepDutyQ8 >> 8), 0);
+        updateStandby();
+    }
+
+    void MotorController::markBreakaway()
+    {
+        if (!m_sweepActive)
+        {
+            return;
         }
+
+        const uint8_t motorIndex = m_sweepMotor;
+        MotorCalibration measured = m_motors[motorIndex].calibration;
+        measured.deadband = static_cast<float>(m_sweepDutyQ8 >> 8) / static_cast<float>(kMaxDuty);
+        // Keep the curve well-formed if the wheel only broke loose near the top.
+        const float maxDeadband = std::fmin(MotorCalibration::kMaxDeadband, measured.gain - MotorCalibration::kMinSpan);
+        if (measured.deadband > maxDeadband)
+        {
+            measured.deadband = maxDeadband;
+        }
+
+        abortBreakawaySweep();
+        setCalibration(motorIndex, measured);
     }
 
-    float MotorController::effectiveSignedTarget(uint8_t motorIndex) const
+    void MotorController::abortBreakawaySweep()
     {
-        const auto &motor = m_motors[motorIndex];
+        if (!m_sweepActive)
+        {
+            return;
+        }
+
+        m_sweepActive = false;
+        auto &motor = m_motors[m_sweepMotor];
+        motor.currentQ15 = 0;
+        writeDuty(motor, 0, 0);
+        updateStandby();
+    }
+
+    float MotorController::sweepDuty() const
+    {
+        return static_cast<float>(m_sweepDutyQ8 >> 8) / static_cast<float>(kMaxDuty);
+    }
+
+    void MotorController::updateSweep(uint32_t stepMs)
+    {
+        m_sweepDutyQ8 += stepMs * kSweepStepQ8PerMs;
+        if (m_sweepDutyQ8 >= kSweepEndQ8)
+        {
+            // Full duty and still no mark: the wheel is jammed or nobody was watching.
+            abortBreakawaySweep();
+            return;
+        }
+        writeDuty(m_motors[m_sweepMotor], static_cast<uint16_t>(m_sweepDutyQ8 >> 8), 0);
+    }
+
+    void MotorController::refreshTarget(uint8_t motorIndex)
+    {
+        auto &motor = m_motors[motorIndex];
         if (!motor.outputEnabled)
         {
-            return 0.0f;
+            motor.targetQ15 = 0;
+            return;
+        }
+
+        // speedScale may be negative (the inner wheel at full lock), so the product is
+        // signed even before direction is applied.
+        float scaled = motor.targetSpeed * motor.speedScale * static_cast<float>(kQ15One);
+        if (motor.direction == Direction::Backward)
+        {
+            scaled = -scaled;
+        }
+        int32_t target = static_cast<int32_t>(scaled + ((scaled >= 0.0f) ? 0.5f : -0.5f));
+        if (target > kQ15One)
+        {
+            target = kQ15One;
         }
-        return (motor.direction == Direction::Forward) ? motor.targetSpeed : -motor.targetSpeed;
+        else if (target < -kQ15One)
+        {
+            target = -kQ15One;
+        }
+        motor.targetQ15 = static_cast<int16_t>(target);
     }
 
     void MotorController::updateStandby()
@@ -350,14 +770,17 @@ namespace outputs
         bool anyActive = false;
         for (uint8_t index = 0; index < kMotorCount; ++index)
         {
-            if (m_motors[index].currentSignedSpeed != 0.0f || effectiveSignedTarget(index) != 0.0f)
+            if (m_motors[index].currentQ15 != 0 || m_motors[index].targetQ15 != 0 ||
+                (m_sweepActive && m_sweepMotor == index))
             {
                 anyActive = true;
                 break;
             }
         }
 
-        if (anyActive)
+        // An explicit cut wins until stopAll() clears it: a command applied on the
+        // same tick must not wake the bridges behind an E-STOP.
+        if (anyActive && !m_driversCut.load(std::memory_order_acquire))
         {
             if (!m_driverEnabled)
             {
@@ -380,9 +803,9 @@ namespace outputs
         for (uint8_t index = 0; index < kMotorCount; ++index)
         {
             auto &motor = m_motors[index];
-            motor.currentSignedSpeed = 0.0f;
-            ledcWrite(motor.channelA, 0);
-            ledcWrite(motor.channelB, 0);
+            motor.currentQ15 = 0;
+            resetVelocityLoop(motor);
+            writeDuty(motor, 0, 0);
         }
 
         digitalWrite(m_standbyPin, LOW);
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <Arduino.h>
+#include <atomic>
 
-#include "pins.h"
+#include "outputs/MotorCalibration.h"
+#include "board.h"
+#include "outputs/PowerBudget.h"
 
 namespace outputs
 {
@@ -10,7 +13,10 @@ namespace outputs
     class MotorController
     {
     public:
-        static constexpr uint8_t kMotorCount = 6;
+        static constexpr uint8_t kMotorCount = board::Active::kWheelCount;
+        static constexpr uint8_t kAllMotorsMask = (1u << kMotorCount) - 1;
+        // Full speed in the signed Q15 the ramp runs in; matches the binary frames.
+        static constexpr int16_t kQ15One = 32767;
 
         enum class Direction : int8_t
         {
@@ -20,74 +26,201 @@ namespace outputs
 
         explicit MotorController(int standbyPin = PIN_DRV_STBY);
 
-        bool begin();
+        // calibrations, if given, holds a duty curve per motor (as loaded by
+        // outputs/ConfigStore.h); any that fails valid(), or all of them when
+        // omitted, stay at the defaults.
+        bool begin(const MotorCalibration *calibrations = nullptr);
 
         // Slews each motor toward its commanded speed. Must be called from the main
         // loop; without it, motors never reach their target.
         void update(uint32_t nowMs);
+        // True once update() has nothing left to do: no breakaway sweep and every ramp
+        // at its target. The motor task sleeps until the next command while this holds.
+        bool settled() const;
+
+        // Once attached, update() publishes the motors' estimated draw and holds
+        // back the start of ramps that would take the pack over budget. Attach before
+        // the motor task starts.
+        void attachPowerBudget(PowerBudget &budget) { m_powerBudget = &budget; }
 
         void run(uint8_t motorIndex, Direction direction, float speed, bool autoEnable = true);
         void runAll(Direction direction, float speed, bool autoEnable = true);
+        // Latches a signed target (-1.0..1.0, sign = direction, 0 = ramp to a stop) for
+        // every motor in motorMask in one go, so both sides of a turn pick up their
+        // targets on the same tick. Motors with a non-zero target are enabled.
+        void setTargets(const float signedTargets[kMotorCount], uint8_t motorMask = kAllMotorsMask);
+        // Per-wheel multiplier on the commanded speed, -1.0..1.0, so coordinated
+        // steering can run the outer wheels faster than the inner. It scales the
+        // speeds already set; run(), runAll() and setTargets() set plain speeds
+        // again, resetting the scale of each motor they touch to 1.0.
+        void setSpeedScales(const float scales[kMotorCount]);
         void start(uint8_t motorIndex);
         void startAll();
         void stop(uint8_t motorIndex);
         void stopAll();
+        // E-STOP's first move, safe from any task: pulls STBY low so every bridge stops
+        // driving at once. It leaves the motor state alone -- const for that reason --
+        // but STBY stays low, whatever the motor task applies meanwhile, until the
+        // stopAll() it runs next makes the two agree.
+        void cutDrivers() const;
 
         Direction direction(uint8_t motorIndex) const;
         float targetSpeed(uint8_t motorIndex) const;
         bool motorEnabled(uint8_t motorIndex) const;
+        // Signed Q15 (+-kQ15One) ramped output and the target it is slewing toward, with
+        // the speed scale applied. Safe to read from another core for reporting.
+        int16_t currentSpeedQ15(uint8_t motorIndex) const;
+        int16_t targetSpeedQ15(uint8_t motorIndex) const;
         bool driverEnabled() const { return m_driverEnabled; }
+        // Mask of motors whose LEDC duty changed since the last call, which it clears;
+        // how the motor task times when a command actually reached the pins. Motor
+        // task only.
+        uint8_t takeWrittenMask();
         bool initialized() const { return m_initialized; }
 
-    private:
-        struct MotorState
-        {
-            int in1Pin;
-            int in2Pin;
-            uint8_t channelA;
-            uint8_t channelB;
-            Direction direction;
-            float targetSpeed;
-            bool outputEnabled;
-            // Signed so a forward<->reverse change ramps down through zero and back up
-            // rather than snapping across. Sign picks the direction, magnitude the duty.
-            float currentSignedSpeed;
-        };
+        // Wheel speed that full scale (kQ15One) asks for once a wheel is closed-loop.
+        // Placeholder until an encoder is wired and the top speed measured on the rail.
+        static constexpr float kMaxWheelRadPerSec = 20.0f;
+
+        // Closed-loop trim, fed by the motor task at a fixed period for the wheels in
+        // fittedMask. Each such wheel's ramped speed becomes a setpoint in rad/s, and a
+        // PI term on the measured speed is added on top of the open-loop duty curve, so
+        // load and rail sag no longer change how fast it turns. Wheels outside the mask
+        // stay purely open-loop.
+        void setMeasuredSpeeds(const float radPerSec[kMotorCount], uint8_t fittedMask, uint32_t elapsedUs);
+
+        const MotorCalibration &calibration(uint8_t motorIndex) const;
+        // Rejects (returns false) a calibration that fails MotorCalibration::valid().
+        bool setCalibration(uint8_t motorIndex, const MotorCalibration &calibration);
+
+        // Breakaway sweep for CALIBRATE. Hard-stops everything, then drives one motor
+        // forward at a raw duty climbing from kSweepStartDuty at kSweepDutyPerSecond,
+        // bypassing its curve. markBreakaway() takes the duty at that moment as the
+        // motor's new deadband and ends the sweep; reaching full duty, stopAll() or
+        // abortBreakawaySweep() end it with the calibration unchanged.
+        void startBreakawaySweep(uint8_t motorIndex);
+        void markBreakaway();
+        void abortBreakawaySweep();
+        bool sweepActive() const { return m_sweepActive; }
+        uint8_t sweepMotor() const { return m_sweepMotor; }
+        float sweepDuty() const;
 
+    private:
         static constexpr uint8_t kChannelsPerMotor = 2;
+        // LEDC counts at 80 MHz, so frequency x 2^bits must stay at or under that. 12
+        // bits at 12 kHz (49 MHz) gives ~820 duty steps above the default deadband,
+        // where 8 bits gave 51. The frequency stays where the deadband was measured.
         static constexpr uint32_t kPwmFrequencyHz = 12000;
-        static constexpr uint8_t kPwmResolutionBits = 8;
+        static constexpr uint8_t kPwmResolutionBits = 12;
+        static constexpr uint32_t kLedcClockHz = 80000000;
+        static_assert((static_cast<uint64_t>(kPwmFrequencyHz) << kPwmResolutionBits) <= kLedcClockHz,
+                      "LEDC cannot reach this frequency at this resolution");
+        static constexpr uint16_t kMaxDuty = (1u << kPwmResolutionBits) - 1u;
 
         // Slew rate, in speed units per second: 3.0 takes ~330ms from rest to full and
         // ~670ms for a full reversal. Tuned to take the edge off without feeling laggy.
         // Easing the current ramp also softens the inrush that sags the rail -- see the
         // brownout notes in HARDWARE.md.
         static constexpr float kSpeedRampPerSecond = 3.0f;
+        static constexpr int32_t kRampStepQ15PerMs =
+            static_cast<int32_t>(kSpeedRampPerSecond * kQ15One / 1000.0f + 0.5f);
+        static_assert(kRampStepQ15PerMs > 0, "Ramp rate rounds to zero in Q15 per ms");
         // Ceiling on the timestep, so a stalled loop resumes by ramping rather than
         // stepping a large jump in one go.
         static constexpr uint32_t kMaxRampStepMs = 50;
 
-        // Duty below which the wheels do not turn at all -- the rover just sits and
-        // buzzes. Measured on hardware 2026-07-16. A non-zero speed maps into
-        // [kMinMovingDuty, 1.0] so the ramp spends its time where the wheels actually
-        // move, instead of crawling through dead duty and then lurching.
-        //
-        // This is calibrated to the *current* 8.4V unbucked motor rail. It is a fraction
-        // of whatever the rail happens to be, so it MUST be re-measured if that rail
-        // changes -- notably if the ~6V motor buck in HARDWARE.md ever lands.
-        static constexpr float kMinMovingDuty = 0.80f;
-
-        bool validIndex(uint8_t motorIndex) const;
+        // Current-draw model for the power budget, in pack mA per motor. Unmeasured
+        // placeholders for the geared motors in HARDWARE.md: running draw scales with
+        // output magnitude up to kMotorRunMa, and a ramp that is speeding a motor up
+        // adds kMotorAccelMa while the back-EMF lags the new duty.
+        static constexpr uint32_t kMotorRunMa = 400;
+        static constexpr uint32_t kMotorAccelMa = 900;
+
+        // Ramp magnitude -> LEDC duty. The top kDutyIndexBits of the Q15 magnitude pick
+        // a table entry and the rest interpolate toward the next, so every duty step
+        // at 12 bits is reachable from a 514-byte table per motor.
+        static constexpr uint8_t kDutyIndexBits = 8;
+        static constexpr size_t kDutyTableSize = size_t{1} << kDutyIndexBits;
+        static constexpr uint8_t kDutyIndexShift = 15 - kDutyIndexBits;
+        static constexpr uint16_t kDutyFractionMask = (1u << kDutyIndexShift) - 1u;
+
+        // Breakaway sweep: 0.3 -> 1.0 of full duty takes 7 s, slow enough that an
+        // operator's reaction time (~0.3 s) costs about 0.03 of deadband. Duty is
+        // carried in Q8 counts so the per-ms step is not rounded away.
+        static constexpr float kSweepStartDuty = 0.30f;
+        static constexpr float kSweepDutyPerSecond = 0.10f;
+        static constexpr uint32_t kSweepStartQ8 = static_cast<uint32_t>(kSweepStartDuty * kMaxDuty * 256.0f);
+        static constexpr uint32_t kSweepStepQ8PerMs =
+            static_cast<uint32_t>(kSweepDutyPerSecond * kMaxDuty * 256.0f / 1000.0f + 0.5f);
+        static constexpr uint32_t kSweepEndQ8 = static_cast<uint32_t>(kMaxDuty) << 8;
+
+        // Velocity PI, in output fraction per rad/s of error (and per rad of its
+        // integral). Untuned placeholders: tune on the stand once encoders are wired.
+        // The correction is capped so a dead or miswired encoder can only push the
+        // output so far from open-loop.
+        static constexpr float kVelocityKp = 0.02f;
+        static constexpr float kVelocityKi = 0.10f;
+        static constexpr float kMaxCorrection = 0.30f;
+
+        struct MotorState
+        {
+            uint8_t channelA;
+            uint8_t channelB;
+            Direction direction;
+            float targetSpeed;
+            bool outputEnabled;
+            float speedScale;
+            // What the ramp slews toward: direction, enable and speed scale already
+            // folded in. Recomputed by refreshTarget() whenever a command changes any
+            // of them, so the tick itself does no float math.
+            int16_t targetQ15;
+            // Signed so a forward<->reverse change ramps down through zero and back up
+            // rather than snapping across. Sign picks the direction, magnitude the duty.
+            int16_t currentQ15;
+            // Last duty written to each LEDC channel, so unchanged writes are skipped.
+            uint16_t dutyA;
+            uint16_t dutyB;
+            MotorCalibration calibration;
+            // The calibrated curve sampled at kDutyTableSize + 1 evenly spaced speeds;
+            // applyOutput() interpolates between neighbours. Rebuilt on calibration
+            // change, never on the tick.
+            uint16_t dutyTable[kDutyTableSize + 1];
+            // Closed-loop state; both stay zero on an open-loop wheel.
+            float velocityIntegral;
+            int16_t correctionQ15;
+            // Admitted to accelerate on the last tick, so it keeps priority until its
+            // ramp stops speeding up.
+            bool rampGranted;
+        };
+
+        // Inline so a check against a constant index folds away.
+        static constexpr bool validIndex(uint8_t motorIndex) { return motorIndex < kMotorCount; }
         float clampSpeed(float speed) const;
-        float effectiveSignedTarget(uint8_t motorIndex) const;
+        void refreshTarget(uint8_t motorIndex);
+        static int16_t rampStep(const MotorState &motor, int32_t maxDelta);
+        static uint32_t runningMa(int16_t speedQ15);
+        void rebuildDutyTable(uint8_t motorIndex);
+        uint16_t dutyFor(const MotorState &motor, uint16_t magnitudeQ15) const;
         void applyOutput(uint8_t motorIndex);
+        void resetVelocityLoop(MotorState &motor);
+        void updateSweep(uint32_t stepMs);
+        void writeDuty(MotorState &motor, uint16_t dutyA, uint16_t dutyB);
         void updateStandby();
         void disableOutputs();
 
         int m_standbyPin;
         bool m_initialized;
         bool m_driverEnabled;
+        // Set by cutDrivers(), cleared by the stopAll() that answers it.
+        mutable std::atomic<bool> m_driversCut{false};
         uint32_t m_lastUpdateMs;
+        bool m_sweepActive;
+        uint8_t m_sweepMotor;
+        uint32_t m_sweepDutyQ8;
+        PowerBudget *m_powerBudget;
+        // Where the next tick starts offering headroom to waiting motors.
+        uint8_t m_rampCursor;
+        uint8_t m_writtenMask;
         MotorState m_motors[kMotorCount];
     };
 
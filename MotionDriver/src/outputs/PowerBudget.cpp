@@ -0,0 +1,60 @@
+#include "PowerBudget.h"
+
+namespace outputs
+{
+
+    PowerBudget::PowerBudget(int senseAdcPin)
+        : m_sensePin(senseAdcPin),
+          m_budgetMa(kDefaultBudgetMa),
+          m_motorMa(0),
+          m_servoMa(0),
+          m_measuredMa(0),
+          m_motorHolds(0),
+          m_servoHolds(0)
+    {
+    }
+
+    void PowerBudget::begin()
+    {
+        if (m_sensePin >= 0)
+        {
+            pinMode(m_sensePin, INPUT);
+        }
+    }
+
+    void PowerBudget::sample()
+    {
+        if (m_sensePin < 0)
+        {
+            return;
+        }
+
+        // Charging current (below zero) is not load; clamp it out.
+        const uint32_t millivolts = analogReadMilliVolts(m_sensePin);
+        const uint32_t aboveZero = (millivolts > kSenseZeroMv) ? millivolts - kSenseZeroMv : 0;
+        m_measuredMa.store(aboveZero * 1000u / kSenseMvPerAmp, std::memory_order_relaxed);
+    }
+
+    uint32_t PowerBudget::motorHeadroomMa() const
+    {
+        return headroomFor(servoMa());
+    }
+
+    uint32_t PowerBudget::servoHeadroomMa() const
+    {
+        return headroomFor(motorMa());
+    }
+
+    uint32_t PowerBudget::headroomFor(uint32_t otherMa) const
+    {
+        const uint32_t budget = budgetMa();
+        const uint32_t estimate = motorMa() + servoMa();
+        const uint32_t measured = measuredMa();
+        // The estimates are rough. When a sensor says the pack is drawing more than
+        // they claim, the excess is charged to both sides.
+        const uint32_t unexplained = (measured > estimate) ? measured - estimate : 0;
+        const uint32_t committed = otherMa + unexplained;
+        return (budget > committed) ? budget - committed : 0;
+    }
+
+} // namespace outputs
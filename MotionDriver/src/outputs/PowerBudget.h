@@ -0,0 +1,75 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+#include "pins.h"
+
+namespace outputs
+{
+
+    // Shared estimate of pack current, so the motor task (core 1) and the servo task
+    // (core 0) can share one headroom instead of both lurching at once. Each task
+    // publishes its own estimated draw every tick and budgets its actuators against
+    // what the other last published: motors stagger ramp starts, servos stagger
+    // slews. Neither side can starve the other, since each always lets at least one
+    // actuator move.
+    //
+    // All figures are milliamps drawn from the pack. The per-actuator estimates live
+    // with the controllers that know their duty and slew state; this only holds the
+    // ledger. One writer per field, read from either core.
+    class PowerBudget
+    {
+    public:
+        // Unmeasured placeholder: set it from the pack's sag under load once that is
+        // logged (see the brownout notes in HARDWARE.md). 0 turns budgeting off.
+        static constexpr uint32_t kDefaultBudgetMa = 6000;
+
+        explicit PowerBudget(int senseAdcPin = PIN_CURRENT_SENSE);
+
+        // Configures the current-sense ADC, if one is wired.
+        void begin();
+        bool senseFitted() const { return m_sensePin >= 0; }
+        // Reads the current-sense ADC; called by the servo task each tick. A no-op
+        // without a sensor.
+        void sample();
+
+        void setBudgetMa(uint32_t budgetMa) { m_budgetMa.store(budgetMa, std::memory_order_relaxed); }
+        uint32_t budgetMa() const { return m_budgetMa.load(std::memory_order_relaxed); }
+        bool enabled() const { return budgetMa() != 0; }
+
+        void publishMotorMa(uint32_t milliamps) { m_motorMa.store(milliamps, std::memory_order_relaxed); }
+        void publishServoMa(uint32_t milliamps) { m_servoMa.store(milliamps, std::memory_order_relaxed); }
+        uint32_t motorMa() const { return m_motorMa.load(std::memory_order_relaxed); }
+        uint32_t servoMa() const { return m_servoMa.load(std::memory_order_relaxed); }
+        uint32_t measuredMa() const { return m_measuredMa.load(std::memory_order_relaxed); }
+
+        // What each side may draw: the budget, less the other side's estimate, less
+        // any measured current neither estimate accounts for. Zero when over budget.
+        uint32_t motorHeadroomMa() const;
+        uint32_t servoHeadroomMa() const;
+
+        // Ticks on which an actuator was held back, for POWER.
+        void countMotorHold() { m_motorHolds.fetch_add(1, std::memory_order_relaxed); }
+        void countServoHold() { m_servoHolds.fetch_add(1, std::memory_order_relaxed); }
+        uint32_t motorHolds() const { return m_motorHolds.load(std::memory_order_relaxed); }
+        uint32_t servoHolds() const { return m_servoHolds.load(std::memory_order_relaxed); }
+
+    private:
+        // Current-sense scaling: an ACS712-5A-style hall sensor, 185 mV/A about a
+        // mid-rail zero after the divider. Placeholders until a sensor is chosen.
+        static constexpr uint32_t kSenseZeroMv = 1650;
+        static constexpr uint32_t kSenseMvPerAmp = 185;
+
+        uint32_t headroomFor(uint32_t otherMa) const;
+
+        int m_sensePin;
+        std::atomic<uint32_t> m_budgetMa;
+        std::atomic<uint32_t> m_motorMa;
+        std::atomic<uint32_t> m_servoMa;
+        std::atomic<uint32_t> m_measuredMa;
+        std::atomic<uint32_t> m_motorHolds;
+        std::atomic<uint32_t> m_servoHolds;
+    };
+
+} // namespace outputs
@@ -2,39 +2,29 @@
 
 #include <algorithm>
 
+#include "build_config.h"
+#include "outputs/SteeringGeometry.h"
+
 namespace outputs
 {
 
     namespace
     {
-        constexpr size_t kMotorPinCount = 12;
-        const int kMotorPins[kMotorPinCount] = {
-            PIN_M1_IN1, PIN_M1_IN2, PIN_M2_IN1, PIN_M2_IN2,
-            PIN_M3_IN1, PIN_M3_IN2, PIN_M4_IN1, PIN_M4_IN2,
-            PIN_M5_IN1, PIN_M5_IN2, PIN_M6_IN1, PIN_M6_IN2};
-
-        // Wheel index -> PCA9685 output channel, as the servo loom is physically wired.
-        // It does not follow wheel order, and unlike the motors there is no tidy pattern:
-        // the left side sits on channels 0-2 running rear->front, and the right side does
-        // not mirror it. Treat this as a lookup, not a formula.
-        // Verified against hardware 2026-07-16 by driving each index and watching which
-        // wheel steered.
-        constexpr uint8_t kWheelToPcaChannel[ServoController::kServoCount] = {
-            2, // 0 Front Left
-            4, // 1 Front Right
-            1, // 2 Middle Left
-            3, // 3 Middle Right
-            0, // 4 Rear Left
-            5  // 5 Rear Right
-        };
+        static_assert(ServoController::kServoCount <= 16, "PCA9685 has 16 channels");
     }
 
     ServoController::ServoController()
         : m_driver(kPCA9685Address),
+          m_wire(nullptr),
+          m_pcaTicks{0},
+          m_dirtyChannels(0),
+          m_trimUs{},
+          m_lastUpdateMs(0),
           m_initialized(false),
           m_outputsEnabled(false),
-          m_logTelemetry(true),
-          m_defaultSweepChannel(0)
+          m_defaultSweepChannel(0),
+          m_powerBudget(nullptr),
+          m_slewCursor(0)
     {
         for (uint8_t channel = 0; channel < kServoCount; ++channel)
         {
@@ -48,36 +38,44 @@ namespace outputs
             state.lastUpdateMs = 0;
             state.currentPulseUs = (kDefaultMinPulseUs + kDefaultMaxPulseUs) / 2;
             state.direction = 1;
-            state.logDecimator = 0;
+
+            auto &slew = m_slew[channel];
+            slew.targetUs = static_cast<uint16_t>(state.currentPulseUs);
+            slew.rateUsPerSecond = kDefaultSlewUsPerSecond;
+            slew.remainder = 0;
+            slew.granted = false;
         }
     }
 
-    bool ServoController::begin(TwoWire &wire)
+    bool ServoController::ChannelConfig::valid() const
+    {
+        return minPulseUs >= kMinLimitUs && minPulseUs < maxPulseUs && maxPulseUs <= kMaxLimitUs &&
+               trimUs >= -kMaxTrimUs && trimUs <= kMaxTrimUs;
+    }
+
+    bool ServoController::begin(TwoWire &wire, const ChannelConfig *channels)
     {
         initializeMotorOutputs();
 
         pinMode(PIN_PCA9685_OE, OUTPUT);
         setOutputsEnabled(false);
 
-        wire.begin(PIN_I2C_SDA, PIN_I2C_SCL);
-        m_driver.begin();
-
-        wire.beginTransmission(kPCA9685Address);
-        const uint8_t i2cError = wire.endTransmission();
+        m_wire = &wire;
+        const uint8_t i2cError = startBus(wire);
         if (i2cError != 0)
         {
-            Serial.printf("PCA9685 init failed (I2C error %u).\n", i2cError);
+            if (build::kDebugLog)
+            {
+                Serial.printf("PCA9685 init failed (I2C error %u).\n", i2cError);
+            }
             return false;
         }
 
-        m_driver.setOscillatorFrequency(kOscillatorFrequencyHz);
-        m_driver.setPWMFreq(kDefaultFrequencyHz);
-        delay(10);
-
         m_initialized = true;
         m_defaultSweepChannel = 0;
 
         const uint32_t nowMs = millis();
+        m_lastUpdateMs = nowMs;
 
         for (uint8_t channel = 0; channel < kServoCount; ++channel)
         {
@@ -85,15 +83,80 @@ namespace outputs
             state.enabled = false;
             state.channel = channel;
             state.lastUpdateMs = nowMs;
+            if (channels != nullptr && channels[channel].valid())
+            {
+                state.minPulseUs = channels[channel].minPulseUs;
+                state.maxPulseUs = channels[channel].maxPulseUs;
+                m_trimUs[channel] = channels[channel].trimUs;
+                m_slew[channel].rateUsPerSecond = channels[channel].slewUsPerSecond;
+            }
             const uint16_t clamped = clampPulse(channel, state.currentPulseUs);
+            m_slew[channel].targetUs = clamped;
             writeMicroseconds(channel, clamped);
         }
+        flush();
 
         setOutputsEnabled(true);
 
         return true;
     }
 
+    uint8_t ServoController::startBus(TwoWire &wire)
+    {
+        wire.begin(PIN_I2C_SDA, PIN_I2C_SCL);
+        m_driver.begin();
+        wire.setClock(kI2cClockHz);
+        wire.setTimeOut(kI2cTimeoutMs);
+
+        wire.beginTransmission(kPCA9685Address);
+        const uint8_t i2cError = wire.endTransmission();
+        if (i2cError != 0)
+        {
+            return i2cError;
+        }
+
+        m_driver.setOscillatorFrequency(kOscillatorFrequencyHz);
+        // setPWMFreq() already waits out the oscillator restart.
+        m_driver.setPWMFreq(kDefaultFrequencyHz);
+        return 0;
+    }
+
+    bool ServoController::recoverBus()
+    {
+        if (m_wire == nullptr)
+        {
+            return false;
+        }
+
+        m_wire->end();
+        pinMode(PIN_I2C_SDA, INPUT_PULLUP);
+        pinMode(PIN_I2C_SCL, OUTPUT_OPEN_DRAIN);
+        digitalWrite(PIN_I2C_SCL, HIGH);
+        for (uint8_t clock = 0; clock < kBusRecoveryClocks && digitalRead(PIN_I2C_SDA) == LOW; ++clock)
+        {
+            digitalWrite(PIN_I2C_SCL, LOW);
+            delayMicroseconds(kBusRecoveryHalfPeriodUs);
+            digitalWrite(PIN_I2C_SCL, HIGH);
+            delayMicroseconds(kBusRecoveryHalfPeriodUs);
+        }
+        // STOP: SDA rising while SCL is high.
+        pinMode(PIN_I2C_SDA, OUTPUT_OPEN_DRAIN);
+        digitalWrite(PIN_I2C_SDA, LOW);
+        delayMicroseconds(kBusRecoveryHalfPeriodUs);
+        digitalWrite(PIN_I2C_SDA, HIGH);
+        delayMicroseconds(kBusRecoveryHalfPeriodUs);
+
+        if (startBus(*m_wire) != 0)
+        {
+            return false;
+        }
+        for (uint8_t channel = 0; channel < kServoCount; ++channel)
+        {
+            m_dirtyChannels |= static_cast<uint16_t>(1u << board::Active::kServoChannels[channel]);
+        }
+        return true;
+    }
+
     void ServoController::update(uint32_t nowMs)
     {
         if (!m_initialized)
@@ -101,14 +164,39 @@ namespace outputs
             return;
         }
 
+        uint32_t elapsedMs = nowMs - m_lastUpdateMs;
+        m_lastUpdateMs = nowMs;
+        if (elapsedMs > kMaxSlewStepMs)
+        {
+            elapsedMs = kMaxSlewStepMs;
+        }
+
+        if (m_powerBudget != nullptr)
+        {
+            m_powerBudget->sample();
+        }
+
+        uint32_t demandMa = 0;
+        bool slewing[kServoCount] = {};
         for (uint8_t channel = 0; channel < kServoCount; ++channel)
         {
             auto &state = m_sweepStates[channel];
             if (!state.enabled)
             {
+                // Unlimited channels snap in one write and skip the budget.
+                const auto &slew = m_slew[channel];
+                slewing[channel] = slew.rateUsPerSecond != 0 && slew.targetUs != state.currentPulseUs;
+                if (!slewing[channel])
+                {
+                    m_slew[channel].granted = false;
+                    demandMa += kServoHoldMa;
+                    updateSlew(channel, elapsedMs);
+                }
                 continue;
             }
 
+            // A calibration sweep always runs; it is charged as moving.
+            demandMa += kServoMovingMa;
             if ((nowMs - state.lastUpdateMs) < state.intervalMs)
             {
                 continue;
@@ -125,16 +213,59 @@ namespace outputs
 
             const uint16_t clamped = clampPulse(channel, state.currentPulseUs);
             writeMicroseconds(channel, clamped);
+        }
+
+        updateBudgetedSlews(slewing, elapsedMs, demandMa);
+    }
 
-            if (m_logTelemetry)
+    void ServoController::updateBudgetedSlews(const bool slewing[kServoCount], uint32_t elapsedMs, uint32_t demandMa)
+    {
+        // Same admission as the motor ramp: servos already moving finish first, the
+        // rest wait their turn from a rotating start, and one always moves.
+        uint8_t order[kServoCount];
+        uint8_t orderCount = 0;
+        for (uint8_t pass = 0; pass < 2; ++pass)
+        {
+            for (uint8_t offset = 0; offset < kServoCount; ++offset)
             {
-                if (++state.logDecimator >= 5)
+                const uint8_t channel = (m_slewCursor + offset) % kServoCount;
+                if (slewing[channel] && m_slew[channel].granted == (pass == 0))
                 {
-                    state.logDecimator = 0;
-                    Serial.printf("Servo %u pulse: %ld us\n", channel, static_cast<long>(state.currentPulseUs));
+                    order[orderCount++] = channel;
                 }
             }
         }
+
+        const bool budgeted = (m_powerBudget != nullptr) && m_powerBudget->enabled();
+        const uint32_t headroomMa = budgeted ? m_powerBudget->servoHeadroomMa() : UINT32_MAX;
+        bool anyAdmitted = false;
+        bool anyHeld = false;
+        for (uint8_t slot = 0; slot < orderCount; ++slot)
+        {
+            const uint8_t channel = order[slot];
+            if (anyAdmitted && demandMa + kServoMovingMa > headroomMa)
+            {
+                m_slew[channel].granted = false;
+                demandMa += kServoHoldMa;
+                anyHeld = true;
+                continue;
+            }
+
+            m_slew[channel].granted = true;
+            anyAdmitted = true;
+            demandMa += kServoMovingMa;
+            updateSlew(channel, elapsedMs);
+        }
+
+        if (anyHeld)
+        {
+            m_slewCursor = static_cast<uint8_t>((m_slewCursor + 1) % kServoCount);
+            m_powerBudget->countServoHold();
+        }
+        if (m_powerBudget != nullptr)
+        {
+            m_powerBudget->publishServoMa(demandMa);
+        }
     }
 
     void ServoController::setTargetMicroseconds(uint8_t channel, uint16_t pulseUs)
@@ -149,8 +280,117 @@ namespace outputs
         state.direction = 1;
         state.lastUpdateMs = 0;
 
-        const uint16_t clamped = clampPulse(channel, static_cast<int32_t>(pulseUs));
-        writeMicroseconds(channel, clamped);
+        auto &slew = m_slew[channel];
+        slew.targetUs = clampPulse(channel, static_cast<int32_t>(pulseUs));
+        if (slew.rateUsPerSecond == 0)
+        {
+            writeMicroseconds(channel, slew.targetUs);
+        }
+    }
+
+    void ServoController::setSlewRate(uint8_t channel, uint16_t usPerSecond)
+    {
+        if (channel >= kServoCount)
+        {
+            return;
+        }
+        m_slew[channel].rateUsPerSecond = usPerSecond;
+        m_slew[channel].remainder = 0;
+    }
+
+    uint16_t ServoController::slewRate(uint8_t channel) const
+    {
+        return (channel < kServoCount) ? m_slew[channel].rateUsPerSecond : 0;
+    }
+
+    void ServoController::setPulseLimits(uint8_t channel, uint16_t minPulseUs, uint16_t maxPulseUs)
+    {
+        if (channel >= kServoCount || minPulseUs < kMinLimitUs || minPulseUs >= maxPulseUs || maxPulseUs > kMaxLimitUs)
+        {
+            return;
+        }
+
+        auto &state = m_sweepStates[channel];
+        state.minPulseUs = minPulseUs;
+        state.maxPulseUs = maxPulseUs;
+
+        // Pull both the target and where the servo is now inside the new range.
+        auto &slew = m_slew[channel];
+        slew.targetUs = clampPulse(channel, slew.targetUs);
+        if (m_initialized)
+        {
+            writeMicroseconds(channel, clampPulse(channel, state.currentPulseUs));
+        }
+    }
+
+    void ServoController::setTrim(uint8_t channel, int16_t trimUs)
+    {
+        if (channel >= kServoCount)
+        {
+            return;
+        }
+
+        m_trimUs[channel] = std::max<int16_t>(-kMaxTrimUs, std::min<int16_t>(trimUs, kMaxTrimUs));
+        // The commanded pulse is unchanged, so restage it to move the horn now.
+        if (m_initialized)
+        {
+            writeMicroseconds(channel, static_cast<uint16_t>(m_sweepStates[channel].currentPulseUs));
+        }
+    }
+
+    ServoController::ChannelConfig ServoController::channelConfig(uint8_t channel) const
+    {
+        ChannelConfig config;
+        if (channel < kServoCount)
+        {
+            config.minPulseUs = m_sweepStates[channel].minPulseUs;
+            config.maxPulseUs = m_sweepStates[channel].maxPulseUs;
+            config.trimUs = m_trimUs[channel];
+            config.slewUsPerSecond = m_slew[channel].rateUsPerSecond;
+        }
+        return config;
+    }
+
+    void ServoController::updateSlew(uint8_t channel, uint32_t elapsedMs)
+    {
+        auto &slew = m_slew[channel];
+        const int32_t current = m_sweepStates[channel].currentPulseUs;
+        const int32_t error = static_cast<int32_t>(slew.targetUs) - current;
+        if (error == 0)
+        {
+            slew.remainder = 0;
+            return;
+        }
+        if (slew.rateUsPerSecond == 0)
+        {
+            writeMicroseconds(channel, slew.targetUs);
+            return;
+        }
+
+        slew.remainder += static_cast<uint32_t>(slew.rateUsPerSecond) * elapsedMs;
+        const int32_t step = static_cast<int32_t>(slew.remainder / 1000u);
+        if (step == 0)
+        {
+            return;
+        }
+        slew.remainder %= 1000u;
+
+        if (step >= (error < 0 ? -error : error))
+        {
+            slew.remainder = 0;
+            writeMicroseconds(channel, slew.targetUs);
+            return;
+        }
+        writeMicroseconds(channel, static_cast<uint16_t>(current + (error < 0 ? -step : step)));
+    }
+
+    void ServoController::setSteeringRadius(float radiusM)
+    {
+        const steering::Entry entry = steering::lookup(radiusM);
+        for (uint8_t channel = 0; channel < kServoCount; ++channel)
+        {
+            setTargetMicroseconds(channel, entry.pulseUs[channel]);
+        }
     }
 
     void ServoController::enableSweep(bool enabled)
@@ -174,6 +414,11 @@ namespace outputs
             const uint16_t clamped = clampPulse(channel, state.currentPulseUs);
             writeMicroseconds(channel, clamped);
         }
+        else
+        {
+            // Hold wherever the sweep left it rather than slew back to the old target.
+            m_slew[channel].targetUs = static_cast<uint16_t>(state.currentPulseUs);
+        }
     }
 
     void ServoController::setSweepEnabledRange(uint8_t startChannel, uint8_t endChannel, bool enabled)
@@ -206,6 +451,29 @@ namespace outputs
         setSweepEnabledRange(0, kServoCount - 1, enabled);
     }
 
+    void ServoController::stopSweeps()
+    {
+        for (uint8_t channel = 0; channel < kServoCount; ++channel)
+        {
+            if (m_sweepStates[channel].enabled)
+            {
+                setSweepEnabled(channel, false);
+            }
+        }
+    }
+
+    bool ServoController::sweeping() const
+    {
+        for (const auto &state : m_sweepStates)
+        {
+            if (state.enabled)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
     void ServoController::configureSweepChannel(uint8_t channel)
     {
         if (channel >= kServoCount)
@@ -250,9 +518,44 @@ namespace outputs
         state.intervalMs = intervalMs;
     }
 
-    void ServoController::enableTelemetry(bool enabled)
+    uint16_t ServoController::currentPulseUs(uint8_t channel) const
+    {
+        if (channel >= kServoCount)
+        {
+            return 0;
+        }
+        return static_cast<uint16_t>(m_sweepStates[channel].currentPulseUs);
+    }
+
+    bool ServoController::settled() const
+    {
+        if (!m_initialized)
+        {
+            return true;
+        }
+        if (flushPending())
+        {
+            return false;
+        }
+        for (uint8_t channel = 0; channel < kServoCount; ++channel)
+        {
+            const auto &state = m_sweepStates[channel];
+            if (state.enabled || state.currentPulseUs != m_slew[channel].targetUs)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint16_t ServoController::targetPulseUs(uint8_t channel) const
     {
-        m_logTelemetry = enabled;
+        if (channel >= kServoCount)
+        {
+            return 0;
+        }
+        return m_sweepStates[channel].enabled ? static_cast<uint16_t>(m_sweepStates[channel].currentPulseUs)
+                                              : m_slew[channel].targetUs;
     }
 
     void ServoController::setOutputsEnabled(bool enabled)
@@ -266,10 +569,12 @@ namespace outputs
         pinMode(PIN_DRV_STBY, OUTPUT);
         digitalWrite(PIN_DRV_STBY, LOW);
 
-        for (size_t index = 0; index < kMotorPinCount; ++index)
+        for (const board::MotorWiring &wiring : board::Active::kMotors)
         {
-            pinMode(kMotorPins[index], OUTPUT);
-            digitalWrite(kMotorPins[index], LOW);
+            pinMode(wiring.in1Pin, OUTPUT);
+            digitalWrite(wiring.in1Pin, LOW);
+            pinMode(wiring.in2Pin, OUTPUT);
+            digitalWrite(wiring.in2Pin, LOW);
         }
     }
 
@@ -280,12 +585,56 @@ namespace outputs
             return;
         }
 
+        // Staged only: flush() sends it, batched with everything else this tick. A
+        // count is ~4.9us, so a slow slew moves the pulse several times per count
+        // change; only an actual change costs bus time.
         const uint16_t clamped = clampPulse(channel, static_cast<int32_t>(pulseUs));
-        const uint16_t ticks = pulseToTicks(clamped);
-        m_driver.setPWM(kWheelToPcaChannel[channel], 0, ticks);
+        const uint8_t pcaChannel = board::Active::kServoChannels[channel];
+        const uint16_t ticks = pulseToTicks(clampPulse(channel, static_cast<int32_t>(clamped) + m_trimUs[channel]));
+        if (ticks != m_pcaTicks[pcaChannel])
+        {
+            m_pcaTicks[pcaChannel] = ticks;
+            m_dirtyChannels |= static_cast<uint16_t>(1u << pcaChannel);
+        }
         m_sweepStates[channel].currentPulseUs = clamped;
     }
 
+    bool ServoController::flush()
+    {
+        if (m_dirtyChannels == 0 || m_wire == nullptr)
+        {
+            return true;
+        }
+
+        // One auto-increment write from the lowest to the highest dirty channel. Clean
+        // channels in between are rewritten from the shadow, which costs 4 bytes each
+        // but saves a whole transaction. The Adafruit driver leaves MODE1.AI set (its
+        // own setPWM relies on it).
+        const uint8_t first = static_cast<uint8_t>(__builtin_ctz(m_dirtyChannels));
+        const uint8_t last = static_cast<uint8_t>(31 - __builtin_clz(m_dirtyChannels));
+
+        m_wire->beginTransmission(kPCA9685Address);
+        m_wire->write(static_cast<uint8_t>(kPcaRegLed0OnL + kPcaRegsPerChannel * first));
+        for (uint8_t pcaChannel = first; pcaChannel <= last; ++pcaChannel)
+        {
+            const uint16_t ticks = m_pcaTicks[pcaChannel];
+            const uint8_t registers[kPcaRegsPerChannel] = {
+                0, 0, // ON at count 0
+                static_cast<uint8_t>(ticks & 0xFF),
+                static_cast<uint8_t>(ticks >> 8)};
+            m_wire->write(registers, sizeof(registers));
+        }
+
+        if (m_wire->endTransmission() != 0)
+        {
+            // Leave the channels dirty so the next tick retries them.
+            return false;
+        }
+
+        m_dirtyChannels = 0;
+        return true;
+    }
+
     uint16_t ServoController::clampPulse(uint8_t channel, int32_t pulseUs) const
     {
         const uint16_t minUs = (channel < kServoCount) ? m_sweepStates[channel].minPulseUs : kDefaultMinPulseUs;
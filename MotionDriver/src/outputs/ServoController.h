@@ -4,7 +4,8 @@
 #include <Arduino.h>
 #include <array>
 
-#include "pins.h"
+#include "board.h"
+#include "outputs/PowerBudget.h"
 
 namespace outputs
 {
@@ -12,9 +13,33 @@ namespace outputs
     class ServoController
     {
     public:
-        static constexpr uint8_t kServoCount = 6;
+        static constexpr uint8_t kServoCount = board::Active::kWheelCount;
         static constexpr uint16_t kDefaultMinPulseUs = 1000;
         static constexpr uint16_t kDefaultMaxPulseUs = 2000;
+        // Default steering slew: a full 1000us swing in 0.5 s, half lock in ~130 ms.
+        // Six servos starting at once otherwise stall-draw together off the 6 V
+        // rail -- the same inrush the motor ramp eases (see the brownout notes in
+        // HARDWARE.md). 0 means unlimited: a new target is written straight through.
+        static constexpr uint16_t kDefaultSlewUsPerSecond = 2000;
+        // Widest LIMIT accepted: past this, hobby servos hit their end stops.
+        static constexpr uint16_t kMinLimitUs = 500;
+        static constexpr uint16_t kMaxLimitUs = 2500;
+        static constexpr int16_t kMaxTrimUs = 200;
+
+        // A channel's persisted tuning (outputs/ConfigStore.h).
+        struct ChannelConfig
+        {
+            // Every pulse is clamped to these, after trim: they keep a servo off the
+            // linkage's mechanical stops.
+            uint16_t minPulseUs = kDefaultMinPulseUs;
+            uint16_t maxPulseUs = kDefaultMaxPulseUs;
+            // Added to every commanded pulse, to centre a horn that sits a spline
+            // off true. Commands and readbacks stay untrimmed.
+            int16_t trimUs = 0;
+            uint16_t slewUsPerSecond = kDefaultSlewUsPerSecond;
+
+            bool valid() const;
+        };
 
         struct SweepConfig
         {
@@ -27,25 +52,65 @@ namespace outputs
             uint32_t lastUpdateMs = 0;
             int32_t currentPulseUs = (kDefaultMinPulseUs + kDefaultMaxPulseUs) / 2;
             int8_t direction = 1;
-            uint8_t logDecimator = 0;
         };
 
         ServoController();
 
-        bool begin(TwoWire &wire);
+        // channels, if given, is applied before the first pulse goes out, so a
+        // stored trim is already in place when the servos first move.
+        bool begin(TwoWire &wire, const ChannelConfig *channels = nullptr);
+        // Advances sweeps and slews each channel toward its target. Like every other
+        // setter it only stages pulses -- and only those whose PCA count changed --
+        // so nothing reaches the PCA9685 until flush().
         void update(uint32_t nowMs);
+        // Writes every channel staged since the last flush in a single I2C burst. On a
+        // bus error the channels stay staged for the next call and this returns false.
+        bool flush();
+        bool flushPending() const { return m_dirtyChannels != 0; }
+        // Frees a bus a slave is holding low mid-byte: clocks SCL until SDA is released,
+        // sends a STOP, then restarts the controller and reprograms the PCA9685 as
+        // begin() did (it may have browned out too). Every channel is restaged, so the
+        // next flush() rewrites them all. Blocks for ~10 ms; false if the PCA9685
+        // still does not answer.
+        bool recoverBus();
+        // True while update() and flush() would do nothing: no sweep running, every
+        // slew at its target and nothing staged. The servo task idles on this.
+        bool settled() const;
+
+        // Once attached, update() publishes the servos' estimated draw and holds
+        // slews that would take the pack over budget. Attach before the servo task
+        // starts.
+        void attachPowerBudget(PowerBudget &budget) { m_powerBudget = &budget; }
 
+        // Sets where the channel slews to; update() moves it there at its slew rate.
         void setTargetMicroseconds(uint8_t channel, uint16_t pulseUs);
+        // Per-channel slew limit in us per second; 0 disables it for that channel.
+        void setSlewRate(uint8_t channel, uint16_t usPerSecond);
+        uint16_t slewRate(uint8_t channel) const;
+        // Ignored unless kMinLimitUs <= minPulseUs < maxPulseUs <= kMaxLimitUs.
+        void setPulseLimits(uint8_t channel, uint16_t minPulseUs, uint16_t maxPulseUs);
+        // Clamped to +/-kMaxTrimUs.
+        void setTrim(uint8_t channel, int16_t trimUs);
+        ChannelConfig channelConfig(uint8_t channel) const;
+        // Coordinated Ackermann steer for all six wheels from one turn radius; see
+        // outputs/SteeringGeometry.h. > 0 turns right, < 0 left, 0 is straight.
+        void setSteeringRadius(float radiusM);
         void enableSweep(bool enabled);
         void setSweepEnabled(uint8_t channel, bool enabled);
         void setSweepEnabledRange(uint8_t startChannel, uint8_t endChannel, bool enabled);
         void setSweepEnabledAll(bool enabled);
+        // Stops every running sweep where it stands; channels not sweeping keep slewing.
+        void stopSweeps();
+        bool sweeping() const;
         void configureSweepChannel(uint8_t channel);
         void configureSweepRange(uint16_t minPulseUs, uint16_t maxPulseUs);
         void configureSweepStep(uint16_t stepUs, uint32_t intervalMs);
-        void enableTelemetry(bool enabled);
         void setOutputsEnabled(bool enabled);
         bool outputsEnabled() const { return m_outputsEnabled; }
+        // Last pulse staged for a wheel, which may not have been flushed yet, and the
+        // target it is slewing toward.
+        uint16_t currentPulseUs(uint8_t channel) const;
+        uint16_t targetPulseUs(uint8_t channel) const;
 
     private:
         static constexpr uint8_t kPCA9685Address = 0x40;
@@ -53,18 +118,62 @@ namespace outputs
         static constexpr uint16_t kServoPeriodUs = 20000;
         static constexpr uint32_t kOscillatorFrequencyHz = 27000000UL;
         static constexpr uint16_t kDefaultFrequencyHz = 50;
+        // Fast-mode Plus. The PCA9685 is rated for it; if the bus turns flaky, suspect
+        // weak pull-ups before the clock and drop back to 400 kHz.
+        static constexpr uint32_t kI2cClockHz = 1000000;
+        // A whole six-channel burst takes ~0.3 ms at kI2cClockHz. Past this a
+        // transaction has hung, and fails rather than holding the servo task.
+        static constexpr uint16_t kI2cTimeoutMs = 5;
+        // Nine clocks finish any byte a slave is part-way through sending.
+        static constexpr uint8_t kBusRecoveryClocks = 9;
+        static constexpr uint32_t kBusRecoveryHalfPeriodUs = 5;
+        static constexpr uint8_t kPcaChannelCount = 16;
+        static constexpr uint8_t kPcaRegLed0OnL = 0x06;
+        static constexpr uint8_t kPcaRegsPerChannel = 4;
+        // Ceiling on the slew timestep, so a stalled task resumes by slewing rather
+        // than jumping.
+        static constexpr uint32_t kMaxSlewStepMs = 50;
+        // Current-draw model for the power budget, in pack mA per servo. Unmeasured
+        // placeholders: a held servo idles, a slewing one draws near stall.
+        static constexpr uint32_t kServoHoldMa = 80;
+        static constexpr uint32_t kServoMovingMa = 600;
+
+        struct SlewState
+        {
+            uint16_t targetUs;
+            uint16_t rateUsPerSecond;
+            // Sub-microsecond progress carried between ticks, in us x ms.
+            uint32_t remainder;
+            // Admitted to move on the last tick; keeps priority until it arrives.
+            bool granted;
+        };
 
         void initializeMotorOutputs();
+        // Starts the bus and programs the PCA9685; returns the probe's I2C error, 0 if
+        // it answered.
+        uint8_t startBus(TwoWire &wire);
         void writeMicroseconds(uint8_t channel, uint16_t pulseUs);
+        void updateSlew(uint8_t channel, uint32_t elapsedMs);
+        void updateBudgetedSlews(const bool slewing[kServoCount], uint32_t elapsedMs, uint32_t demandMa);
         uint16_t clampPulse(uint8_t channel, int32_t pulseUs) const;
         static uint16_t pulseToTicks(uint16_t pulseUs);
 
         Adafruit_PWMServoDriver m_driver;
+        TwoWire *m_wire;
+        // Shadow of each PCA9685 channel's OFF count, indexed by *PCA channel*, and the
+        // channels changed since the last flush.
+        uint16_t m_pcaTicks[kPcaChannelCount];
+        uint16_t m_dirtyChannels;
         std::array<SweepConfig, kServoCount> m_sweepStates;
+        std::array<SlewState, kServoCount> m_slew;
+        std::array<int16_t, kServoCount> m_trimUs;
+        uint32_t m_lastUpdateMs;
         bool m_initialized;
         bool m_outputsEnabled;
-        bool m_logTelemetry;
         uint8_t m_defaultSweepChannel;
+        PowerBudget *m_powerBudget;
+        // Where the next tick starts offering headroom to waiting servos.
+        uint8_t m_slewCursor;
     };
 
 } // namespace outputs
@@ -0,0 +1,50 @@
+#include "SteeringGeometry.h"
+
+namespace outputs
+{
+    namespace steering
+    {
+        namespace
+        {
+            constexpr std::array<Entry, kTableSize> kTable = buildTable();
+
+            static_assert(kTable[kTableSize / 2].pulseUs[0] == static_cast<uint16_t>(kPulseCentreUs),
+                          "Centre entry must be straight ahead");
+        }
+
+        Entry lookup(float radiusM)
+        {
+            if (radiusM == 0.0f)
+            {
+                return kTable[kTableSize / 2];
+            }
+
+            const float curvature = 1.0f / radiusM;
+            float position = (curvature / static_cast<float>(kMaxCurvaturePerM) + 1.0f) * 0.5f * static_cast<float>(kTableSize - 1);
+            if (position < 0.0f)
+            {
+                position = 0.0f;
+            }
+            if (position > static_cast<float>(kTableSize - 1))
+            {
+                position = static_cast<float>(kTableSize - 1);
+            }
+
+            const size_t lower = static_cast<size_t>(position);
+            const size_t upper = (lower + 1 < kTableSize) ? lower + 1 : lower;
+            const float blend = position - static_cast<float>(lower);
+
+            const Entry &a = kTable[lower];
+            const Entry &b = kTable[upper];
+            Entry result{};
+            for (uint8_t wheel = 0; wheel < ServoController::kServoCount; ++wheel)
+            {
+                const float pulse = a.pulseUs[wheel] + blend * (static_cast<float>(b.pulseUs[wheel]) - a.pulseUs[wheel]);
+                result.pulseUs[wheel] = static_cast<uint16_t>(pulse + 0.5f);
+                result.speedRatio[wheel] = a.speedRatio[wheel] + blend * (b.speedRatio[wheel] - a.speedRatio[wheel]);
+            }
+            return result;
+        }
+    } // namespace steering
+
+} // namespace outputs
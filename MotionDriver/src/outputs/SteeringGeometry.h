@@ -0,0 +1,192 @@
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+
+#include "board.h"
+#include "outputs/MotorController.h"
+#include "outputs/ServoController.h"
+
+namespace outputs
+{
+    // Firmware-side Ackermann solver for STEER. On Cheddar it mirrors the Pi's model
+    // in ChedWeb/frontend/src/utils/inputManager.ts: all four corner wheels steer
+    // about one turn centre on the middle axle's line (front into the corner, rear
+    // counter-steering), middle wheels stay straight, and the outer wheel of each
+    // axle is eased off by kDifferential. Positive curvature turns right. The wheel
+    // layout and dimensions come from board::Active, so other chassis solve the same
+    // way about their own centre line.
+    //
+    // The whole solve is done at compile time into kTable, indexed by curvature, so a
+    // STEER costs a lookup and a lerp rather than an atan() per wheel.
+    namespace steering
+    {
+        // Wheel centre offsets from the middle of the chassis; see board.h.
+        constexpr double kHalfWheelbaseM = board::Active::kHalfWheelbaseM;
+        constexpr double kHalfTrackM = board::Active::kHalfTrackM;
+
+        // Sharpest angle any wheel reaches, hit by the inner front wheel at full lock.
+        constexpr double kMaxSteerDeg = 75.0;
+        // 1.0 = full geometric Ackermann, 0.0 = parallel; see inputManager.ts.
+        constexpr double kDifferential = 0.5;
+
+        // Servo travel: 0-180 degrees over the 1000-2000us clamp, 1500us straight.
+        constexpr double kPulseCentreUs = 1500.0;
+        constexpr double kPulseUsPerDeg = 1000.0 / 180.0;
+
+        // Odd, so the centre entry is exactly straight ahead.
+        constexpr size_t kTableSize = 65;
+
+        struct Entry
+        {
+            uint16_t pulseUs[ServoController::kServoCount];
+            // Wheel speed relative to the fastest (outermost) wheel, -1..1. Negative
+            // means the turn centre sits inside the track on that side, so the wheel
+            // has to roll backwards.
+            float speedRatio[MotorController::kMotorCount];
+        };
+
+        namespace detail
+        {
+            constexpr double kPi = 3.14159265358979323846;
+
+            constexpr double abs(double x) { return x < 0.0 ? -x : x; }
+
+            constexpr double sqrt(double x)
+            {
+                if (x <= 0.0)
+                {
+                    return 0.0;
+                }
+                double guess = x > 1.0 ? x : 1.0;
+                for (int i = 0; i < 40; ++i)
+                {
+                    guess = 0.5 * (guess + x / guess);
+                }
+                return guess;
+            }
+
+            // Taylor series, good for |x| <= pi/2.
+            constexpr double sin(double x)
+            {
+                double term = x;
+                double sum = x;
+                for (int n = 1; n < 12; ++n)
+                {
+                    term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+                    sum += term;
+                }
+                return sum;
+            }
+
+            constexpr double cos(double x)
+            {
+                double term = 1.0;
+                double sum = 1.0;
+                for (int n = 1; n < 12; ++n)
+                {
+                    term *= -x * x / ((2.0 * n - 1.0) * (2.0 * n));
+                    sum += term;
+                }
+                return sum;
+            }
+
+            constexpr double atan(double x)
+            {
+                if (x < 0.0)
+                {
+                    return -atan(-x);
+                }
+                if (x > 1.0)
+                {
+                    return kPi / 2.0 - atan(1.0 / x);
+                }
+                // Halve the angle until the series converges fast:
+                // atan(x) = 2 atan(x / (1 + sqrt(1 + x^2))).
+                int doublings = 0;
+                while (x > 0.1)
+                {
+                    x = x / (1.0 + sqrt(1.0 + x * x));
+                    ++doublings;
+                }
+                double term = x;
+                double sum = x;
+                for (int n = 1; n < 10; ++n)
+                {
+                    term *= -x * x;
+                    sum += term / (2.0 * n + 1.0);
+                }
+                for (int i = 0; i < doublings; ++i)
+                {
+                    sum *= 2.0;
+                }
+                return sum;
+            }
+
+            constexpr double kMaxSteerRad = kMaxSteerDeg * kPi / 180.0;
+            constexpr double kTanMaxSteer = sin(kMaxSteerRad) / cos(kMaxSteerRad);
+        } // namespace detail
+
+        // Curvature (1/m) that puts the inner front wheel exactly at kMaxSteerDeg:
+        //   atan(L k / (1 - T D k)) = maxSteer  ->  k = tan(maxSteer) / (L + T D tan(maxSteer))
+        constexpr double kMaxCurvaturePerM =
+            detail::kTanMaxSteer / (kHalfWheelbaseM + kHalfTrackM * kDifferential * detail::kTanMaxSteer);
+
+        constexpr Entry solve(double curvaturePerM)
+        {
+            Entry entry{};
+            double ratios[MotorController::kMotorCount] = {};
+            double fastest = 0.0;
+
+            for (int wheel = 0; wheel < MotorController::kMotorCount; ++wheel)
+            {
+                const double lon = board::Active::kWheelLon[wheel] * kHalfWheelbaseM;
+                const double lat = board::Active::kWheelLat[wheel] * kHalfTrackM;
+
+                const double steerRad = detail::atan((lon * curvaturePerM) / (1.0 - lat * kDifferential * curvaturePerM));
+                const double pulse = kPulseCentreUs + steerRad * (180.0 / detail::kPi) * kPulseUsPerDeg;
+                entry.pulseUs[wheel] = static_cast<uint16_t>(pulse + 0.5);
+
+                // Distance from the turn centre, over the radius: how far this wheel
+                // travels per unit of chassis travel. The differential eases steering
+                // only; speeds follow true geometry, so the outer wheels run faster.
+                const double along = 1.0 - lat * curvaturePerM;
+                const double distance = detail::sqrt((lon * curvaturePerM) * (lon * curvaturePerM) + along * along);
+                ratios[wheel] = (along < 0.0) ? -distance : distance;
+                if (distance > fastest)
+                {
+                    fastest = distance;
+                }
+            }
+
+            for (int wheel = 0; wheel < MotorController::kMotorCount; ++wheel)
+            {
+                entry.speedRatio[wheel] = static_cast<float>(ratios[wheel] / fastest);
+            }
+            return entry;
+        }
+
+        constexpr std::array<Entry, kTableSize> buildTable()
+        {
+            std::array<Entry, kTableSize> table{};
+            constexpr int kHalf = static_cast<int>(kTableSize / 2);
+            for (int index = 0; index < static_cast<int>(kTableSize); ++index)
+            {
+                table[index] = solve(kMaxCurvaturePerM * (index - kHalf) / kHalf);
+            }
+            return table;
+        }
+
+        // One servo and one motor per wheel: the solve writes both at each index.
+        static_assert(ServoController::kServoCount == MotorController::kMotorCount,
+                      "Steering geometry needs a servo per wheel");
+
+        // Interpolated table lookup. radiusM > 0 turns right, < 0 left, 0 is straight
+        // ahead; radii tighter than full lock clamp to full lock.
+        Entry lookup(float radiusM);
+
+        // Tightest radius STEER can reach, for the help text and range checks.
+        constexpr float kMinRadiusM = static_cast<float>(1.0 / kMaxCurvaturePerM);
+    } // namespace steering
+
+} // namespace outputs
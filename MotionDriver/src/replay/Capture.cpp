@@ -0,0 +1,157 @@
+#include "Capture.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace replay
+{
+
+    namespace
+    {
+        int hexValue(char digit)
+        {
+            if (digit >= '0' && digit <= '9')
+            {
+                return digit - '0';
+            }
+            if (digit >= 'A' && digit <= 'F')
+            {
+                return digit - 'A' + 10;
+            }
+            if (digit >= 'a' && digit <= 'f')
+            {
+                return digit - 'a' + 10;
+            }
+            return -1;
+        }
+
+        // "<ms>[.<us>]" at the start of text; false if there is no number there.
+        bool parseTime(const char *&text, uint64_t &atUs)
+        {
+            char *end = nullptr;
+            const unsigned long long ms = strtoull(text, &end, 10);
+            if (end == text)
+            {
+                return false;
+            }
+            atUs = static_cast<uint64_t>(ms) * 1000u;
+
+            if (*end == '.')
+            {
+                ++end;
+                uint64_t scale = 100;
+                while (*end >= '0' && *end <= '9')
+                {
+                    atUs += static_cast<uint64_t>(*end - '0') * scale;
+                    scale /= 10;
+                    ++end;
+                }
+            }
+            while (*end == ' ' || *end == '\t')
+            {
+                ++end;
+            }
+            text = end;
+            return true;
+        }
+
+        bool decodeHex(const std::string &hex, std::string &bytes)
+        {
+            if (hex.empty() || hex.size() % 2 != 0)
+            {
+                return false;
+            }
+            for (size_t index = 0; index < hex.size(); index += 2)
+            {
+                const int high = hexValue(hex[index]);
+                const int low = hexValue(hex[index + 1]);
+                if (high < 0 || low < 0)
+                {
+                    return false;
+                }
+                bytes.push_back(static_cast<char>((high << 4) | low));
+            }
+            return true;
+        }
+
+        void parseComment(const std::string &row, Capture &capture)
+        {
+            const char *cursor = row.c_str() + 1;
+            while (*cursor == ' ')
+            {
+                ++cursor;
+            }
+            uint64_t atUs = 0;
+            if (!parseTime(cursor, atUs))
+            {
+                return;
+            }
+            if (strncmp(cursor, "FAILSAFE", 8) == 0)
+            {
+                ++capture.failsafes;
+            }
+            else if (strncmp(cursor, "REJECTED", 8) == 0)
+            {
+                ++capture.rejected;
+            }
+        }
+    }
+
+    Capture parseCapture(const char *text)
+    {
+        Capture capture;
+        const char *cursor = text;
+        while (*cursor != '\0')
+        {
+            const char *end = strchr(cursor, '\n');
+            if (end == nullptr)
+            {
+                end = cursor + strlen(cursor);
+            }
+            std::string row(cursor, end);
+            cursor = (*end == '\n') ? end + 1 : end;
+
+            while (!row.empty() && (row.back() == '\r' || row.back() == ' '))
+            {
+                row.pop_back();
+            }
+            if (row.empty())
+            {
+                continue;
+            }
+            if (row[0] == '#')
+            {
+                parseComment(row, capture);
+                continue;
+            }
+
+            const char *rest = row.c_str();
+            Unit unit{};
+            if (!parseTime(rest, unit.atUs) || *rest == '\0')
+            {
+                ++capture.malformed;
+                continue;
+            }
+
+            if (rest[0] == '%')
+            {
+                if (!decodeHex(rest + 1, unit.bytes))
+                {
+                    ++capture.malformed;
+                    continue;
+                }
+            }
+            else if (strcmp(rest, "^C") == 0)
+            {
+                unit.bytes = "\x03";
+            }
+            else
+            {
+                unit.bytes = std::string(rest) + "\n";
+            }
+            capture.units.push_back(unit);
+        }
+        return capture;
+    }
+
+} // namespace replay
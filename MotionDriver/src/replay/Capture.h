@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+// Host only: built into [env:native] and [env:replay], never into the firmware.
+namespace replay
+{
+    // A capture is text, one unit per row:
+    //
+    //   <ms>[.<us>] <unit>
+    //
+    // with ms since the capture started (the fraction is three digits of µs). A
+    // unit is a text command as typed, '%' and the hex of a binary frame from its
+    // sync byte, or '^C' for the E-STOP byte. Blank rows and rows starting with '#'
+    // are skipped, except that '# <ms> FAILSAFE' and '# <ms> REJECTED ...' rows are
+    // counted, so a replay can be checked against what the rover did. RECORD DUMP
+    // prints this format; so is test/test_native_bench/traffic/teleop_session.txt.
+    struct Unit
+    {
+        uint64_t atUs;
+        // Exactly what goes on the wire, newline included for a text command.
+        std::string bytes;
+    };
+
+    struct Capture
+    {
+        std::vector<Unit> units;
+        size_t failsafes = 0;
+        size_t rejected = 0;
+        // Rows that were neither a unit nor a comment, e.g. bad hex.
+        size_t malformed = 0;
+    };
+
+    Capture parseCapture(const char *text);
+
+    // 8N1: ten bit times per byte.
+    constexpr double byteTimeUs(unsigned long baudRate)
+    {
+        return 10.0 * 1e6 / static_cast<double>(baudRate);
+    }
+
+} // namespace replay
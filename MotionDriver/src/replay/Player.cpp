@@ -0,0 +1,83 @@
+#include "Player.h"
+
+#include <algorithm>
+
+namespace replay
+{
+
+    bool Rig::begin()
+    {
+        hal::reset();
+        Serial.begin(kBaudRate);
+        input.setCommandLog(&log);
+        input.setHealthMonitor(&scheduler.health());
+        input.begin(kBaudRate);
+        if (!servos.begin(Wire) || !motors.begin())
+        {
+            return false;
+        }
+        encoders.begin();
+        motors.attachPowerBudget(powerBudget);
+        servos.attachPowerBudget(powerBudget);
+        Serial.takeTransmitted();
+        return true;
+    }
+
+    Player::Player(Rig &rig, const Capture &capture, unsigned long wireBaudRate)
+        : m_rig(rig),
+          m_capture(capture),
+          m_byteUs(wireBaudRate != 0 ? byteTimeUs(wireBaudRate) : 0.0)
+    {
+    }
+
+    double Player::landingUs(const Unit &unit) const
+    {
+        if (m_byteUs == 0.0)
+        {
+            return static_cast<double>(unit.atUs);
+        }
+        const double startUs = std::max(m_wireFreeAtUs, static_cast<double>(unit.atUs));
+        return startUs + m_byteUs * static_cast<double>(unit.bytes.size());
+    }
+
+    void Player::step()
+    {
+        hal::setMicros(m_nowUs);
+
+        while (m_next < m_capture.units.size())
+        {
+            const Unit &unit = m_capture.units[m_next];
+            const double landedUs = landingUs(unit);
+            if (landedUs > static_cast<double>(m_nowUs))
+            {
+                break;
+            }
+            m_wireFreeAtUs = landedUs;
+            m_lastLandedUs = m_nowUs;
+            ++m_next;
+            Serial.simulateReceive(reinterpret_cast<const uint8_t *>(unit.bytes.data()), unit.bytes.size());
+        }
+
+        const uint32_t phaseUs = static_cast<uint32_t>(m_nowUs % 1000u);
+        if (phaseUs == kCommandPhaseUs)
+        {
+            m_rig.scheduler.commandTick();
+        }
+        if (phaseUs == kMotorPhaseUs)
+        {
+            m_rig.scheduler.motorTick();
+        }
+        if (m_nowUs % (scheduler::ControlScheduler::kServoPeriodMs * 1000u) == kServoPhaseUs)
+        {
+            m_rig.scheduler.servoTick();
+        }
+
+        m_nowUs += kStepUs;
+    }
+
+    bool Player::finished() const
+    {
+        return m_next == m_capture.units.size() && m_nowUs > m_lastLandedUs + kSettleUs;
+    }
+
+} // namespace replay
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <NativeHal.h>
+
+#include "diagnostics/CommandLog.h"
+#include "diagnostics/Stats.h"
+#include "inputs/UARTCommandInput.h"
+#include "inputs/WheelEncoders.h"
+#include "outputs/MotorController.h"
+#include "outputs/PowerBudget.h"
+#include "outputs/ServoController.h"
+#include "replay/Capture.h"
+#include "scheduler/Commands.h"
+#include "scheduler/ControlScheduler.h"
+#include "scheduler/LoopTiming.h"
+#include "telemetry/TelemetryReporter.h"
+
+namespace replay
+{
+    constexpr unsigned long kBaudRate = 115200;
+
+    // Where in each 1 ms the tasks run during replay. On the ESP32 they drift
+    // relative to each other; fixed phases keep the replay deterministic. The
+    // command task picks a unit up on its first tick after the last byte lands.
+    constexpr uint32_t kStepUs = 50;
+    constexpr uint32_t kCommandPhaseUs = 0;
+    constexpr uint32_t kMotorPhaseUs = 300;
+    constexpr uint32_t kServoPhaseUs = 600;
+    // How long a replay runs on after its last unit, for ramps and slews to land.
+    constexpr uint64_t kSettleUs = 100000;
+
+    // The firmware wired as in main.cpp, on a fresh HAL, with the control link
+    // recording as on the rover. Large: allocate it, don't put it on the stack.
+    struct Rig
+    {
+        outputs::PowerBudget powerBudget{-1};
+        outputs::ServoController servos;
+        outputs::MotorController motors;
+        inputs::WheelEncoders encoders;
+        scheduler::CommandQueues queues;
+        scheduler::LoopTiming motorTiming;
+        diagnostics::Stats stats;
+        diagnostics::CommandLog log;
+        telemetry::TelemetryReporter telemetry{Serial, servos, motors, encoders, motorTiming};
+        inputs::UARTCommandInput input{Serial, queues, telemetry, stats, motors, servos, powerBudget};
+        scheduler::ControlScheduler scheduler{input, servos, motors, encoders, queues, telemetry, motorTiming, stats};
+
+        // Resets the HAL and brings everything up as setup() does, at defaults;
+        // false if a controller failed to start.
+        bool begin();
+    };
+
+    // Steps a capture through a Rig's task bodies on the simulated clock.
+    class Player
+    {
+    public:
+        // wireBaudRate 0 lands each unit at its capture time, as RECORD DUMP stamps
+        // them. Otherwise the times are when the sender wrote them (a bridge-side
+        // capture), and each unit lands after its bytes cross a link at that rate.
+        Player(Rig &rig, const Capture &capture, unsigned long wireBaudRate = 0);
+
+        // Advances the clock by kStepUs: lands every unit due, then runs whichever
+        // task's phase this is.
+        void step();
+
+        uint64_t nowUs() const { return m_nowUs; }
+        size_t landed() const { return m_next; }
+        // Every unit landed and kSettleUs has passed since the last.
+        bool finished() const;
+
+    private:
+        double landingUs(const Unit &unit) const;
+
+        Rig &m_rig;
+        const Capture &m_capture;
+        double m_byteUs;
+        double m_wireFreeAtUs = 0.0;
+        size_t m_next = 0;
+        uint64_t m_nowUs = 0;
+        uint64_t m_lastLandedUs = 0;
+    };
+
+} // namespace replay
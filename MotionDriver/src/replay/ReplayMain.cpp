@@ -0,0 +1,138 @@
+// Host replay tool: runs a capture through the firmware's parser, queues and
+// controllers on the simulated clock, and prints what the firmware sent back.
+//
+//   pio run -e replay
+//   .pio/build/replay/program <capture> [--speed N] [--wire BAUD]
+//
+// --speed N paces the replay at N x real time (0, the default, runs flat out; the
+// result is the same either way). --wire BAUD treats the capture's times as send
+// times, as for a bridge-side capture, and lands each unit after its bytes cross
+// the link. Ends with the firmware's STATS and LAT, so two builds (or two ramp
+// settings) can be diffed on identical traffic.
+
+#include <NativeHal.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "replay/Capture.h"
+#include "replay/Player.h"
+
+namespace
+{
+    void usage(const char *program)
+    {
+        fprintf(stderr, "usage: %s <capture> [--speed N] [--wire BAUD]\n", program);
+    }
+
+    // Each reply line, stamped with the simulated time it went out.
+    void printReplies(uint64_t nowUs, std::string &pending)
+    {
+        const std::vector<uint8_t> bytes = Serial.takeTransmitted();
+        pending.append(bytes.begin(), bytes.end());
+        for (size_t end = pending.find('\n'); end != std::string::npos; end = pending.find('\n'))
+        {
+            std::string line = pending.substr(0, end);
+            pending.erase(0, end + 1);
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            printf("%llu.%03llu < %s\n", static_cast<unsigned long long>(nowUs / 1000),
+                   static_cast<unsigned long long>(nowUs % 1000), line.c_str());
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = nullptr;
+    double speed = 0.0;
+    unsigned long wireBaudRate = 0;
+    for (int index = 1; index < argc; ++index)
+    {
+        if (strcmp(argv[index], "--speed") == 0 && index + 1 < argc)
+        {
+            speed = atof(argv[++index]);
+        }
+        else if (strcmp(argv[index], "--wire") == 0 && index + 1 < argc)
+        {
+            wireBaudRate = strtoul(argv[++index], nullptr, 10);
+        }
+        else if (path == nullptr && argv[index][0] != '-')
+        {
+            path = argv[index];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (path == nullptr || speed < 0.0)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        fprintf(stderr, "%s: cannot read %s\n", argv[0], path);
+        return 1;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    const replay::Capture capture = replay::parseCapture(text.str().c_str());
+    if (capture.units.empty())
+    {
+        fprintf(stderr, "%s: no units in %s\n", argv[0], path);
+        return 1;
+    }
+
+    auto rig = std::make_unique<replay::Rig>();
+    if (!rig->begin())
+    {
+        fprintf(stderr, "%s: firmware failed to start\n", argv[0]);
+        return 1;
+    }
+    rig->stats.actuation().setEnabled(true);
+
+    replay::Player player(*rig, capture, wireBaudRate);
+    const auto wallStart = std::chrono::steady_clock::now();
+    std::string pending;
+    while (!player.finished())
+    {
+        const uint64_t stepUs = player.nowUs();
+        player.step();
+        printReplies(stepUs, pending);
+        if (speed > 0.0)
+        {
+            const auto simulated = std::chrono::microseconds(static_cast<int64_t>(player.nowUs() / speed));
+            std::this_thread::sleep_until(wallStart + simulated);
+        }
+    }
+
+    printf("# REPLAY units=%zu malformed=%zu end_ms=%llu\n", player.landed(), capture.malformed,
+           static_cast<unsigned long long>(player.nowUs() / 1000));
+    // What the capture says the rover did, against what it did again here.
+    printf("# REPLAY recorded failsafes=%zu rejected=%zu, replayed failsafes=%lu frame_errors=%lu "
+           "line_too_long=%lu\n",
+           capture.failsafes, capture.rejected,
+           static_cast<unsigned long>(rig->stats.counters().failsafeTrips.load()),
+           static_cast<unsigned long>(rig->stats.counters().frameErrors.load()),
+           static_cast<unsigned long>(rig->stats.counters().lineTooLong.load()));
+    rig->stats.print(Serial, millis(), rig->telemetry.skippedFrames());
+    rig->stats.actuation().print(Serial);
+    const std::vector<uint8_t> report = Serial.takeTransmitted();
+    fwrite(report.data(), 1, report.size(), stdout);
+    return 0;
+}
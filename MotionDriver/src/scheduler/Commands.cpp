@@ -0,0 +1,232 @@
+#include "Commands.h"
+
+#include <cstring>
+
+namespace scheduler
+{
+
+    void apply(const MotorCommand &command, outputs::MotorController &motorController)
+    {
+        // A breakaway sweep owns the motors until it is marked; anything else that
+        // arrives meanwhile -- a stray DRIVE from the Pi included -- ends it first.
+        if (command.kind != MotorCommand::Kind::CalibrationMark)
+        {
+            motorController.abortBreakawaySweep();
+        }
+
+        switch (command.kind)
+        {
+        case MotorCommand::Kind::Run:
+            motorController.run(command.motorIndex, command.direction, command.speed, true);
+            break;
+        case MotorCommand::Kind::RunAll:
+            motorController.runAll(command.direction, command.speed, true);
+            break;
+        case MotorCommand::Kind::Start:
+            motorController.start(command.motorIndex);
+            break;
+        case MotorCommand::Kind::StartAll:
+            motorController.startAll();
+            break;
+        case MotorCommand::Kind::Stop:
+            motorController.stop(command.motorIndex);
+            break;
+        case MotorCommand::Kind::StopAll:
+            motorController.stopAll();
+            break;
+        case MotorCommand::Kind::SetTargets:
+            motorController.setTargets(command.targets);
+            break;
+        case MotorCommand::Kind::SetSpeedScales:
+            motorController.setSpeedScales(command.targets);
+            break;
+        case MotorCommand::Kind::CalibrationSweep:
+            motorController.startBreakawaySweep(command.motorIndex);
+            break;
+        case MotorCommand::Kind::CalibrationMark:
+            motorController.markBreakaway();
+            break;
+        case MotorCommand::Kind::CalibrationAbort:
+            break;
+        case MotorCommand::Kind::SetCalibration:
+        {
+            outputs::MotorCalibration calibration;
+            calibration.deadband = command.targets[0];
+            calibration.gain = command.targets[1];
+            calibration.curve = command.targets[2];
+            motorController.setCalibration(command.motorIndex, calibration);
+            break;
+        }
+        }
+    }
+
+    void apply(const ServoCommand &command, outputs::ServoController &servoController)
+    {
+        switch (command.kind)
+        {
+        case ServoCommand::Kind::SetPulse:
+            servoController.setTargetMicroseconds(command.channel, command.pulseUs);
+            break;
+        case ServoCommand::Kind::SetPulses:
+            for (uint8_t channel = 0; channel < outputs::ServoController::kServoCount; ++channel)
+            {
+                servoController.setTargetMicroseconds(channel, command.pulses[channel]);
+            }
+            break;
+        case ServoCommand::Kind::Sweep:
+            servoController.enableSweep(command.enabled);
+            break;
+        case ServoCommand::Kind::SweepRange:
+            servoController.setSweepEnabledRange(command.channel, command.endChannel, command.enabled);
+            break;
+        case ServoCommand::Kind::SteeringRadius:
+            servoController.setSteeringRadius(command.radiusM);
+            break;
+        case ServoCommand::Kind::SlewRate:
+            for (uint8_t channel = command.channel; channel <= command.endChannel; ++channel)
+            {
+                servoController.setSlewRate(channel, command.pulseUs);
+            }
+            break;
+        case ServoCommand::Kind::Trim:
+            for (uint8_t channel = command.channel; channel <= command.endChannel; ++channel)
+            {
+                servoController.setTrim(channel, command.trimUs);
+            }
+            break;
+        case ServoCommand::Kind::PulseLimits:
+            for (uint8_t channel = command.channel; channel <= command.endChannel; ++channel)
+            {
+                servoController.setPulseLimits(channel, command.pulses[0], command.pulses[1]);
+            }
+            break;
+        }
+    }
+
+    namespace
+    {
+        uint32_t countBits(uint32_t bits)
+        {
+            return static_cast<uint32_t>(__builtin_popcount(bits));
+        }
+    } // namespace
+
+    bool stage(const MotorCommand &command, MotorTargetMailbox &mailbox, uint32_t &displaced)
+    {
+        constexpr uint8_t kMotorCount = outputs::MotorController::kMotorCount;
+        const float sign = (command.direction == outputs::MotorController::Direction::Backward) ? -1.0f : 1.0f;
+
+        uint8_t mask = 0;
+        switch (command.kind)
+        {
+        case MotorCommand::Kind::Run:
+            if (command.motorIndex >= kMotorCount)
+            {
+                displaced = 0;
+                return true; // run() would ignore it too
+            }
+            mask = static_cast<uint8_t>(1u << command.motorIndex);
+            mailbox.targets[command.motorIndex] = sign * command.speed;
+            break;
+        case MotorCommand::Kind::RunAll:
+            mask = outputs::MotorController::kAllMotorsMask;
+            for (uint8_t index = 0; index < kMotorCount; ++index)
+            {
+                mailbox.targets[index] = sign * command.speed;
+            }
+            break;
+        case MotorCommand::Kind::SetTargets:
+            mask = outputs::MotorController::kAllMotorsMask;
+            memcpy(mailbox.targets, command.targets, sizeof(mailbox.targets));
+            break;
+        default:
+            return false;
+        }
+
+        displaced = countBits(mailbox.mask & mask);
+        mailbox.mask |= mask;
+        for (uint8_t index = 0; index < kMotorCount; ++index)
+        {
+            if ((mask & (1u << index)) != 0)
+            {
+                mailbox.stampUs[index] = command.stampUs;
+            }
+        }
+        return true;
+    }
+
+    bool stage(const ServoCommand &command, ServoTargetMailbox &mailbox, uint32_t &displaced)
+    {
+        constexpr uint8_t kServoCount = outputs::ServoController::kServoCount;
+
+        uint8_t mask = 0;
+        switch (command.kind)
+        {
+        case ServoCommand::Kind::SetPulse:
+            if (command.channel >= kServoCount)
+            {
+                displaced = 0;
+                return true; // setTargetMicroseconds() would ignore it too
+            }
+            mask = static_cast<uint8_t>(1u << command.channel);
+            mailbox.pulses[command.channel] = command.pulseUs;
+            break;
+        case ServoCommand::Kind::SetPulses:
+            mask = static_cast<uint8_t>((1u << kServoCount) - 1);
+            memcpy(mailbox.pulses, command.pulses, sizeof(mailbox.pulses));
+            break;
+        default:
+            return false;
+        }
+
+        displaced = countBits(mailbox.mask & mask);
+        mailbox.mask |= mask;
+        for (uint8_t channel = 0; channel < kServoCount; ++channel)
+        {
+            if ((mask & (1u << channel)) != 0)
+            {
+                mailbox.stampUs[channel] = command.stampUs;
+            }
+        }
+        return true;
+    }
+
+    uint32_t discard(MotorTargetMailbox &mailbox, uint8_t mask)
+    {
+        const uint32_t dropped = countBits(mailbox.mask & mask);
+        mailbox.mask = static_cast<uint8_t>(mailbox.mask & ~mask);
+        return dropped;
+    }
+
+    uint32_t discard(ServoTargetMailbox &mailbox, uint8_t mask)
+    {
+        const uint32_t dropped = countBits(mailbox.mask & mask);
+        mailbox.mask = static_cast<uint8_t>(mailbox.mask & ~mask);
+        return dropped;
+    }
+
+    void apply(MotorTargetMailbox &mailbox, outputs::MotorController &motorController)
+    {
+        if (mailbox.mask == 0)
+        {
+            return;
+        }
+        // As for any queued command other than a mark.
+        motorController.abortBreakawaySweep();
+        motorController.setTargets(mailbox.targets, mailbox.mask);
+        mailbox.mask = 0;
+    }
+
+    void apply(ServoTargetMailbox &mailbox, outputs::ServoController &servoController)
+    {
+        for (uint8_t channel = 0; channel < outputs::ServoController::kServoCount; ++channel)
+        {
+            if ((mailbox.mask & (1u << channel)) != 0)
+            {
+                servoController.setTargetMicroseconds(channel, mailbox.pulses[channel]);
+            }
+        }
+        mailbox.mask = 0;
+    }
+
+} // namespace scheduler
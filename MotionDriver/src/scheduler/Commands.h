@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+
+#include "outputs/MotorController.h"
+#include "outputs/ServoController.h"
+#include "scheduler/SpscQueue.h"
+
+namespace scheduler
+{
+
+    // A parsed motion request, handed from the command task to the motor task. One
+    // record per controller call the parser used to make directly.
+    struct MotorCommand
+    {
+        enum class Kind : uint8_t
+        {
+            Run,
+            RunAll,
+            Start,
+            StartAll,
+            Stop,
+            StopAll,
+            SetTargets,
+            SetSpeedScales, // scales carried in targets[]
+            CalibrationSweep,
+            CalibrationMark,
+            CalibrationAbort,
+            SetCalibration // deadband, gain, curve carried in targets[0..2]
+        };
+
+        Kind kind;
+        uint8_t motorIndex;
+        outputs::MotorController::Direction direction;
+        float speed;
+        float targets[outputs::MotorController::kMotorCount];
+        // LAT receive stamp of the line/frame that produced it; 0 if untracked.
+        uint32_t stampUs;
+    };
+
+    // A parsed servo request, handed from the command task to the servo (I2C) task.
+    struct ServoCommand
+    {
+        enum class Kind : uint8_t
+        {
+            SetPulse,
+            SetPulses,
+            Sweep,      // default sweep channel
+            SweepRange, // startChannel..endChannel inclusive
+            SteeringRadius,
+            SlewRate,    // channel..endChannel inclusive, us per second carried in pulseUs
+            Trim,        // channel..endChannel inclusive, carried in trimUs
+            PulseLimits  // channel..endChannel inclusive, min/max carried in pulses[0..1]
+        };
+
+        Kind kind;
+        uint8_t channel;
+        uint8_t endChannel;
+        bool enabled;
+        uint16_t pulseUs;
+        int16_t trimUs;
+        float radiusM;
+        uint16_t pulses[outputs::ServoController::kServoCount];
+        // As MotorCommand::stampUs.
+        uint32_t stampUs;
+    };
+
+    // Depth is generous: the motor task drains every millisecond, and at 115200 baud
+    // even back-to-back binary frames arrive at most a few per millisecond.
+    using MotorCommandQueue = SpscQueue<MotorCommand, 16>;
+    using ServoCommandQueue = SpscQueue<ServoCommand, 16>;
+
+    struct CommandQueues
+    {
+        MotorCommandQueue motor;
+        ServoCommandQueue servo;
+        // Set when a stop-all could not be queued. The motor task honours it ahead of
+        // anything queued, so a full queue can delay a stop but never lose one.
+        std::atomic<bool> stopAllPending{false};
+    };
+
+    void apply(const MotorCommand &command, outputs::MotorController &motorController);
+    void apply(const ServoCommand &command, outputs::ServoController &servoController);
+
+    // Latest-wins staging for the plain targets drained in one output tick. A newer
+    // target for a motor or channel replaces the staged one before either reaches
+    // the controller, so a burst off the link costs one controller call per tick
+    // however long it was. Each output keeps the LAT stamp of the command that set it.
+    struct MotorTargetMailbox
+    {
+        uint8_t mask = 0;
+        float targets[outputs::MotorController::kMotorCount] = {};
+        uint32_t stampUs[outputs::MotorController::kMotorCount] = {};
+    };
+
+    struct ServoTargetMailbox
+    {
+        uint8_t mask = 0;
+        uint16_t pulses[outputs::ServoController::kServoCount] = {};
+        uint32_t stampUs[outputs::ServoController::kServoCount] = {};
+    };
+
+    // Stages a command that only sets targets -- Run, RunAll and SetTargets; SetPulse
+    // and SetPulses -- and returns true; anything else is left for apply(). Returns
+    // in displaced how many staged targets it replaced.
+    bool stage(const MotorCommand &command, MotorTargetMailbox &mailbox, uint32_t &displaced);
+    bool stage(const ServoCommand &command, ServoTargetMailbox &mailbox, uint32_t &displaced);
+    // Drops the staged targets in mask, which a stop or a full steer is about to
+    // override, and returns how many there were.
+    uint32_t discard(MotorTargetMailbox &mailbox, uint8_t mask);
+    uint32_t discard(ServoTargetMailbox &mailbox, uint8_t mask);
+    // Hands everything staged to the controller in one call and empties the mailbox.
+    void apply(MotorTargetMailbox &mailbox, outputs::MotorController &motorController);
+    void apply(ServoTargetMailbox &mailbox, outputs::ServoController &servoController);
+
+} // namespace scheduler
@@ -0,0 +1,657 @@
+#include "ControlScheduler.h"
+
+#include <algorithm>
+
+namespace scheduler
+{
+
+    static_assert(inputs::WheelEncoders::kWheelCount == outputs::MotorController::kMotorCount,
+                  "Encoders and motors are indexed by the same wheel");
+
+    namespace
+    {
+        // Applies a command and returns the mask of outputs it retargeted, the ones
+        // whose next write is its actuation. Only LAT-stamped commands pay for the
+        // comparison; a repeat of the current speed retargets nothing.
+        uint32_t applyRetargeting(const MotorCommand &command, outputs::MotorController &motorController)
+        {
+            constexpr uint8_t kMotorCount = outputs::MotorController::kMotorCount;
+            if (command.stampUs == 0)
+            {
+                apply(command, motorController);
+                return 0;
+            }
+
+            int16_t targets[kMotorCount];
+            for (uint8_t index = 0; index < kMotorCount; ++index)
+            {
+                targets[index] = motorController.targetSpeedQ15(index);
+            }
+            apply(command, motorController);
+            uint32_t retargeted = 0;
+            for (uint8_t index = 0; index < kMotorCount; ++index)
+            {
+                if (targets[index] != motorController.targetSpeedQ15(index))
+                {
+                    retargeted |= 1u << index;
+                }
+            }
+            return retargeted;
+        }
+
+        uint32_t applyRetargeting(const ServoCommand &command, outputs::ServoController &servoController)
+        {
+            constexpr uint8_t kServoCount = outputs::ServoController::kServoCount;
+            if (command.stampUs == 0)
+            {
+                apply(command, servoController);
+                return 0;
+            }
+
+            uint16_t targets[kServoCount];
+            for (uint8_t channel = 0; channel < kServoCount; ++channel)
+            {
+                targets[channel] = servoController.targetPulseUs(channel);
+            }
+            apply(command, servoController);
+            uint32_t retargeted = 0;
+            for (uint8_t channel = 0; channel < kServoCount; ++channel)
+            {
+                if (targets[channel] != servoController.targetPulseUs(channel))
+                {
+                    retargeted |= 1u << channel;
+                }
+            }
+            return retargeted;
+        }
+
+        // One LAT entry per distinct stamp among the retargeted outputs, so a staged
+        // target is timed against the command that set it.
+        void addByStamp(diagnostics::PendingActuations &pending, const uint32_t *stampUs, uint8_t count,
+                        uint32_t retargeted)
+        {
+            for (uint8_t index = 0; index < count; ++index)
+            {
+                if ((retargeted & (1u << index)) == 0 || stampUs[index] == 0)
+                {
+                    continue;
+                }
+                uint32_t mask = 0;
+                for (uint8_t other = index; other < count; ++other)
+                {
+                    if ((retargeted & (1u << other)) != 0 && stampUs[other] == stampUs[index])
+                    {
+                        mask |= 1u << other;
+                    }
+                }
+                retargeted &= ~mask;
+                pending.add(stampUs[index], mask);
+            }
+        }
+
+        bool anyStamped(const uint32_t *stampUs, uint8_t count, uint8_t mask)
+        {
+            for (uint8_t index = 0; index < count; ++index)
+            {
+                if ((mask & (1u << index)) != 0 && stampUs[index] != 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void applyStaged(MotorTargetMailbox &mailbox, outputs::MotorController &motorController,
+                         diagnostics::PendingActuations &pending)
+        {
+            constexpr uint8_t kMotorCount = outputs::MotorController::kMotorCount;
+            if (!anyStamped(mailbox.stampUs, kMotorCount, mailbox.mask))
+            {
+                apply(mailbox, motorController);
+                return;
+            }
+
+            int16_t targets[kMotorCount];
+            for (uint8_t index = 0; index < kMotorCount; ++index)
+            {
+                targets[index] = motorController.targetSpeedQ15(index);
+            }
+            apply(mailbox, motorController);
+            uint32_t retargeted = 0;
+            for (uint8_t index = 0; index < kMotorCount; ++index)
+            {
+                if (targets[index] != motorController.targetSpeedQ15(index))
+                {
+                    retargeted |= 1u << index;
+                }
+            }
+            addByStamp(pending, mailbox.stampUs, kMotorCount, retargeted);
+        }
+
+        void applyStaged(ServoTargetMailbox &mailbox, outputs::ServoController &servoController,
+                         diagnostics::PendingActuations &pending)
+        {
+            constexpr uint8_t kServoCount = outputs::ServoController::kServoCount;
+            if (!anyStamped(mailbox.stampUs, kServoCount, mailbox.mask))
+            {
+                apply(mailbox, servoController);
+                return;
+            }
+
+            uint16_t targets[kServoCount];
+            for (uint8_t channel = 0; channel < kServoCount; ++channel)
+            {
+                targets[channel] = servoController.targetPulseUs(channel);
+            }
+            apply(mailbox, servoController);
+            uint32_t retargeted = 0;
+            for (uint8_t channel = 0; channel < kServoCount; ++channel)
+            {
+                if (targets[channel] != servoController.targetPulseUs(channel))
+                {
+                    retargeted |= 1u << channel;
+                }
+            }
+            addByStamp(pending, mailbox.stampUs, kServoCount, retargeted);
+        }
+    } // namespace
+
+    ControlScheduler::ControlScheduler(inputs::UARTCommandInput &commandInput,
+                                       outputs::ServoController &servoController,
+                                       outputs::MotorController &motorController,
+                                       inputs::WheelEncoders &wheelEncoders,
+                                       CommandQueues &queues,
+                                       telemetry::TelemetryReporter &telemetryReporter,
+                                       LoopTiming &motorTiming,
+                                       diagnostics::Stats &stats)
+        : m_commandInput(commandInput),
+          m_servoController(servoController),
+          m_motorController(motorController),
+          m_wheelEncoders(wheelEncoders),
+          m_queues(queues),
+          m_telemetryReporter(telemetryReporter),
+          m_motorTiming(motorTiming),
+          m_stats(stats),
+          m_health(stats),
+          m_consoleInput(nullptr),
+          m_consoleQueues(nullptr),
+          m_consoleTelemetry(nullptr),
+          m_started(false),
+          m_motorTask(nullptr),
+          m_servoTask(nullptr),
+          m_motorIdle(false),
+          m_lastMotorStart(0),
+          m_lastMotorStartUs(0),
+          m_lastVelocityUs(0),
+          m_motorResumed(false),
+          m_flushFailuresInRow(0)
+    {
+    }
+
+    void ControlScheduler::attachConsole(inputs::UARTCommandInput &consoleInput, CommandQueues &consoleQueues,
+                                         telemetry::TelemetryReporter &consoleTelemetry)
+    {
+        m_consoleInput = &consoleInput;
+        m_consoleQueues = &consoleQueues;
+        m_consoleTelemetry = &consoleTelemetry;
+    }
+
+    bool ControlScheduler::begin()
+    {
+        if (m_started)
+        {
+            return true;
+        }
+        if (!HealthMonitor::beginWatchdog())
+        {
+            return false;
+        }
+
+        // Motor task first, so the ramp is ticking before anything can queue a command.
+        if (xTaskCreatePinnedToCore(motorTaskEntry, "motor", kMotorStackBytes, this, kMotorPriority, &m_motorTask, kMotorCore) != pdPASS)
+        {
+            return false;
+        }
+        if (xTaskCreatePinnedToCore(servoTaskEntry, "servo", kServoStackBytes, this, kServoPriority, &m_servoTask, kServoCore) != pdPASS)
+        {
+            return false;
+        }
+        if (xTaskCreatePinnedToCore(commandTaskEntry, "command", kCommandStackBytes, this, kCommandPriority, nullptr, kCommandCore) != pdPASS)
+        {
+            return false;
+        }
+        if (m_consoleInput != nullptr &&
+            xTaskCreatePinnedToCore(consoleTaskEntry, "console", kConsoleStackBytes, this, kConsolePriority, nullptr, kConsoleCore) != pdPASS)
+        {
+            return false;
+        }
+
+        m_started = true;
+        return true;
+    }
+
+    void ControlScheduler::motorTaskEntry(void *context)
+    {
+        static_cast<ControlScheduler *>(context)->runMotorTask();
+    }
+
+    void ControlScheduler::commandTaskEntry(void *context)
+    {
+        static_cast<ControlScheduler *>(context)->runCommandTask();
+    }
+
+    void ControlScheduler::servoTaskEntry(void *context)
+    {
+        static_cast<ControlScheduler *>(context)->runServoTask();
+    }
+
+    void ControlScheduler::consoleTaskEntry(void *context)
+    {
+        static_cast<ControlScheduler *>(context)->runConsoleTask();
+    }
+
+    void ControlScheduler::runMotorTask()
+    {
+        HealthMonitor::watchCurrentTask();
+        TickType_t lastWake = xTaskGetTickCount();
+        m_lastMotorStart = diagnostics::cycleCount();
+        m_lastMotorStartUs = micros();
+        m_lastVelocityUs = micros();
+        for (;;)
+        {
+            motorTick();
+            // A ramp still converging, a breakaway sweep or a closed-loop wheel needs
+            // every tick; a LAT stamp still waiting on its write does too.
+            const bool trimming = m_wheelEncoders.anyFitted() && m_motorController.driverEnabled();
+            if (!m_motorController.settled() || trimming || !m_motorActuations.empty())
+            {
+                vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(kMotorPeriodMs));
+                continue;
+            }
+
+            m_motorIdle.store(true, std::memory_order_release);
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(kIdleWaitMs));
+            m_motorIdle.store(false, std::memory_order_release);
+            lastWake = xTaskGetTickCount();
+            m_motorResumed = true;
+        }
+    }
+
+    void ControlScheduler::runCommandTask()
+    {
+        HealthMonitor::watchCurrentTask();
+        m_commandInput.setReceiveWaiter(xTaskGetCurrentTaskHandle());
+        for (;;)
+        {
+            commandTick();
+            waitForCommandWork(m_commandInput, m_telemetryReporter);
+        }
+    }
+
+    void ControlScheduler::runConsoleTask()
+    {
+        m_consoleInput->setReceiveWaiter(xTaskGetCurrentTaskHandle());
+        for (;;)
+        {
+            consoleTick();
+            waitForCommandWork(*m_consoleInput, *m_consoleTelemetry);
+        }
+    }
+
+    void ControlScheduler::waitForCommandWork(inputs::UARTCommandInput &input, telemetry::TelemetryReporter &telemetry)
+    {
+        // Input wakes this early; otherwise sleep to the next deadline, yielding at
+        // least a tick so the tasks below always get the core. Shed telemetry has no
+        // deadline.
+        const uint32_t nowMs = millis();
+        uint32_t waitMs = input.msUntilDue(nowMs);
+        if (m_health.level() < HealthLevel::ShedTelemetry)
+        {
+            waitMs = std::min(waitMs, telemetry.msUntilDue(nowMs));
+        }
+        waitMs = std::max(kCommandPeriodMs, std::min(waitMs, kIdleWaitMs));
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+    }
+
+    void ControlScheduler::runServoTask()
+    {
+        HealthMonitor::watchCurrentTask();
+        TickType_t lastWake = xTaskGetTickCount();
+        for (;;)
+        {
+            servoTick();
+            // The motors' budget is paced by this task's current sample, so keep
+            // ticking while they ramp even when no servo moves.
+            const bool motorIdle = m_motorIdle.load(std::memory_order_acquire);
+            if (!m_servoController.settled() || !motorIdle || !m_servoActuations.empty())
+            {
+                vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(kServoPeriodMs));
+                continue;
+            }
+
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(kIdleWaitMs));
+            lastWake = xTaskGetTickCount();
+        }
+    }
+
+    void ControlScheduler::wakeOutputTasks(const CommandQueues &queues)
+    {
+        // Both handles are set before the command task exists; off-target they never are.
+        if (m_motorTask == nullptr || m_servoTask == nullptr)
+        {
+            return;
+        }
+        const bool motorWork = !queues.motor.empty() || queues.stopAllPending.load(std::memory_order_acquire);
+        if (motorWork)
+        {
+            // The servo task follows: it has to sample the pack while the motors ramp.
+            xTaskNotifyGive(m_motorTask);
+            xTaskNotifyGive(m_servoTask);
+        }
+        else if (!queues.servo.empty())
+        {
+            xTaskNotifyGive(m_servoTask);
+        }
+    }
+
+    void ControlScheduler::motorTick()
+    {
+        const uint32_t cyclesPerUs = ESP.getCpuFreqMHz();
+        const uint32_t start = diagnostics::cycleCount();
+        const uint32_t startUs = micros();
+        m_health.beat(WatchedTask::Motor, millis());
+        if (m_motorResumed && m_wheelEncoders.anyFitted())
+        {
+            // Re-baseline the counts so the first trim after a sleep measures one
+            // velocity period, not the whole time the wheels sat still.
+            const uint32_t nowUs = micros();
+            m_wheelEncoders.sample(nowUs - m_lastVelocityUs);
+            m_lastVelocityUs = nowUs;
+        }
+
+        drainMotorCommands(m_queues);
+        if (m_consoleQueues != nullptr)
+        {
+            drainMotorCommands(*m_consoleQueues);
+        }
+
+        m_motorController.update(millis());
+
+        const uint8_t writtenMotors = m_motorController.takeWrittenMask();
+        if (!m_motorActuations.empty())
+        {
+            m_motorActuations.update(m_stats.actuation(), diagnostics::LatencyPath::RxToMotorPwm, writtenMotors);
+        }
+
+        if (m_wheelEncoders.anyFitted())
+        {
+            const uint32_t nowUs = micros();
+            const uint32_t elapsedUs = nowUs - m_lastVelocityUs;
+            if (elapsedUs >= kVelocityPeriodUs)
+            {
+                m_lastVelocityUs = nowUs;
+                m_wheelEncoders.sample(elapsedUs);
+                float speeds[outputs::MotorController::kMotorCount];
+                for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
+                {
+                    speeds[index] = m_wheelEncoders.speedRadPerSec(index);
+                }
+                m_motorController.setMeasuredSpeeds(speeds, m_wheelEncoders.fittedMask(), elapsedUs);
+            }
+        }
+
+        // Cycle counts wrap every ~18 s at 240 MHz; unsigned differences survive it.
+        const uint32_t workCycles = diagnostics::cycleCount() - start;
+        const uint32_t periodCycles = start - m_lastMotorStart;
+        const uint32_t periodUs = startUs - m_lastMotorStartUs;
+        m_lastMotorStart = start;
+        m_lastMotorStartUs = startUs;
+        m_stats.record(diagnostics::Stage::MotorTick, workCycles);
+        // The period is judged on micros(), which the host bench simulates, so a
+        // late tick there is one the replay made late.
+        const bool late = !m_motorResumed && periodUs > kMotorOverrunPeriodUs;
+        if (late || workCycles / cyclesPerUs > kMotorOverrunWorkUs)
+        {
+            diagnostics::Stats::increment(m_stats.counters().motorOverruns);
+        }
+        if (m_motorResumed)
+        {
+            m_motorResumed = false;
+            m_motorTiming.record(workCycles / cyclesPerUs, 0);
+            return;
+        }
+        m_stats.record(diagnostics::Stage::MotorPeriod, periodCycles);
+        m_motorTiming.record(workCycles / cyclesPerUs, periodCycles / cyclesPerUs);
+    }
+
+    void ControlScheduler::drainMotorCommands(CommandQueues &queues)
+    {
+        MotorCommand command;
+        if (queues.stopAllPending.exchange(false))
+        {
+            // Whatever is still queued predates the stop; drop it rather than let
+            // it re-enable the motors behind the stop.
+            while (queues.motor.pop(command))
+            {
+            }
+            m_motorController.stopAll();
+        }
+
+        // Plain targets reach the controller once per tick, from the mailbox. Stops go
+        // straight through and void what they override; any other command applies in
+        // queue order, so whatever was staged ahead of it lands first.
+        MotorTargetMailbox mailbox;
+        uint32_t superseded = 0;
+        const HealthLevel level = m_health.level();
+        uint32_t shed = 0;
+        while (queues.motor.pop(command))
+        {
+            if (sheds(level, command))
+            {
+                ++shed;
+                continue;
+            }
+
+            uint32_t displaced = 0;
+            if (stage(command, mailbox, displaced))
+            {
+                superseded += displaced;
+                continue;
+            }
+
+            if (command.kind == MotorCommand::Kind::StopAll)
+            {
+                superseded += discard(mailbox, outputs::MotorController::kAllMotorsMask);
+            }
+            else if (command.kind == MotorCommand::Kind::Stop && command.motorIndex < outputs::MotorController::kMotorCount)
+            {
+                superseded += discard(mailbox, static_cast<uint8_t>(1u << command.motorIndex));
+            }
+            else
+            {
+                applyStaged(mailbox, m_motorController, m_motorActuations);
+            }
+            m_motorActuations.add(command.stampUs, applyRetargeting(command, m_motorController));
+        }
+        applyStaged(mailbox, m_motorController, m_motorActuations);
+
+        if (superseded != 0)
+        {
+            diagnostics::Stats::add(m_stats.counters().supersededTargets, superseded);
+        }
+        if (shed != 0)
+        {
+            diagnostics::Stats::add(m_stats.counters().shedCommands, shed);
+        }
+    }
+
+    void ControlScheduler::commandTick()
+    {
+        const uint32_t pollStart = diagnostics::cycleCount();
+        m_health.beat(WatchedTask::Command, millis());
+        m_commandInput.poll();
+        const uint32_t updateStart = diagnostics::cycleCount();
+        m_stats.record(diagnostics::Stage::CommandPoll, updateStart - pollStart);
+
+        const uint32_t nowMs = millis();
+        // Ahead of the input's update(), which reports a new level on the link.
+        if (m_health.evaluate(nowMs))
+        {
+            applyHealthLevel();
+        }
+        m_commandInput.update(nowMs);
+        if (m_health.level() < HealthLevel::ShedTelemetry)
+        {
+            m_telemetryReporter.update(nowMs, m_commandInput.failsafeActive());
+        }
+        const uint32_t end = diagnostics::cycleCount();
+        m_stats.record(diagnostics::Stage::CommandUpdate, end - updateStart);
+        if ((end - pollStart) / ESP.getCpuFreqMHz() > kCommandOverrunUs)
+        {
+            diagnostics::Stats::increment(m_stats.counters().commandOverruns);
+        }
+
+        wakeOutputTasks(m_queues);
+    }
+
+    void ControlScheduler::applyHealthLevel()
+    {
+        if (m_health.level() != HealthLevel::MotorsStopped)
+        {
+            return;
+        }
+        // The level is already published, so the motor task drops anything queued
+        // behind this stop.
+        if (m_health.cause() == HealthCause::MotorStall)
+        {
+            // The motor task cannot run the stop; cut the bridges from here.
+            m_motorController.cutDrivers();
+        }
+        m_queues.stopAllPending.store(true, std::memory_order_release);
+    }
+
+    void ControlScheduler::consoleTick()
+    {
+        if (m_consoleInput == nullptr)
+        {
+            return;
+        }
+        m_consoleInput->poll();
+        const uint32_t nowMs = millis();
+        m_consoleInput->update(nowMs);
+        if (m_health.level() < HealthLevel::ShedTelemetry)
+        {
+            m_consoleTelemetry->update(nowMs, m_consoleInput->failsafeActive());
+        }
+        wakeOutputTasks(*m_consoleQueues);
+    }
+
+    void ControlScheduler::drainServoCommands(CommandQueues &queues)
+    {
+        // As for the motors; a steer sets every channel, so it voids whatever is staged.
+        ServoCommand command;
+        ServoTargetMailbox mailbox;
+        uint32_t superseded = 0;
+        const HealthLevel level = m_health.level();
+        uint32_t shed = 0;
+        while (queues.servo.pop(command))
+        {
+            if (sheds(level, command))
+            {
+                ++shed;
+                continue;
+            }
+
+            uint32_t displaced = 0;
+            if (stage(command, mailbox, displaced))
+            {
+                superseded += displaced;
+                continue;
+            }
+
+            if (command.kind == ServoCommand::Kind::SteeringRadius)
+            {
+                superseded += discard(mailbox, mailbox.mask);
+            }
+            else
+            {
+                applyStaged(mailbox, m_servoController, m_servoActuations);
+            }
+            m_servoActuations.add(command.stampUs, applyRetargeting(command, m_servoController));
+        }
+        applyStaged(mailbox, m_servoController, m_servoActuations);
+
+        if (superseded != 0)
+        {
+            diagnostics::Stats::add(m_stats.counters().supersededTargets, superseded);
+        }
+        if (shed != 0)
+        {
+            diagnostics::Stats::add(m_stats.counters().shedCommands, shed);
+        }
+    }
+
+    void ControlScheduler::servoTick()
+    {
+        const uint32_t updateStart = diagnostics::cycleCount();
+        m_health.beat(WatchedTask::Servo, millis());
+        drainServoCommands(m_queues);
+        if (m_consoleQueues != nullptr)
+        {
+            drainServoCommands(*m_consoleQueues);
+        }
+        if (m_health.level() >= HealthLevel::ShedSweeps && m_servoController.sweeping())
+        {
+            m_servoController.stopSweeps();
+        }
+        m_servoController.update(millis());
+
+        const uint32_t flushStart = diagnostics::cycleCount();
+        m_stats.record(diagnostics::Stage::ServoUpdate, flushStart - updateStart);
+        bool flushed = false;
+        // Only time real bus traffic; idle ticks would bury it under zeros.
+        if (m_servoController.flushPending())
+        {
+            flushed = m_servoController.flush();
+            if (!flushed)
+            {
+                diagnostics::Stats::increment(m_stats.counters().i2cFlushFailures);
+            }
+            m_stats.record(diagnostics::Stage::I2cFlush, diagnostics::cycleCount() - flushStart);
+
+            // A bus that keeps failing is usually held low by a slave cut off
+            // mid-byte, which no retry gets past.
+            m_flushFailuresInRow = flushed ? 0 : m_flushFailuresInRow + 1;
+            if (m_flushFailuresInRow >= kFlushFailuresBeforeRecovery)
+            {
+                m_flushFailuresInRow = 0;
+                diagnostics::Stats::increment(m_stats.counters().i2cRecoveries);
+                m_servoController.recoverBus();
+            }
+        }
+        if ((diagnostics::cycleCount() - updateStart) / ESP.getCpuFreqMHz() > kServoOverrunUs)
+        {
+            diagnostics::Stats::increment(m_stats.counters().servoOverruns);
+        }
+
+        // A burst carries every channel whose pulse moved since the last one.
+        uint32_t writtenChannels = 0;
+        if (flushed)
+        {
+            for (uint8_t channel = 0; channel < outputs::ServoController::kServoCount; ++channel)
+            {
+                const uint16_t pulseUs = m_servoController.currentPulseUs(channel);
+                if (pulseUs != m_flushedPulseUs[channel])
+                {
+                    m_flushedPulseUs[channel] = pulseUs;
+                    writtenChannels |= 1u << channel;
+                }
+            }
+        }
+        if (!m_servoActuations.empty())
+        {
+            m_servoActuations.update(m_stats.actuation(), diagnostics::LatencyPath::RxToServoPwm, writtenChannels);
+        }
+    }
+
+} // namespace scheduler
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "diagnostics/Stats.h"
+#include "inputs/UARTCommandInput.h"
+#include "inputs/WheelEncoders.h"
+#include "outputs/MotorController.h"
+#include "outputs/ServoController.h"
+#include "scheduler/Commands.h"
+#include "scheduler/HealthMonitor.h"
+#include "scheduler/LoopTiming.h"
+#include "telemetry/TelemetryReporter.h"
+
+namespace scheduler
+{
+
+    // Splits the firmware across both ESP32 cores:
+    //
+    //   core 1  motor task    fixed 1 kHz tick: drain motor commands, ramp, LEDC writes,
+    //                         and a 100 Hz encoder sample + velocity trim when fitted
+    //   core 0  command task  UART ingestion, parsing, deadman, telemetry out
+    //   core 0  servo task    drain servo commands, sweeps, blocking PCA9685 I2C writes
+    //   core 0  console task  optional second port, the same work below everything else
+    //
+    // Nothing on core 0 can stretch the motor ramp period. The tasks share state only
+    // through CommandQueues, each queue having exactly one producer and one consumer;
+    // an attached console brings its own set, which the output tasks drain after the
+    // command task's. The console sits below the servo task, so a HELP dump blocking
+    // on its TX FIFO delays neither the control link nor the servos.
+    //
+    // The periods are only kept while there is work. Once every ramp has landed the
+    // motor task blocks until the command task queues something; the servo task does
+    // the same once its slews have and the motors are idle too, since its pack-current
+    // sample paces the motor ramp's budget. The command task sleeps until the receive
+    // event signals input or its next deadline (deadman, ACK, telemetry, segment
+    // sample) comes up. With all three blocked the idle task parks both cores in
+    // WAITI between ticks. Light sleep is deliberately not used: it would stop the
+    // LEDC clock, and with it the PWM holding the motors.
+    //
+    // The motor, command and servo tasks beat a HealthMonitor every pass and count
+    // their overruns; the command task runs its degradation ladder (see
+    // scheduler/HealthMonitor.h) and every task sheds what the level asks of it.
+    class ControlScheduler
+    {
+    public:
+        ControlScheduler(inputs::UARTCommandInput &commandInput,
+                         outputs::ServoController &servoController,
+                         outputs::MotorController &motorController,
+                         inputs::WheelEncoders &wheelEncoders,
+                         CommandQueues &queues,
+                         telemetry::TelemetryReporter &telemetryReporter,
+                         LoopTiming &motorTiming,
+                         diagnostics::Stats &stats);
+
+        // A second command port with its own queues and telemetry, run by the console
+        // task. It is neither timed nor counted in STATS' stage timings, which have
+        // the command task as their only writer. Attach before begin().
+        void attachConsole(inputs::UARTCommandInput &consoleInput, CommandQueues &consoleQueues,
+                           telemetry::TelemetryReporter &consoleTelemetry);
+
+        // Arms the task watchdog and starts the tasks. Call once from setup(), after
+        // every controller's begin().
+        bool begin();
+
+        const HealthMonitor &health() const { return m_health; }
+
+        // One pass of each task's body, which the tasks run on their periods below.
+        // Public so the native benchmarks can step them on a simulated clock; on the
+        // ESP32 only the tasks call them.
+        void motorTick();
+        void commandTick();
+        void consoleTick();
+        void servoTick();
+
+        static constexpr uint32_t kMotorPeriodMs = 1;
+        static constexpr uint32_t kServoPeriodMs = 2;
+        static constexpr uint32_t kCommandPeriodMs = 1;
+        // Longest any task sleeps while idle, so a lost wake-up costs one housekeeping
+        // tick rather than a stuck task.
+        static constexpr uint32_t kIdleWaitMs = 100;
+
+        // Overrun thresholds. A motor tick overruns when it starts more than half a
+        // period late or its work outlasts a period; a command tick when its work
+        // takes two periods; a servo tick when it outlasts a servo period.
+        static constexpr uint32_t kMotorOverrunPeriodUs = kMotorPeriodMs * 1500;
+        static constexpr uint32_t kMotorOverrunWorkUs = kMotorPeriodMs * 1000;
+        static constexpr uint32_t kCommandOverrunUs = kCommandPeriodMs * 2000;
+        static constexpr uint32_t kServoOverrunUs = kServoPeriodMs * 1000;
+        // Failed bursts in a row before the servo task tries to free the bus.
+        static constexpr uint8_t kFlushFailuresBeforeRecovery = 3;
+
+    private:
+        static void motorTaskEntry(void *context);
+        static void commandTaskEntry(void *context);
+        static void servoTaskEntry(void *context);
+        static void consoleTaskEntry(void *context);
+
+        void runMotorTask();
+        void runCommandTask();
+        void runServoTask();
+        void runConsoleTask();
+        // Sleeps a command-side task until input arrives or the port's next deadline.
+        void waitForCommandWork(inputs::UARTCommandInput &input, telemetry::TelemetryReporter &telemetry);
+        // Drains one set of queues into the controllers.
+        void drainMotorCommands(CommandQueues &queues);
+        void drainServoCommands(CommandQueues &queues);
+        // End of a command-side tick: wakes whichever output task now has commands
+        // waiting in queues.
+        void wakeOutputTasks(const CommandQueues &queues);
+        // Command task: acts on a level the ladder has just moved to.
+        void applyHealthLevel();
+
+        // Encoder sampling and the velocity loop. At 1 kHz a wheel moves only a count
+        // or two per tick; 10 ms gives a usable speed estimate.
+        static constexpr uint32_t kVelocityPeriodUs = 10000;
+
+        static constexpr BaseType_t kMotorCore = 1;
+        static constexpr BaseType_t kCommandCore = 0;
+        static constexpr BaseType_t kServoCore = 0;
+        static constexpr BaseType_t kConsoleCore = 0;
+
+        // Motor task outranks everything so its tick is never late; command ingestion
+        // outranks the servo task so a slow I2C write never backs up the UART.
+        static constexpr UBaseType_t kMotorPriority = 5;
+        static constexpr UBaseType_t kCommandPriority = 4;
+        static constexpr UBaseType_t kServoPriority = 3;
+        static constexpr UBaseType_t kConsolePriority = 2;
+
+        static constexpr uint32_t kMotorStackBytes = 4096;
+        static constexpr uint32_t kCommandStackBytes = 6144;
+        static constexpr uint32_t kServoStackBytes = 4096;
+        static constexpr uint32_t kConsoleStackBytes = 6144;
+
+        inputs::UARTCommandInput &m_commandInput;
+        outputs::ServoController &m_servoController;
+        outputs::MotorController &m_motorController;
+        inputs::WheelEncoders &m_wheelEncoders;
+        CommandQueues &m_queues;
+        telemetry::TelemetryReporter &m_telemetryReporter;
+        LoopTiming &m_motorTiming;
+        diagnostics::Stats &m_stats;
+        HealthMonitor m_health;
+        // nullptr until attachConsole().
+        inputs::UARTCommandInput *m_consoleInput;
+        CommandQueues *m_consoleQueues;
+        telemetry::TelemetryReporter *m_consoleTelemetry;
+        bool m_started;
+        TaskHandle_t m_motorTask;
+        TaskHandle_t m_servoTask;
+        // Set by the motor task while it sleeps; the servo task only idles alongside it.
+        std::atomic<bool> m_motorIdle;
+        // Motor task only: start of the previous tick, and of the last velocity sample.
+        // After an idle wait the next tick is not a period, so it is not timed as one.
+        uint32_t m_lastMotorStart;
+        uint32_t m_lastMotorStartUs;
+        uint32_t m_lastVelocityUs;
+        bool m_motorResumed;
+        // Servo task only.
+        uint8_t m_flushFailuresInRow;
+        // LAT stamps applied by each output task and not yet seen on its pins, and the
+        // pulses the servo task last put on the bus.
+        diagnostics::PendingActuations m_motorActuations;
+        diagnostics::PendingActuations m_servoActuations;
+        uint16_t m_flushedPulseUs[outputs::ServoController::kServoCount] = {};
+    };
+
+} // namespace scheduler
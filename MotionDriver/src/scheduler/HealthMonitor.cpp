@@ -0,0 +1,236 @@
+#include "HealthMonitor.h"
+
+#include <esp_task_wdt.h>
+
+namespace scheduler
+{
+
+    namespace
+    {
+        const char *const kTaskNames[] = {"motor", "command", "servo"};
+        static_assert(sizeof(kTaskNames) / sizeof(kTaskNames[0]) == static_cast<size_t>(WatchedTask::Count),
+                      "One name per watched task");
+    }
+
+    HealthMonitor::HealthMonitor(diagnostics::Stats &stats)
+        : m_stats(stats),
+          m_level(static_cast<uint8_t>(HealthLevel::Normal)),
+          m_cause(static_cast<uint8_t>(HealthCause::None)),
+          m_windowStartMs(0),
+          m_seenMotorOverruns(0),
+          m_seenCommandOverruns(0),
+          m_seenServoOverruns(0),
+          m_seenI2cFailures(0),
+          m_i2cFailingWindows(0),
+          m_cleanWindows(0)
+    {
+        for (size_t index = 0; index < kTaskCount; ++index)
+        {
+            m_beatMs[index].store(0, std::memory_order_relaxed);
+            m_beaten[index].store(false, std::memory_order_relaxed);
+        }
+    }
+
+    bool HealthMonitor::beginWatchdog()
+    {
+        // The core has already started the watchdog for the idle tasks; this only
+        // changes its timeout and makes sure it panics, which resets the chip.
+        return esp_task_wdt_init(kWatchdogTimeoutS, true) == ESP_OK;
+    }
+
+    void HealthMonitor::watchCurrentTask()
+    {
+        esp_task_wdt_add(nullptr);
+    }
+
+    void HealthMonitor::beat(WatchedTask task, uint32_t nowMs)
+    {
+        const size_t index = static_cast<size_t>(task);
+        m_beatMs[index].store(nowMs, std::memory_order_relaxed);
+        m_beaten[index].store(true, std::memory_order_release);
+        esp_task_wdt_reset();
+    }
+
+    bool HealthMonitor::evaluate(uint32_t nowMs)
+    {
+        const HealthLevel before = level();
+
+        // A stalled output task stops the motors at once rather than at the window's
+        // end. A stalled command task cannot get here; that is the watchdog's.
+        HealthCause stall = HealthCause::None;
+        if (stalled(WatchedTask::Motor, nowMs))
+        {
+            stall = HealthCause::MotorStall;
+        }
+        else if (stalled(WatchedTask::Servo, nowMs))
+        {
+            stall = HealthCause::ServoStall;
+        }
+        if (stall != HealthCause::None)
+        {
+            raise(HealthLevel::MotorsStopped, stall);
+        }
+
+        if (nowMs - m_windowStartMs < kWindowMs)
+        {
+            return level() != before;
+        }
+        m_windowStartMs = nowMs;
+
+        diagnostics::Counters &counters = m_stats.counters();
+        const uint32_t motorOverruns = takeDelta(counters.motorOverruns, m_seenMotorOverruns);
+        const uint32_t overruns = motorOverruns + takeDelta(counters.commandOverruns, m_seenCommandOverruns) +
+                                  takeDelta(counters.servoOverruns, m_seenServoOverruns);
+        const uint32_t i2cFailures = takeDelta(counters.i2cFlushFailures, m_seenI2cFailures);
+        m_i2cFailingWindows = (i2cFailures != 0) ? m_i2cFailingWindows + 1 : 0;
+
+        if (motorOverruns >= kStopMotorsOverruns)
+        {
+            raise(HealthLevel::MotorsStopped, HealthCause::MotorOverruns);
+        }
+        if (m_i2cFailingWindows >= kStopMotorsI2cWindows)
+        {
+            raise(HealthLevel::MotorsStopped, HealthCause::I2cFailures);
+        }
+        if (i2cFailures >= kShedSweepsI2cFailures)
+        {
+            raise(HealthLevel::ShedSweeps, HealthCause::I2cFailures);
+        }
+        if (overruns >= kShedSweepsOverruns)
+        {
+            raise(HealthLevel::ShedSweeps, HealthCause::Overruns);
+        }
+        else if (overruns >= kShedTelemetryOverruns)
+        {
+            raise(HealthLevel::ShedTelemetry, HealthCause::Overruns);
+        }
+
+        const HealthLevel current = level();
+        if (overruns != 0 || i2cFailures != 0 || stall != HealthCause::None)
+        {
+            m_cleanWindows = 0;
+        }
+        else if (current != HealthLevel::Normal && ++m_cleanWindows >= kRecoveryWindows)
+        {
+            m_cleanWindows = 0;
+            const HealthLevel lower = static_cast<HealthLevel>(static_cast<uint8_t>(current) - 1);
+            if (lower == HealthLevel::Normal)
+            {
+                m_cause.store(static_cast<uint8_t>(HealthCause::None), std::memory_order_relaxed);
+            }
+            m_level.store(static_cast<uint8_t>(lower), std::memory_order_release);
+        }
+        return level() != before;
+    }
+
+    uint32_t HealthMonitor::heartbeatAgeMs(WatchedTask task, uint32_t nowMs) const
+    {
+        const size_t index = static_cast<size_t>(task);
+        if (!m_beaten[index].load(std::memory_order_acquire))
+        {
+            return UINT32_MAX;
+        }
+        return nowMs - m_beatMs[index].load(std::memory_order_relaxed);
+    }
+
+    void HealthMonitor::printLevel(Print &out) const
+    {
+        out.printf("HEALTH level=%s cause=%s\n", levelName(level()), causeName(cause()));
+    }
+
+    void HealthMonitor::print(Print &out, uint32_t nowMs) const
+    {
+        printLevel(out);
+        out.print("HEALTH beat_age_ms");
+        for (size_t index = 0; index < kTaskCount; ++index)
+        {
+            const uint32_t ageMs = heartbeatAgeMs(static_cast<WatchedTask>(index), nowMs);
+            if (ageMs == UINT32_MAX)
+            {
+                out.printf(" %s=-", kTaskNames[index]);
+            }
+            else
+            {
+                out.printf(" %s=%lu", kTaskNames[index], static_cast<unsigned long>(ageMs));
+            }
+        }
+        out.print('\n');
+    }
+
+    const char *HealthMonitor::levelName(HealthLevel level)
+    {
+        switch (level)
+        {
+        case HealthLevel::Normal:
+            return "normal";
+        case HealthLevel::ShedTelemetry:
+            return "shed_telemetry";
+        case HealthLevel::ShedSweeps:
+            return "shed_sweeps";
+        case HealthLevel::MotorsStopped:
+            return "motors_stopped";
+        }
+        return "?";
+    }
+
+    const char *HealthMonitor::causeName(HealthCause cause)
+    {
+        switch (cause)
+        {
+        case HealthCause::None:
+            return "none";
+        case HealthCause::Overruns:
+            return "overruns";
+        case HealthCause::I2cFailures:
+            return "i2c";
+        case HealthCause::MotorOverruns:
+            return "motor_overruns";
+        case HealthCause::MotorStall:
+            return "motor_stall";
+        case HealthCause::ServoStall:
+            return "servo_stall";
+        }
+        return "?";
+    }
+
+    bool HealthMonitor::stalled(WatchedTask task, uint32_t nowMs) const
+    {
+        const uint32_t ageMs = heartbeatAgeMs(task, nowMs);
+        return ageMs != UINT32_MAX && ageMs > kStallMs;
+    }
+
+    void HealthMonitor::raise(HealthLevel level, HealthCause cause)
+    {
+        m_cleanWindows = 0;
+        if (static_cast<uint8_t>(level) <= m_level.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        m_cause.store(static_cast<uint8_t>(cause), std::memory_order_relaxed);
+        m_level.store(static_cast<uint8_t>(level), std::memory_order_release);
+    }
+
+    uint32_t HealthMonitor::takeDelta(const std::atomic<uint32_t> &counter, uint32_t &seen)
+    {
+        const uint32_t now = counter.load(std::memory_order_relaxed);
+        const uint32_t delta = (now >= seen) ? now - seen : now;
+        seen = now;
+        return delta;
+    }
+
+    bool sheds(HealthLevel level, const MotorCommand &command)
+    {
+        // Stops still go through while the motors are held.
+        const bool stops = command.kind == MotorCommand::Kind::Stop || command.kind == MotorCommand::Kind::StopAll ||
+                           command.kind == MotorCommand::Kind::CalibrationAbort;
+        return level == HealthLevel::MotorsStopped && !stops;
+    }
+
+    bool sheds(HealthLevel level, const ServoCommand &command)
+    {
+        const bool startsSweep = command.enabled && (command.kind == ServoCommand::Kind::Sweep ||
+                                                     command.kind == ServoCommand::Kind::SweepRange);
+        return level >= HealthLevel::ShedSweeps && startsSweep;
+    }
+
+} // namespace scheduler
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+#include "diagnostics/Stats.h"
+#include "scheduler/Commands.h"
+
+namespace scheduler
+{
+
+    // The tasks with a heartbeat. The console has none: it runs below everything
+    // else, and a HELP dump stalled on its TX FIFO holds up nothing but itself.
+    enum class WatchedTask : uint8_t
+    {
+        Motor,
+        Command,
+        Servo,
+        Count
+    };
+
+    // The degradation ladder, mildest first. Each rung also sheds what the ones
+    // below it do:
+    //
+    //   ShedTelemetry  LOG samples stop, giving the command task and the link back
+    //   ShedSweeps     running SWEEPs stop where they stand and new ones are dropped
+    //   MotorsStopped  every motor stops, and motor commands other than stops are
+    //                  dropped until the level steps back down
+    enum class HealthLevel : uint8_t
+    {
+        Normal,
+        ShedTelemetry,
+        ShedSweeps,
+        MotorsStopped
+    };
+
+    // Whether the ladder drops a command at this level. The command task refuses it
+    // with ERR Shed; an output task drops any that was queued before the level rose.
+    bool sheds(HealthLevel level, const MotorCommand &command);
+    bool sheds(HealthLevel level, const ServoCommand &command);
+
+    // What last moved the level up.
+    enum class HealthCause : uint8_t
+    {
+        None,
+        Overruns,      // control periods overran across the tasks
+        I2cFailures,   // PCA9685 bursts failing
+        MotorOverruns, // the motor tick itself kept overrunning
+        MotorStall,    // no motor tick for kStallMs
+        ServoStall     // no servo tick for kStallMs
+    };
+
+    // Task heartbeats, the hardware task watchdog and the degradation ladder.
+    //
+    // Each watched task beats once per pass, which also feeds the task watchdog. The
+    // watchdog is the backstop: a task stuck for kWatchdogTimeoutS resets the chip.
+    // Short of that, the command task calls evaluate() every tick and moves the
+    // ladder on a stalled heartbeat (at once) and on each kWindowMs window's overrun
+    // and I2C failure counts, which the tasks keep in Stats. The ladder climbs as
+    // soon as a window calls for it and steps down one rung per kRecoveryWindows
+    // clean windows, so a fault that clears hands the rover back two seconds later.
+    //
+    // The command task is the level's only writer; any task reads it.
+    class HealthMonitor
+    {
+    public:
+        // Longer than anything a task blocks on by design: an idle wait, a HELP dump
+        // at 115200 (~1.2 s), or an NVS write.
+        static constexpr uint32_t kWatchdogTimeoutS = 3;
+        // Output tasks beat at least every kIdleWaitMs even when idle, plus a flush
+        // that times out and a bus recovery.
+        static constexpr uint32_t kStallMs = 500;
+
+        static constexpr uint32_t kWindowMs = 250;
+        // Overruns of any task in one window that shed telemetry, then sweeps.
+        static constexpr uint32_t kShedTelemetryOverruns = 2;
+        static constexpr uint32_t kShedSweepsOverruns = 8;
+        // A tenth of a window's motor ticks.
+        static constexpr uint32_t kStopMotorsOverruns = 25;
+        // Failed bursts in one window that shed sweeps, and how many windows in a row
+        // with any failure stop the motors: the steering is no longer answering.
+        static constexpr uint32_t kShedSweepsI2cFailures = 3;
+        static constexpr uint32_t kStopMotorsI2cWindows = 4;
+        static constexpr uint32_t kRecoveryWindows = 8;
+
+        explicit HealthMonitor(diagnostics::Stats &stats);
+
+        // Sets the task watchdog's timeout and makes it reset the chip. From
+        // ControlScheduler::begin(), before the tasks start.
+        static bool beginWatchdog();
+        // Subscribes the calling task: from here on it must beat at least every
+        // kWatchdogTimeoutS.
+        static void watchCurrentTask();
+
+        // Once per pass of a watched task, from that task.
+        void beat(WatchedTask task, uint32_t nowMs);
+
+        // Command task, once per tick. Returns true if the level changed.
+        bool evaluate(uint32_t nowMs);
+
+        HealthLevel level() const { return static_cast<HealthLevel>(m_level.load(std::memory_order_acquire)); }
+        HealthCause cause() const { return static_cast<HealthCause>(m_cause.load(std::memory_order_relaxed)); }
+        // UINT32_MAX for a task that has not beaten yet.
+        uint32_t heartbeatAgeMs(WatchedTask task, uint32_t nowMs) const;
+
+        // 'HEALTH level=.. cause=..', the line each port prints when the level changes.
+        void printLevel(Print &out) const;
+        // The level line, then each task's heartbeat age.
+        void print(Print &out, uint32_t nowMs) const;
+
+        static const char *levelName(HealthLevel level);
+        static const char *causeName(HealthCause cause);
+
+    private:
+        static constexpr size_t kTaskCount = static_cast<size_t>(WatchedTask::Count);
+
+        bool stalled(WatchedTask task, uint32_t nowMs) const;
+        void raise(HealthLevel level, HealthCause cause);
+        // Growth of a Stats counter since the last window; a STATS RESET in between
+        // counts from zero.
+        static uint32_t takeDelta(const std::atomic<uint32_t> &counter, uint32_t &seen);
+
+        diagnostics::Stats &m_stats;
+        std::atomic<uint32_t> m_beatMs[kTaskCount];
+        std::atomic<bool> m_beaten[kTaskCount];
+        std::atomic<uint8_t> m_level;
+        std::atomic<uint8_t> m_cause;
+        // Command task only.
+        uint32_t m_windowStartMs;
+        uint32_t m_seenMotorOverruns;
+        uint32_t m_seenCommandOverruns;
+        uint32_t m_seenServoOverruns;
+        uint32_t m_seenI2cFailures;
+        uint32_t m_i2cFailingWindows;
+        uint32_t m_cleanWindows;
+    };
+
+} // namespace scheduler
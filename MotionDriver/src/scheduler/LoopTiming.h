@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+namespace scheduler
+{
+
+    // Motor tick timing, written by the motor task and read from core 0. Each field is
+    // a single 32-bit atomic, so readers never see a torn value.
+    struct LoopTiming
+    {
+        // Time spent inside the last tick, and the worst since the
+        // telemetry reader last took it with exchange(0).
+        std::atomic<uint32_t> lastWorkUs{0};
+        std::atomic<uint32_t> maxWorkUs{0};
+        // Worst start-to-start interval, reset the same way; 1000 is on time.
+        std::atomic<uint32_t> maxPeriodUs{0};
+
+        void record(uint32_t workUs, uint32_t periodUs)
+        {
+            lastWorkUs.store(workUs, std::memory_order_relaxed);
+            raiseMax(maxWorkUs, workUs);
+            raiseMax(maxPeriodUs, periodUs);
+        }
+
+        // A compare-exchange rather than a load then a store, so a reader's
+        // exchange(0) landing in between is not overwritten with a stale maximum.
+        static void raiseMax(std::atomic<uint32_t> &max, uint32_t value)
+        {
+            uint32_t current = max.load(std::memory_order_relaxed);
+            while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+            {
+            }
+        }
+    };
+
+} // namespace scheduler
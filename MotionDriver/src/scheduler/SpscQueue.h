@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+
+namespace scheduler
+{
+
+    // Fixed-capacity, lock-free single-producer/single-consumer ring. Exactly one task
+    // may push and exactly one other task may pop; that is all the synchronisation it
+    // provides. One slot is kept empty to tell full from empty, so it holds
+    // Capacity - 1 items.
+    template <typename T, size_t Capacity>
+    class SpscQueue
+    {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        SpscQueue() : m_head(0), m_tail(0) {}
+
+        // Producer side. Returns false, leaving the queue untouched, when full.
+        bool push(const T &item)
+        {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            const size_t next = (head + 1) & kMask;
+            if (next == m_tail.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            m_items[head] = item;
+            m_head.store(next, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side. Returns false when empty.
+        bool pop(T &item)
+        {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail == m_head.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            item = m_items[tail];
+            m_tail.store((tail + 1) & kMask, std::memory_order_release);
+            return true;
+        }
+
+        // In-place variants for items too big to copy twice. The producer fills the slot
+        // returned by acquire() (nullptr when full) and publishes it with commit(); the
+        // consumer reads front() (nullptr when empty) and hands it back with release().
+        T *acquire()
+        {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            if (((head + 1) & kMask) == m_tail.load(std::memory_order_acquire))
+            {
+                return nullptr;
+            }
+            return &m_items[head];
+        }
+
+        void commit()
+        {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            m_head.store((head + 1) & kMask, std::memory_order_release);
+        }
+
+        T *front()
+        {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail == m_head.load(std::memory_order_acquire))
+            {
+                return nullptr;
+            }
+            return &m_items[tail];
+        }
+
+        void release()
+        {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            m_tail.store((tail + 1) & kMask, std::memory_order_release);
+        }
+
+        bool empty() const
+        {
+            return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire);
+        }
+
+    private:
+        static constexpr size_t kMask = Capacity - 1;
+
+        T m_items[Capacity];
+        std::atomic<size_t> m_head;
+        std::atomic<size_t> m_tail;
+    };
+
+} // namespace scheduler
@@ -0,0 +1,173 @@
+#include "TelemetryReporter.h"
+
+namespace telemetry
+{
+
+    namespace
+    {
+        uint16_t saturate16(uint32_t value)
+        {
+            return (value > 0xFFFFu) ? 0xFFFFu : static_cast<uint16_t>(value);
+        }
+
+        uint8_t *put16(uint8_t *out, uint16_t value)
+        {
+            out[0] = static_cast<uint8_t>(value & 0xFF);
+            out[1] = static_cast<uint8_t>(value >> 8);
+            return out + 2;
+        }
+
+        uint8_t *put32(uint8_t *out, uint32_t value)
+        {
+            out = put16(out, static_cast<uint16_t>(value & 0xFFFF));
+            return put16(out, static_cast<uint16_t>(value >> 16));
+        }
+    }
+
+    TelemetryReporter::TelemetryReporter(HardwareSerial &serial,
+                                         const outputs::ServoController &servoController,
+                                         const outputs::MotorController &motorController,
+                                         const inputs::WheelEncoders &wheelEncoders,
+                                         scheduler::LoopTiming &motorTiming)
+        : m_serial(serial),
+          m_servoController(servoController),
+          m_motorController(motorController),
+          m_wheelEncoders(wheelEncoders),
+          m_motorTiming(motorTiming),
+          m_rateHz(0),
+          m_periodMs(0),
+          m_lastSendMs(0),
+          m_skippedFrames(0)
+    {
+    }
+
+    void TelemetryReporter::setRateHz(uint16_t rateHz)
+    {
+        if (rateHz > kMaxRateHz)
+        {
+            rateHz = kMaxRateHz;
+        }
+        m_rateHz = rateHz;
+        m_periodMs = (rateHz == 0) ? 0 : 1000u / rateHz;
+    }
+
+    void TelemetryReporter::update(uint32_t nowMs, bool failsafeActive)
+    {
+        if (m_rateHz == 0 || (nowMs - m_lastSendMs) < m_periodMs)
+        {
+            return;
+        }
+        m_lastSendMs = nowMs;
+
+        // Never queue behind a reply: if a whole frame does not fit in the TX buffer
+        // right now, drop this sample and try again next period.
+        if (m_serial.availableForWrite() < static_cast<int>(kFrameLength))
+        {
+            ++m_skippedFrames;
+            return;
+        }
+
+        uint8_t frameBytes[kFrameLength];
+        const size_t length = encode(capture(nowMs, failsafeActive), frameBytes);
+        m_serial.write(frameBytes, length);
+
+        if (m_wheelEncoders.anyFitted())
+        {
+            sendOdometry(nowMs);
+        }
+    }
+
+    uint32_t TelemetryReporter::msUntilDue(uint32_t nowMs) const
+    {
+        if (m_rateHz == 0)
+        {
+            return UINT32_MAX;
+        }
+        const uint32_t elapsedMs = nowMs - m_lastSendMs;
+        return (elapsedMs >= m_periodMs) ? 0 : m_periodMs - elapsedMs;
+    }
+
+    void TelemetryReporter::sendOdometry(uint32_t nowMs)
+    {
+        if (m_serial.availableForWrite() < static_cast<int>(kOdometryFrameLength))
+        {
+            ++m_skippedFrames;
+            return;
+        }
+
+        uint8_t frameBytes[kOdometryFrameLength];
+        uint8_t *cursor = frameBytes;
+        *cursor++ = inputs::frame::kSync;
+        uint8_t *const crcStart = cursor;
+        *cursor++ = kOdometryOpcode;
+
+        cursor = put32(cursor, nowMs);
+        for (uint8_t wheel = 0; wheel < inputs::WheelEncoders::kWheelCount; ++wheel)
+        {
+            cursor = put32(cursor, static_cast<uint32_t>(m_wheelEncoders.count(wheel)));
+        }
+        for (uint8_t wheel = 0; wheel < inputs::WheelEncoders::kWheelCount; ++wheel)
+        {
+            float scaled = m_wheelEncoders.speedRadPerSec(wheel) * kOdometrySpeedScale;
+            scaled = (scaled > INT16_MAX) ? INT16_MAX : (scaled < -INT16_MAX) ? -INT16_MAX : scaled;
+            cursor = put16(cursor, static_cast<uint16_t>(static_cast<int16_t>(scaled)));
+        }
+        *cursor++ = m_wheelEncoders.fittedMask();
+
+        *cursor = inputs::frame::crc8(crcStart, static_cast<size_t>(cursor - crcStart));
+        ++cursor;
+        m_serial.write(frameBytes, static_cast<size_t>(cursor - frameBytes));
+    }
+
+    TelemetryReporter::Snapshot TelemetryReporter::capture(uint32_t nowMs, bool failsafeActive)
+    {
+        // Read across cores without a lock: every field is a single aligned word, so a
+        // sample may mix two adjacent motor ticks but never holds a torn value.
+        Snapshot snapshot{};
+        snapshot.timestampMs = nowMs;
+        for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
+        {
+            snapshot.motorSpeed[index] = m_motorController.currentSpeedQ15(index);
+            snapshot.motorTarget[index] = m_motorController.targetSpeedQ15(index);
+        }
+        for (uint8_t channel = 0; channel < outputs::ServoController::kServoCount; ++channel)
+        {
+            snapshot.servoPulseUs[channel] = m_servoController.currentPulseUs(channel);
+        }
+        snapshot.motorTickWorkUs = saturate16(m_motorTiming.maxWorkUs.exchange(0, std::memory_order_relaxed));
+        snapshot.motorTickPeriodUs = saturate16(m_motorTiming.maxPeriodUs.exchange(0, std::memory_order_relaxed));
+        snapshot.flags = (m_motorController.driverEnabled() ? kFlagDriverEnabled : 0) |
+                         (failsafeActive ? kFlagFailsafeActive : 0);
+        return snapshot;
+    }
+
+    size_t TelemetryReporter::encode(const Snapshot &snapshot, uint8_t *out)
+    {
+        uint8_t *cursor = out;
+        *cursor++ = inputs::frame::kSync;
+        uint8_t *const crcStart = cursor;
+        *cursor++ = kTelemetryOpcode;
+
+        cursor = put32(cursor, snapshot.timestampMs);
+        for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
+        {
+            cursor = put16(cursor, static_cast<uint16_t>(snapshot.motorSpeed[index]));
+        }
+        for (uint8_t index = 0; index < outputs::MotorController::kMotorCount; ++index)
+        {
+            cursor = put16(cursor, static_cast<uint16_t>(snapshot.motorTarget[index]));
+        }
+        for (uint8_t channel = 0; channel < outputs::ServoController::kServoCount; ++channel)
+        {
+            cursor = put16(cursor, snapshot.servoPulseUs[channel]);
+        }
+        cursor = put16(cursor, snapshot.motorTickWorkUs);
+        cursor = put16(cursor, snapshot.motorTickPeriodUs);
+        *cursor++ = snapshot.flags;
+
+        *cursor = inputs::frame::crc8(crcStart, static_cast<size_t>(cursor - crcStart));
+        ++cursor;
+        return static_cast<size_t>(cursor - out);
+    }
+
+} // namespace telemetry
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "inputs/BinaryFrame.h"
+#include "inputs/WheelEncoders.h"
+#include "outputs/MotorController.h"
+#include "outputs/ServoController.h"
+#include "scheduler/LoopTiming.h"
+
+namespace telemetry
+{
+
+    // Periodic binary state snapshot, sent with the same framing as inbound commands:
+    //
+    //     [0xA5] [kTelemetryOpcode] [Snapshot, kPayloadLength bytes] [crc8]
+    //
+    // When any wheel encoder is fitted, each sample is followed by an odometry frame:
+    //
+    //     [0xA5] [kOdometryOpcode] [kOdometryPayloadLength bytes] [crc8]
+    //
+    // Runs on the command task after input has been handled, and only ever writes when
+    // the TX buffer already has room for a whole frame, so it can skip a sample but
+    // can never block, or delay a command reply behind itself.
+    class TelemetryReporter
+    {
+    public:
+        static constexpr uint8_t kTelemetryOpcode = 0x80;
+        static constexpr uint8_t kOdometryOpcode = 0x81;
+        static constexpr uint16_t kDefaultRateHz = 10;
+        static constexpr uint16_t kMaxRateHz = 50;
+
+        // Field order on the wire; all little-endian. Speeds are signed Q15.
+        struct Snapshot
+        {
+            uint32_t timestampMs;
+            int16_t motorSpeed[outputs::MotorController::kMotorCount];  // ramped
+            int16_t motorTarget[outputs::MotorController::kMotorCount]; // effective target
+            uint16_t servoPulseUs[outputs::ServoController::kServoCount];
+            uint16_t motorTickWorkUs;    // worst in this sample window
+            uint16_t motorTickPeriodUs;  // worst in this sample window
+            uint8_t flags;               // kFlag* below
+        };
+
+        static constexpr uint8_t kFlagDriverEnabled = 0x01;
+        static constexpr uint8_t kFlagFailsafeActive = 0x02;
+
+        static constexpr size_t kPayloadLength = 4 + 2 * outputs::MotorController::kMotorCount * 2 +
+                                                 2 * outputs::ServoController::kServoCount + 2 + 2 + 1;
+        static constexpr size_t kFrameLength = 1 + 1 + kPayloadLength + 1;
+
+        // Odometry: u32 timestamp, i32 counts x6 (forward-positive, since boot), i16
+        // speed x6 in 0.01 rad/s, u8 mask of fitted wheels. Unfitted wheels read 0.
+        static constexpr size_t kOdometryPayloadLength = 4 + 4 * inputs::WheelEncoders::kWheelCount +
+                                                         2 * inputs::WheelEncoders::kWheelCount + 1;
+        static constexpr size_t kOdometryFrameLength = 1 + 1 + kOdometryPayloadLength + 1;
+        static constexpr float kOdometrySpeedScale = 100.0f;
+
+        TelemetryReporter(HardwareSerial &serial,
+                          const outputs::ServoController &servoController,
+                          const outputs::MotorController &motorController,
+                          const inputs::WheelEncoders &wheelEncoders,
+                          scheduler::LoopTiming &motorTiming);
+
+        // 0 disables the stream.
+        void setRateHz(uint16_t rateHz);
+        uint16_t rateHz() const { return m_rateHz; }
+        uint32_t skippedFrames() const { return m_skippedFrames; }
+        void resetSkippedFrames() { m_skippedFrames = 0; }
+
+        void update(uint32_t nowMs, bool failsafeActive);
+        // How long until update() next has a sample to send: 0 if one is due now,
+        // UINT32_MAX while the stream is off. The command task sleeps at most this.
+        uint32_t msUntilDue(uint32_t nowMs) const;
+
+    private:
+        Snapshot capture(uint32_t nowMs, bool failsafeActive);
+        static size_t encode(const Snapshot &snapshot, uint8_t *out);
+        void sendOdometry(uint32_t nowMs);
+
+        HardwareSerial &m_serial;
+        const outputs::ServoController &m_servoController;
+        const outputs::MotorController &m_motorController;
+        const inputs::WheelEncoders &m_wheelEncoders;
+        scheduler::LoopTiming &m_motorTiming;
+        uint16_t m_rateHz;
+        uint32_t m_periodMs;
+        uint32_t m_lastSendMs;
+        uint32_t m_skippedFrames;
+    };
+
+} // namespace telemetry
@@ -0,0 +1,628 @@
+// Host benchmarks for the firmware logic, built against lib/NativeHal:
+//
+//   pio test -e native -v
+//
+// Each benchmark prints one 'BENCH <name> n=.. min=.. p50=.. p99=.. max=..' line
+// (the STATS layout). Times are host nanoseconds, so compare runs on the same
+// machine: run before and after a protocol or scheduler change. Latencies from the
+// traffic replay are simulated microseconds and do not depend on the host.
+
+#include <unity.h>
+
+#include <NativeHal.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "outputs/MotorController.h"
+#include "outputs/ServoController.h"
+#include "replay/Capture.h"
+#include "replay/Player.h"
+#include "scheduler/Commands.h"
+#include "scheduler/ControlScheduler.h"
+#include "scheduler/HealthMonitor.h"
+
+namespace
+{
+    constexpr char kTeleopTraffic[] =
+#include "traffic/teleop_session.txt"
+        ;
+
+    constexpr unsigned long kBaudRate = replay::kBaudRate;
+    constexpr size_t kWarmupIterations = 1000;
+    constexpr size_t kIterations = 20000;
+
+    // What the bridge sends per wheel while driving; the speed is a full Python float.
+    const char *const kMotorLines[] = {
+        "MOTOR 0 FORWARD 0.4823529411764706\n",
+        "MOTOR 1 FORWARD 0.4823529411764706\n",
+        "MOTOR 2 BACKWARD 0.25\n",
+        "MOTOR 3 FORWARD 1.0\n",
+        "MOTOR 4 STOP\n",
+        "MOTOR 5 FORWARD 0.6\n",
+    };
+
+    // MotorController gives motor m the LEDC channel pair 2m, 2m+1.
+    constexpr uint8_t kLedcChannelsPerMotor = 2;
+
+    using Clock = std::chrono::steady_clock;
+
+    double elapsedNs(Clock::time_point start, Clock::time_point end)
+    {
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    void report(const char *name, std::vector<double> &samples, const char *unit)
+    {
+        TEST_ASSERT_FALSE_MESSAGE(samples.empty(), name);
+        std::sort(samples.begin(), samples.end());
+        const size_t count = samples.size();
+        const double p50 = samples[(count - 1) / 2];
+        const double p99 = samples[std::min(count - 1, (count * 99 + 99) / 100 - 1)];
+        printf("BENCH %s n=%zu min_%s=%.0f p50_%s=%.0f p99_%s=%.0f max_%s=%.0f\n", name, count, unit,
+               samples.front(), unit, p50, unit, p99, unit, samples.back());
+    }
+
+    std::unique_ptr<replay::Rig> makeRig()
+    {
+        auto rig = std::make_unique<replay::Rig>();
+        TEST_ASSERT_TRUE(rig->begin());
+        return rig;
+    }
+
+    void drainMotorQueue(replay::Rig &rig)
+    {
+        scheduler::MotorCommand command;
+        while (rig.queues.motor.pop(command))
+        {
+        }
+    }
+
+    std::string transmittedText()
+    {
+        const std::vector<uint8_t> bytes = Serial.takeTransmitted();
+        return std::string(bytes.begin(), bytes.end());
+    }
+
+    bool hasTelemetryFrame(const std::string &bytes)
+    {
+        const char header[] = {static_cast<char>(inputs::frame::kSync),
+                               static_cast<char>(telemetry::TelemetryReporter::kTelemetryOpcode)};
+        return bytes.find(std::string(header, sizeof(header))) != std::string::npos;
+    }
+
+    bool anyMotorTargeted(const replay::Rig &rig)
+    {
+        for (uint8_t motor = 0; motor < outputs::MotorController::kMotorCount; ++motor)
+        {
+            if (rig.motors.targetSpeedQ15(motor) != 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // One pass of each task at nowUs, with the servo task optionally left out.
+    void tickAll(replay::Rig &rig, uint64_t nowUs, bool servo = true)
+    {
+        hal::setMicros(nowUs);
+        rig.scheduler.commandTick();
+        rig.scheduler.motorTick();
+        if (servo)
+        {
+            rig.scheduler.servoTick();
+        }
+    }
+
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// Cost of one MOTOR line: framing it on the receive side (the UART event task on the
+// ESP32), then poll() parsing it, queueing the command and replying OK.
+void test_parse_motor_line()
+{
+    auto rig = makeRig();
+    std::vector<double> receiveNs;
+    std::vector<double> parseNs;
+    receiveNs.reserve(kIterations);
+    parseNs.reserve(kIterations);
+
+    for (size_t iteration = 0; iteration < kWarmupIterations + kIterations; ++iteration)
+    {
+        const char *line = kMotorLines[iteration % (sizeof(kMotorLines) / sizeof(kMotorLines[0]))];
+        const Clock::time_point start = Clock::now();
+        Serial.simulateReceive(line);
+        const Clock::time_point framed = Clock::now();
+        rig->input.poll();
+        const Clock::time_point parsed = Clock::now();
+
+        TEST_ASSERT_EQUAL_STRING("OK\r\n", transmittedText().c_str());
+        drainMotorQueue(*rig);
+        if (iteration >= kWarmupIterations)
+        {
+            receiveNs.push_back(elapsedNs(start, framed));
+            parseNs.push_back(elapsedNs(framed, parsed));
+        }
+    }
+
+    report("motor_line_receive", receiveNs, "ns");
+    report("motor_line_parse", parseNs, "ns");
+}
+
+// MotorController::update() with all six wheels reversing (ramp stepping, LEDC
+// writes every tick) and then settled (the common idle case).
+void test_motor_update()
+{
+    auto rig = makeRig();
+    constexpr uint32_t kReverseEveryMs = 700;
+    std::vector<double> rampingNs;
+    std::vector<double> settledNs;
+    rampingNs.reserve(kIterations);
+    settledNs.reserve(kIterations);
+
+    for (size_t tick = 0; tick < kWarmupIterations + kIterations; ++tick)
+    {
+        if (tick % kReverseEveryMs == 0)
+        {
+            const float speed = ((tick / kReverseEveryMs) % 2 == 0) ? 1.0f : -1.0f;
+            const float targets[outputs::MotorController::kMotorCount] = {speed, speed, speed, speed, speed, speed};
+            rig->motors.setTargets(targets);
+        }
+        hal::advanceMicros(1000);
+        const Clock::time_point start = Clock::now();
+        rig->motors.update(millis());
+        const Clock::time_point end = Clock::now();
+        if (tick >= kWarmupIterations)
+        {
+            rampingNs.push_back(elapsedNs(start, end));
+        }
+    }
+
+    const float cruise[outputs::MotorController::kMotorCount] = {0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f};
+    rig->motors.setTargets(cruise);
+    for (size_t tick = 0; tick < 2000; ++tick)
+    {
+        hal::advanceMicros(1000);
+        rig->motors.update(millis());
+    }
+    for (size_t tick = 0; tick < kIterations; ++tick)
+    {
+        hal::advanceMicros(1000);
+        const Clock::time_point start = Clock::now();
+        rig->motors.update(millis());
+        settledNs.push_back(elapsedNs(start, Clock::now()));
+    }
+    TEST_ASSERT_EQUAL_INT16(rig->motors.targetSpeedQ15(0), rig->motors.currentSpeedQ15(0));
+
+    report("motor_update_ramping", rampingNs, "ns");
+    report("motor_update_settled", settledNs, "ns");
+}
+
+// Replays captured Pi traffic through the real task bodies on the simulated clock.
+// A command's latency runs from its last byte landing (at the capture's send time
+// plus its time on the wire) to the first PWM change it causes: an LEDC duty change
+// for a motor, a flushed I2C burst for a servo. Only commands that land on a
+// settled output are counted, so a change can't be credited to an earlier ramp.
+void test_replay_command_to_pwm_latency()
+{
+    auto rig = makeRig();
+    rig->stats.actuation().setEnabled(true);
+    const replay::Capture capture = replay::parseCapture(kTeleopTraffic);
+    const std::vector<replay::Unit> &traffic = capture.units;
+    TEST_ASSERT_FALSE(traffic.empty());
+
+    constexpr uint64_t kNone = UINT64_MAX;
+    constexpr uint8_t kMotorCount = outputs::MotorController::kMotorCount;
+    constexpr uint8_t kServoCount = outputs::ServoController::kServoCount;
+    uint64_t motorPendingSince[kMotorCount];
+    uint64_t servoPendingSince[kServoCount];
+    uint16_t servoPulseAtArrival[kServoCount] = {};
+    std::fill(std::begin(motorPendingSince), std::end(motorPendingSince), kNone);
+    std::fill(std::begin(servoPendingSince), std::end(servoPendingSince), kNone);
+
+    std::vector<double> motorLatencyUs;
+    std::vector<double> servoLatencyUs;
+    std::vector<double> commandTickNs;
+    std::vector<double> motorTickNs;
+    size_t errors = 0;
+
+    const double byteUs = replay::byteTimeUs(kBaudRate);
+    double wireFreeAtUs = 0.0;
+    size_t next = 0;
+    const uint64_t endUs = traffic.back().atUs + replay::kSettleUs;
+
+    for (uint64_t nowUs = 0; nowUs <= endUs; nowUs += replay::kStepUs)
+    {
+        hal::setMicros(nowUs);
+
+        while (next < traffic.size())
+        {
+            const replay::Unit &entry = traffic[next];
+            const double startUs = std::max(wireFreeAtUs, static_cast<double>(entry.atUs));
+            const double landedUs = startUs + byteUs * static_cast<double>(entry.bytes.size());
+            if (landedUs > static_cast<double>(nowUs))
+            {
+                break;
+            }
+            wireFreeAtUs = landedUs;
+            ++next;
+
+            unsigned index = 0;
+            if (sscanf(entry.bytes.c_str(), "MOTOR %u", &index) == 1 && index < kMotorCount)
+            {
+                const bool settled = rig->motors.currentSpeedQ15(index) == rig->motors.targetSpeedQ15(index);
+                motorPendingSince[index] = settled ? static_cast<uint64_t>(landedUs) : kNone;
+            }
+            else if (sscanf(entry.bytes.c_str(), "S %u", &index) == 1 && index < kServoCount)
+            {
+                const bool settled = rig->servos.currentPulseUs(index) == rig->servos.targetPulseUs(index);
+                servoPendingSince[index] = settled ? static_cast<uint64_t>(landedUs) : kNone;
+                servoPulseAtArrival[index] = rig->servos.currentPulseUs(index);
+            }
+            Serial.simulateReceive(entry.bytes.c_str());
+        }
+
+        const uint32_t phaseUs = static_cast<uint32_t>(nowUs % 1000u);
+        if (phaseUs == replay::kCommandPhaseUs)
+        {
+            const Clock::time_point start = Clock::now();
+            rig->scheduler.commandTick();
+            commandTickNs.push_back(elapsedNs(start, Clock::now()));
+        }
+        if (phaseUs == replay::kMotorPhaseUs)
+        {
+            const Clock::time_point start = Clock::now();
+            rig->scheduler.motorTick();
+            motorTickNs.push_back(elapsedNs(start, Clock::now()));
+
+            for (uint8_t motor = 0; motor < kMotorCount; ++motor)
+            {
+                if (motorPendingSince[motor] == kNone)
+                {
+                    continue;
+                }
+                const uint8_t channel = motor * kLedcChannelsPerMotor;
+                const uint64_t changedAt =
+                    std::max(hal::ledcChangedAtMicros(channel), hal::ledcChangedAtMicros(channel + 1));
+                if (changedAt >= motorPendingSince[motor])
+                {
+                    motorLatencyUs.push_back(static_cast<double>(changedAt - motorPendingSince[motor]));
+                    motorPendingSince[motor] = kNone;
+                }
+            }
+        }
+        if (nowUs % (scheduler::ControlScheduler::kServoPeriodMs * 1000u) == replay::kServoPhaseUs)
+        {
+            const uint32_t burstsBefore = hal::i2cTransactions();
+            rig->scheduler.servoTick();
+            if (hal::i2cTransactions() != burstsBefore)
+            {
+                for (uint8_t channel = 0; channel < kServoCount; ++channel)
+                {
+                    if (servoPendingSince[channel] != kNone &&
+                        rig->servos.currentPulseUs(channel) != servoPulseAtArrival[channel])
+                    {
+                        servoLatencyUs.push_back(static_cast<double>(nowUs - servoPendingSince[channel]));
+                        servoPendingSince[channel] = kNone;
+                    }
+                }
+            }
+        }
+
+        const std::string replies = transmittedText();
+        for (size_t found = replies.find("ERR"); found != std::string::npos; found = replies.find("ERR", found + 1))
+        {
+            ++errors;
+        }
+    }
+
+    TEST_ASSERT_EQUAL_size_t(traffic.size(), next);
+    TEST_ASSERT_EQUAL_size_t(0, errors);
+    TEST_ASSERT_FALSE(rig->input.failsafeActive());
+
+    report("replay_motor_latency", motorLatencyUs, "us");
+    report("replay_servo_latency", servoLatencyUs, "us");
+    report("replay_command_tick", commandTickNs, "ns");
+    report("replay_motor_tick", motorTickNs, "ns");
+
+    // The firmware's own LAT view of the same run. It stamps each line as it is
+    // framed, which the harness does on the landing step, so the two should agree
+    // to within a bucket.
+    rig->stats.actuation().print(Serial);
+    const std::string latency = transmittedText();
+    printf("%s", latency.c_str());
+    TEST_ASSERT_TRUE(latency.find("rx_to_motor_pwm n=0 ") == std::string::npos);
+    TEST_ASSERT_TRUE(latency.find("rx_to_servo_pwm n=0 ") == std::string::npos);
+}
+
+// RECORD DUMP round trip. The control link's record of a replay is itself a
+// capture; replayed on a fresh rig, it records the same units at the same
+// relative times, so a field dump reproduces what the rover received.
+void test_record_dump_replays_identically()
+{
+    const replay::Capture session = replay::parseCapture(kTeleopTraffic);
+    auto first = makeRig();
+    replay::Player original(*first, session, kBaudRate);
+    while (!original.finished())
+    {
+        original.step();
+    }
+    Serial.takeTransmitted();
+    first->log.dump(Serial);
+    const std::string firstDump = transmittedText();
+
+    const replay::Capture recorded = replay::parseCapture(firstDump.c_str());
+    TEST_ASSERT_EQUAL_size_t(first->log.entryCount(), recorded.units.size());
+    TEST_ASSERT_EQUAL_size_t(0, recorded.malformed);
+    // The ring keeps the newest units, byte for byte.
+    const size_t skipped = session.units.size() - recorded.units.size();
+    for (size_t index = 0; index < recorded.units.size(); ++index)
+    {
+        TEST_ASSERT_EQUAL_STRING(session.units[skipped + index].bytes.c_str(), recorded.units[index].bytes.c_str());
+    }
+
+    auto second = makeRig();
+    replay::Player again(*second, recorded);
+    while (!again.finished())
+    {
+        again.step();
+    }
+    Serial.takeTransmitted();
+    second->log.dump(Serial);
+    const std::string secondDump = transmittedText();
+
+    // Past the '# RECORD' header, whose overwritten count differs.
+    const auto rows = [](const std::string &dump) { return dump.substr(dump.find('\n') + 1); };
+    TEST_ASSERT_EQUAL_STRING(rows(firstDump).c_str(), rows(secondDump).c_str());
+    printf("RECORD entries=%lu overwritten=%lu of %zu units\n", static_cast<unsigned long>(first->log.entryCount()),
+           static_cast<unsigned long>(first->log.overwritten()), session.units.size());
+}
+
+// A PCA9685 bus that stops answering climbs the ladder: sweeps are shed, the bus is
+// clocked free and re-initialised, and once it has failed for a second the motors
+// stop. When it answers again the ladder steps back down, a rung at a time.
+void test_i2c_fault_degrades_and_recovers()
+{
+    using scheduler::HealthLevel;
+    using scheduler::HealthMonitor;
+
+    std::string traffic = "0 SWEEP ON\n0 LOG ON 20\n";
+    for (uint32_t ms = 100; ms <= 11000; ms += 100)
+    {
+        traffic += std::to_string(ms) + " PING\n";
+    }
+    // Refused behind the held stop, then honoured once the ladder is back down.
+    traffic += "2600 MOTOR ALL FORWARD 0.5\n10500 MOTOR ALL FORWARD 0.5\n";
+    replay::Capture capture = replay::parseCapture(traffic.c_str());
+    std::stable_sort(capture.units.begin(), capture.units.end(),
+                     [](const replay::Unit &a, const replay::Unit &b) { return a.atUs < b.atUs; });
+
+    auto rig = makeRig();
+    replay::Player player(*rig, capture);
+    const auto runUntil = [&](uint64_t untilUs)
+    {
+        std::string transmitted;
+        while (player.nowUs() < untilUs)
+        {
+            player.step();
+            transmitted += transmittedText();
+        }
+        return transmitted;
+    };
+    const HealthMonitor &health = rig->scheduler.health();
+
+    const std::string healthy = runUntil(1000000);
+    TEST_ASSERT_TRUE(health.level() == HealthLevel::Normal);
+    TEST_ASSERT_TRUE(rig->servos.sweeping());
+    TEST_ASSERT_TRUE(hasTelemetryFrame(healthy));
+
+    hal::setI2cFailing(true);
+    const std::string failing = runUntil(2400000);
+    TEST_ASSERT_TRUE(failing.find("HEALTH level=shed_sweeps cause=i2c") != std::string::npos);
+    TEST_ASSERT_TRUE(failing.find("HEALTH level=motors_stopped cause=i2c") != std::string::npos);
+    TEST_ASSERT_FALSE(rig->servos.sweeping());
+    TEST_ASSERT_TRUE(rig->stats.counters().i2cRecoveries.load() > 0);
+
+    const std::string held = runUntil(3000000);
+    TEST_ASSERT_TRUE(health.level() == HealthLevel::MotorsStopped);
+    TEST_ASSERT_FALSE(anyMotorTargeted(*rig));
+    TEST_ASSERT_TRUE(rig->stats.counters().shedCommands.load() > 0);
+    TEST_ASSERT_FALSE(hasTelemetryFrame(held));
+
+    // A clean window every kWindowMs; kRecoveryWindows of them per rung.
+    hal::setI2cFailing(false);
+    const uint64_t rungUs = static_cast<uint64_t>(HealthMonitor::kWindowMs) * HealthMonitor::kRecoveryWindows * 1000;
+    const std::string recovering = runUntil(3000000 + 3 * rungUs + 500000);
+    TEST_ASSERT_TRUE(recovering.find("HEALTH level=shed_sweeps") != std::string::npos);
+    TEST_ASSERT_TRUE(recovering.find("HEALTH level=shed_telemetry") != std::string::npos);
+    TEST_ASSERT_TRUE(recovering.find("HEALTH level=normal cause=none") != std::string::npos);
+    TEST_ASSERT_TRUE(health.level() == HealthLevel::Normal);
+
+    const std::string recovered = runUntil(11000000);
+    TEST_ASSERT_TRUE(anyMotorTargeted(*rig));
+    TEST_ASSERT_TRUE(hasTelemetryFrame(recovered));
+    TEST_ASSERT_TRUE(recovered.find("ERR") == std::string::npos);
+}
+
+// The motor tick running late for most of a window stops the motors, and motor
+// commands are refused until it steps down; an output task that stops beating
+// altogether stops them too.
+void test_overruns_and_stalls_stop_motors()
+{
+    using scheduler::HealthLevel;
+
+    auto rig = makeRig();
+    Serial.simulateReceive("MOTOR ALL FORWARD 0.5\n");
+    uint64_t nowUs = 0;
+    // Three milliseconds between motor ticks: every one of them late.
+    for (; nowUs < 300000; nowUs += 3000)
+    {
+        tickAll(*rig, nowUs);
+    }
+    tickAll(*rig, nowUs);
+    std::string replies = transmittedText();
+    TEST_ASSERT_TRUE(replies.find("HEALTH level=motors_stopped cause=motor_overruns") != std::string::npos);
+    TEST_ASSERT_FALSE(anyMotorTargeted(*rig));
+    TEST_ASSERT_TRUE(rig->stats.counters().motorOverruns.load() >= scheduler::HealthMonitor::kStopMotorsOverruns);
+
+    Serial.simulateReceive("HEALTH\n");
+    tickAll(*rig, nowUs += 1000);
+    replies = transmittedText();
+    // The command task runs first in a pass, so the output tasks last beat 1 ms ago.
+    TEST_ASSERT_TRUE(replies.find("HEALTH level=motors_stopped cause=motor_overruns\n"
+                                  "HEALTH beat_age_ms motor=1 command=0 servo=1\nOK") != std::string::npos);
+
+    // Held: a drive is refused rather than acknowledged and dropped; a stop still runs.
+    Serial.simulateReceive("MOTOR ALL FORWARD 0.5\nMOTOR ALL STOP\n");
+    tickAll(*rig, nowUs += 1000);
+    replies = transmittedText();
+    TEST_ASSERT_TRUE(replies.find("ERR Shed\r\nOK\r\n") != std::string::npos);
+    TEST_ASSERT_FALSE(anyMotorTargeted(*rig));
+
+    // A fresh rig: a servo task that stops beating with the motors running.
+    rig = makeRig();
+    Serial.simulateReceive("MOTOR ALL FORWARD 0.5\n");
+    for (nowUs = 0; nowUs < 100000; nowUs += 1000)
+    {
+        tickAll(*rig, nowUs);
+    }
+    TEST_ASSERT_TRUE(anyMotorTargeted(*rig));
+    for (; nowUs < 100000 + (scheduler::HealthMonitor::kStallMs + 10) * 1000; nowUs += 1000)
+    {
+        tickAll(*rig, nowUs, false);
+    }
+    tickAll(*rig, nowUs, false);
+    replies = transmittedText();
+    TEST_ASSERT_TRUE(replies.find("HEALTH level=motors_stopped cause=servo_stall") != std::string::npos);
+    TEST_ASSERT_FALSE(anyMotorTargeted(*rig));
+}
+
+// STEER scales the speeds the wheels are running at; the next DRIVE sets plain
+// speeds again rather than being scaled by the last turn.
+void test_steer_scaling_ends_at_the_next_drive()
+{
+    auto rig = makeRig();
+    uint64_t nowUs = 0;
+    Serial.simulateReceive("MOTOR ALL FORWARD 0.5\n");
+    tickAll(*rig, nowUs += 1000);
+    Serial.simulateReceive("STEER 0.4\n");
+    tickAll(*rig, nowUs += 1000);
+    TEST_ASSERT_TRUE(rig->motors.targetSpeedQ15(0) != rig->motors.targetSpeedQ15(1));
+
+    Serial.simulateReceive("DRIVE 0.5 0.5 0.5 0.5 0.5 0.5\n");
+    tickAll(*rig, nowUs += 1000);
+    for (uint8_t motor = 0; motor < outputs::MotorController::kMotorCount; ++motor)
+    {
+        TEST_ASSERT_EQUAL_INT16(16384, rig->motors.targetSpeedQ15(motor));
+    }
+    TEST_ASSERT_TRUE(transmittedText().find("ERR") == std::string::npos);
+}
+
+// STATS RESET and LAT RESET read as zeroed straight away, even for a stage or path
+// that has not run since: a histogram only clears on its owning task's next sample.
+void test_stats_and_lat_reset_read_empty_at_once()
+{
+    auto rig = makeRig();
+    uint64_t nowUs = 0;
+    Serial.simulateReceive("LAT ON\n");
+    tickAll(*rig, nowUs);
+    Serial.simulateReceive("MOTOR ALL FORWARD 0.5\nS 0 1600\n");
+    for (nowUs += 1000; nowUs < 50000; nowUs += 1000)
+    {
+        tickAll(*rig, nowUs);
+    }
+    Serial.takeTransmitted();
+
+    Serial.simulateReceive("STATS RESET\nSTATS\nLAT RESET\nLAT\n");
+    rig->scheduler.commandTick();
+    const std::string replies = transmittedText();
+    TEST_ASSERT_TRUE(replies.find("STAGE motor_tick n=0 ") != std::string::npos);
+    TEST_ASSERT_TRUE(replies.find("STAGE servo_update n=0 ") != std::string::npos);
+    TEST_ASSERT_TRUE(replies.find("STAGE i2c_flush n=0 ") != std::string::npos);
+    TEST_ASSERT_TRUE(replies.find("LAT rx_to_motor_pwm n=0 ") != std::string::npos);
+    TEST_ASSERT_TRUE(replies.find("LAT rx_to_servo_pwm n=0 ") != std::string::npos);
+
+    tickAll(*rig, nowUs);
+    Serial.simulateReceive("STATS\n");
+    rig->scheduler.commandTick();
+    TEST_ASSERT_TRUE(transmittedText().find("STAGE motor_tick n=1 ") != std::string::npos);
+}
+
+// An E-STOP cuts STBY from the receive side before the motor task runs its stop. A
+// command the motor task applies in between must not raise STBY behind the cut.
+void test_driver_cut_holds_until_stop_all()
+{
+    auto rig = makeRig();
+    uint64_t nowUs = 0;
+    Serial.simulateReceive("MOTOR ALL FORWARD 0.5\n");
+    hal::setMicros(nowUs += 1000);
+    rig->scheduler.commandTick();
+    TEST_ASSERT_FALSE(rig->motors.driverEnabled());
+
+    rig->motors.cutDrivers();
+    rig->scheduler.motorTick();
+    TEST_ASSERT_FALSE(rig->motors.driverEnabled());
+    TEST_ASSERT_TRUE(digitalRead(PIN_DRV_STBY) == LOW);
+
+    // The stop that answers the cut; the next command wakes the drivers again.
+    rig->queues.stopAllPending.store(true);
+    tickAll(*rig, nowUs += 1000);
+    TEST_ASSERT_FALSE(anyMotorTargeted(*rig));
+    Serial.simulateReceive("MOTOR ALL FORWARD 0.5\n");
+    tickAll(*rig, nowUs += 1000);
+    TEST_ASSERT_TRUE(rig->motors.driverEnabled());
+    TEST_ASSERT_TRUE(digitalRead(PIN_DRV_STBY) == HIGH);
+}
+
+// ACK mode folds tagged lines into ACK <seq>; a binary frame has no tag, so it
+// keeps its OK rather than succeeding silently.
+void test_ack_mode_still_replies_to_frames()
+{
+    auto rig = makeRig();
+    uint64_t nowUs = 0;
+    Serial.simulateReceive("ACK ON\n");
+    tickAll(*rig, nowUs += 1000);
+    Serial.takeTransmitted();
+
+    std::vector<uint8_t> frame = {inputs::frame::kSync, static_cast<uint8_t>(inputs::frame::Opcode::Drive)};
+    for (uint8_t motor = 0; motor < outputs::MotorController::kMotorCount; ++motor)
+    {
+        frame.push_back(0x00);
+        frame.push_back(0x40); // 0x4000: half speed
+    }
+    frame.push_back(inputs::frame::crc8(&frame[1], frame.size() - 1));
+    Serial.simulateReceive("#7 MOTOR 0 STOP\n");
+    Serial.simulateReceive(frame.data(), frame.size());
+    rig->scheduler.commandTick();
+    TEST_ASSERT_EQUAL_STRING("OK\r\n", transmittedText().c_str());
+    rig->scheduler.motorTick();
+    TEST_ASSERT_EQUAL_INT16(16384, rig->motors.targetSpeedQ15(1));
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_motor_line);
+    RUN_TEST(test_motor_update);
+    RUN_TEST(test_replay_command_to_pwm_latency);
+    RUN_TEST(test_record_dump_replays_identically);
+    RUN_TEST(test_i2c_fault_degrades_and_recovers);
+    RUN_TEST(test_overruns_and_stalls_stop_motors);
+    RUN_TEST(test_steer_scaling_ends_at_the_next_drive);
+    RUN_TEST(test_stats_and_lat_reset_read_empty_at_once);
+    RUN_TEST(test_driver_cut_holds_until_stop_all);
+    RUN_TEST(test_ack_mode_still_replies_to_frames);
+    return UNITY_END();
+}
@@ -24,6 +24,9 @@ class Settings(BaseSettings):
     # Use /dev/serial0 for GPIO UART on Raspberry Pi (GPIO 14/15)
     serial_port: str = "/dev/serial0"
     serial_baudrate: int = 115200
+    # Rate the bridge negotiates up to after connecting (firmware BAUD command).
+    # Set equal to serial_baudrate to stay at the boot rate.
+    serial_link_baudrate: int = 921600
     serial_timeout: float = 1.0
     serial_mock: bool = False  # Use mock bridge for testing without hardware
     # Heartbeat sent to the ESP32 to keep its deadman satisfied. Keep this well
@@ -97,6 +97,7 @@ async def lifespan(app: FastAPI) -> AsyncGenerator[None, None]:
             baudrate=settings.serial_baudrate,
             heartbeat_interval=settings.serial_heartbeat_interval,
             reconnect_interval=settings.serial_reconnect_interval,
+            link_baudrate=settings.serial_link_baudrate,
         )
 
     try:
@@ -329,7 +330,7 @@ async def _handle_debug_command(data: dict, armed: dict, out: asyncio.Queue) ->
 
     # Emergency + plain stop are always allowed and clear the armed state.
     if cmd_type in ("estop", "stop"):
-        await motion_driver.send_raw("MOTOR ALL STOP\n")
+        await motion_driver.emergency_stop()
         armed["value"] = False
         out.put_nowait({"type": "armed", "value": False})
         return
@@ -469,7 +470,7 @@ async def websocket_debug(websocket: WebSocket) -> None:
         # Safety: a debug session may have left a motor running. Stop on exit.
         if motion_driver:
             try:
-                await motion_driver.send_raw("MOTOR ALL STOP\n")
+                await motion_driver.emergency_stop()
             except Exception:
                 pass
         logger.info("Debug WebSocket closed")
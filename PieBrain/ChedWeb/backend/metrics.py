@@ -118,7 +118,7 @@ motion_driver_connected = Gauge(
 motion_driver_commands_total = Counter(
     "chedweb_motion_driver_commands_total",
     "Total motion driver commands sent",
-    ["command_type"],  # motor, servo, emergency_stop, etc.
+    ["command_type"],  # motion, heartbeat, emergency_stop, raw
 )
 
 motion_driver_command_errors_total = Counter(
@@ -127,6 +127,23 @@ motion_driver_command_errors_total = Counter(
     ["error_type"],  # timeout, invalid, serial_error
 )
 
+motion_driver_ack_latency_seconds = Histogram(
+    "chedweb_motion_driver_ack_latency_seconds",
+    "Time from writing a motion update to its OK/ERR reply",
+    buckets=(0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0.25, 0.5, 1.0),
+)
+
+motion_driver_updates_superseded_total = Counter(
+    "chedweb_motion_driver_updates_superseded_total",
+    "Motion updates replaced by a newer one before the writer sent them",
+)
+
+motion_driver_frames_received_total = Counter(
+    "chedweb_motion_driver_frames_received_total",
+    "Binary frames received from the motion driver",
+    ["frame_type"],  # telemetry, odometry
+)
+
 motion_driver_serial_bytes_total = Counter(
     "chedweb_motion_driver_serial_bytes_total",
     "Total bytes transferred over serial",
@@ -1,15 +1,27 @@
 """Serial bridge for communicating with ESP32 MotionDriver via UART."""
 
 import asyncio
+import struct
 import time
 from collections import deque
-from typing import Any, Optional
+from dataclasses import dataclass, field
+from typing import Any, NamedTuple, Optional, Union
 
 import serial_asyncio
 from loguru import logger
 
+import metrics
 from debug_hub import Broadcaster
 from models import ControlCommand
+from motion_stream import (
+    MOTOR_COUNT,
+    SERVO_COUNT,
+    SPEED_SCALE,
+    SYNC,
+    StreamEncoder,
+    crc8,
+    encode_frame,
+)
 
 
 def _now_ms() -> float:
@@ -26,6 +38,44 @@ SERVO_MAX_PULSE_US = 2000
 SERVO_MAX_ANGLE_DEG = 180.0
 
 
+# Baud negotiation (firmware `BAUD <rate>`). The firmware confirms at the old rate,
+# switches, and falls back to its base rate unless a PING arrives at the new rate
+# within 1s (UARTCommandInput::kBaudConfirmMs), so every retry here must fit in
+# that window, and a failed attempt waits the window out before using base again.
+BAUD_REPLY_TIMEOUT_S = 1.0
+BAUD_PING_TIMEOUT_S = 0.25
+BAUD_PING_ATTEMPTS = 3
+BAUD_FALLBACK_WAIT_S = 1.2
+# A deadman trip drops the firmware back to its base rate on its own, after which
+# heartbeats at the raised rate go unanswered. This many in a row means the link
+# is found again from base rather than left dead.
+RELINK_MISSED_PONGS = 3
+
+# E-STOP (firmware UARTCommandInput::kEmergencyStopByte). Acted on as it is
+# received, ahead of anything still queued, and it drops unparsed lines sent
+# before it. The text stop that follows covers firmware without the fast path.
+ESTOP_TOKEN = "\x03"
+
+# Binary frames (MotionDriver README "Binary frames"). A full six-wheel update
+# goes out as one Drive and/or Servo frame: 15 bytes and one OK each, against six
+# text lines and six OKs.
+OPCODE_DRIVE = 0x10
+OPCODE_SERVO = 0x11
+# What the firmware sends back besides text. The framing has no length byte, so
+# the reader splits on SYNC and these known payload lengths.
+OPCODE_TELEMETRY = 0x80
+OPCODE_ODOMETRY = 0x81
+RX_FRAME_PAYLOAD_BYTES = {OPCODE_TELEMETRY: 45, OPCODE_ODOMETRY: 41}
+TELEMETRY_FORMAT = "<I6h6h6HHHB"
+ODOMETRY_FORMAT = "<I6i6hB"
+
+# A reply later than this is no longer matched to the write that earned it.
+ACK_TIMEOUT_S = 1.0
+READ_CHUNK_BYTES = 256
+# A text line this long without a newline is garbage, not a reply.
+MAX_LINE_BYTES = 256
+
+
 def servo_angle_to_pulse_us(angle_deg: float) -> int:
     """Convert a servo angle in degrees to a firmware pulse width in microseconds.
 
@@ -36,11 +86,205 @@ def servo_angle_to_pulse_us(angle_deg: float) -> int:
     return round(SERVO_MIN_PULSE_US + (angle / SERVO_MAX_ANGLE_DEG) * span)
 
 
+def speed_to_q15(speed: float) -> int:
+    """Convert a -1.0..1.0 motor speed to the Drive frame's signed Q15."""
+    return round(min(1.0, max(-1.0, float(speed))) * SPEED_SCALE)
+
+
+def _motor_line(motor_id: int, speed: float) -> str:
+    if speed == 0:
+        return f"MOTOR {motor_id} STOP\n"
+    direction = "FORWARD" if speed > 0 else "BACKWARD"
+    return f"MOTOR {motor_id} {direction} {min(1.0, abs(speed)):.3f}\n"
+
+
+@dataclass
+class MotionUpdate:
+    """Motor speeds (-1.0..1.0) and servo pulses (us), keyed by wheel index."""
+
+    motors: dict[int, float] = field(default_factory=dict)
+    servos: dict[int, int] = field(default_factory=dict)
+
+    def merge(self, newer: "MotionUpdate") -> None:
+        """Take every target newer sets, keeping ours for the wheels it leaves alone."""
+        self.motors.update(newer.motors)
+        self.servos.update(newer.servos)
+
+    def __bool__(self) -> bool:
+        return bool(self.motors or self.servos)
+
+    def encode(self) -> tuple[bytes, int]:
+        """Pack the update into one write; returns it with the replies it earns.
+
+        All six motors (or servos) go out as a Drive (or Servo) frame. A partial
+        set, which only the legacy left/right and pan/tilt fields produce, falls
+        back to per-wheel text lines, since a frame would move the other wheels.
+        """
+        chunks: list[bytes] = []
+        if len(self.motors) == MOTOR_COUNT:
+            speeds = [speed_to_q15(self.motors[i]) for i in range(MOTOR_COUNT)]
+            chunks.append(encode_frame(OPCODE_DRIVE, struct.pack("<6h", *speeds)))
+        else:
+            for motor_id, speed in sorted(self.motors.items()):
+                chunks.append(_motor_line(motor_id, speed).encode())
+        if len(self.servos) == SERVO_COUNT:
+            pulses = [self.servos[i] for i in range(SERVO_COUNT)]
+            chunks.append(encode_frame(OPCODE_SERVO, struct.pack("<6H", *pulses)))
+        else:
+            for servo_id, pulse_us in sorted(self.servos.items()):
+                chunks.append(f"S {servo_id} {pulse_us}\n".encode())
+        return b"".join(chunks), len(chunks)
+
+    def describe(self) -> str:
+        """One Debug-tab line for the whole update."""
+        parts = []
+        if self.motors:
+            speeds = " ".join(f"{i}:{speed:+.2f}" for i, speed in sorted(self.motors.items()))
+            parts.append(f"DRIVE {speeds}")
+        if self.servos:
+            pulses = " ".join(f"{i}:{us}" for i, us in sorted(self.servos.items()))
+            parts.append(f"SERVO {pulses}")
+        return " | ".join(parts)
+
+
+class MotionMailbox:
+    """Bounded, latest-wins hand-off from send_command to the writer task.
+
+    Holds at most one pending update. One that arrives before the writer has
+    taken the last is merged over it, so the writer always sends the newest
+    target for every wheel and a slow link sheds stale targets instead of
+    queueing them behind the operator.
+    """
+
+    def __init__(self) -> None:
+        self._pending: Optional[MotionUpdate] = None
+        self._ready = asyncio.Event()
+        self.superseded = 0
+
+    def put(self, update: MotionUpdate) -> bool:
+        """Post update; True if it replaced one the writer had not sent yet."""
+        if self._pending is None:
+            self._pending = update
+            self._ready.set()
+            return False
+        self._pending.merge(update)
+        self.superseded += 1
+        return True
+
+    def clear(self) -> None:
+        """Drop whatever is pending (a stop, or a link that went away)."""
+        self._pending = None
+        self._ready.clear()
+
+    async def get(self) -> MotionUpdate:
+        """Wait for the next update and take it."""
+        while self._pending is None:
+            self._ready.clear()
+            await self._ready.wait()
+        update, self._pending = self._pending, None
+        self._ready.clear()
+        return update
+
+
+class RxFrame(NamedTuple):
+    opcode: int
+    payload: bytes
+
+
+class LinkDecoder:
+    """Splits the firmware's byte stream into text replies and binary frames.
+
+    Text never contains SYNC, so a SYNC byte always starts a frame. A frame with
+    a bad CRC is dropped whole, so its payload is never read as text; a SYNC
+    with an unknown opcode is dropped alone.
+    """
+
+    def __init__(self) -> None:
+        self._buffer = bytearray()
+        self.dropped = 0
+
+    def feed(self, data: bytes) -> list[Union[str, RxFrame]]:
+        """Add received bytes; return every complete line and frame, in order."""
+        self._buffer.extend(data)
+        items: list[Union[str, RxFrame]] = []
+        buffer = self._buffer
+        while buffer:
+            if buffer[0] == SYNC:
+                if len(buffer) < 2:
+                    break
+                length = RX_FRAME_PAYLOAD_BYTES.get(buffer[1])
+                if length is None:
+                    del buffer[0]
+                    self.dropped += 1
+                    continue
+                size = length + 3
+                if len(buffer) < size:
+                    break
+                body = bytes(buffer[1 : size - 1])
+                if crc8(body) != buffer[size - 1]:
+                    del buffer[:size]
+                    self.dropped += 1
+                    continue
+                items.append(RxFrame(body[0], body[1:]))
+                del buffer[:size]
+                continue
+
+            newline = buffer.find(b"\n")
+            sync = buffer.find(bytes([SYNC]))
+            end = newline if sync == -1 or (newline != -1 and newline < sync) else sync
+            if end == -1:
+                if len(buffer) > MAX_LINE_BYTES:
+                    buffer.clear()
+                    self.dropped += 1
+                break
+            line = bytes(buffer[:end]).decode("utf-8", errors="ignore").strip()
+            del buffer[: end + 1 if end == newline else end]
+            if line:
+                items.append(line)
+        return items
+
+
+def decode_telemetry(payload: bytes) -> dict[str, Any]:
+    """Unpack a LOG ON state snapshot (opcode 0x80)."""
+    fields = struct.unpack(TELEMETRY_FORMAT, payload)
+    flags = fields[21]
+    return {
+        "ts_ms": fields[0],
+        "speeds": [v / SPEED_SCALE for v in fields[1:7]],
+        "targets": [v / SPEED_SCALE for v in fields[7:13]],
+        "servos_us": list(fields[13:19]),
+        "tick_work_us": fields[19],
+        "tick_period_us": fields[20],
+        "driver_enabled": bool(flags & 0x01),
+        "failsafe": bool(flags & 0x02),
+    }
+
+
+def decode_odometry(payload: bytes) -> dict[str, Any]:
+    """Unpack an encoder odometry frame (opcode 0x81)."""
+    fields = struct.unpack(ODOMETRY_FORMAT, payload)
+    return {
+        "ts_ms": fields[0],
+        "counts": list(fields[1:7]),
+        "wheel_speed_rad_s": [v / 100 for v in fields[7:13]],
+        "fitted_mask": fields[13],
+    }
+
+
 class MotionDriverBridge:
     """Asynchronous serial bridge to ESP32 MotionDriver.
 
     Converts high-level ControlCommand messages into UART protocol
     commands that the ESP32 understands.
+
+    Once connected, two tasks own the port. The writer sends motion updates
+    from a latest-wins mailbox, each packed into a single write, so
+    send_command never waits on the link and a burst of updates costs one write
+    for the newest. Once every motor and servo target is known, updates go out
+    in stream mode: a Keyframe, then Deltas carrying only what moved. An ERR, an
+    E-STOP, a raw line or a new handshake sends a Keyframe next. The reader parses the replies and telemetry frames that come
+    back and times each update's OK. send_raw still writes directly, so a stop
+    or a heartbeat never waits behind a drive update.
     """
 
     def __init__(
@@ -49,20 +293,26 @@ class MotionDriverBridge:
         baudrate: int = 115200,
         heartbeat_interval: float = 0.2,
         reconnect_interval: float = 2.0,
+        link_baudrate: Optional[int] = None,
     ) -> None:
         """Initialize serial bridge.
 
         Args:
             port: Serial port path (e.g., '/dev/ttyUSB0', '/dev/serial0')
-            baudrate: Serial baud rate (default: 115200)
+            baudrate: Serial baud rate the firmware boots at (default: 115200)
             heartbeat_interval: Seconds between PING heartbeats. Must stay well
                 under the ESP32 firmware deadman window so a healthy link keeps
                 the motors enabled.
             reconnect_interval: Seconds between reconnection attempts after the
                 serial link drops.
+            link_baudrate: Rate to negotiate up to once connected, falling back
+                to baudrate if it fails. None (or equal to baudrate) keeps the
+                link at baudrate.
         """
         self.port = port
         self.baudrate = baudrate
+        self.link_baudrate = link_baudrate or baudrate
+        self.active_baudrate = baudrate
         self.heartbeat_interval = heartbeat_interval
         self.reconnect_interval = reconnect_interval
         self.reader: Optional[asyncio.StreamReader] = None
@@ -81,6 +331,23 @@ class MotionDriverBridge:
         self._last_rtt_ms: float | None = None
         self._pong_times: deque[float] = deque(maxlen=64)
         self._miss_times: deque[float] = deque(maxlen=64)
+        self._missed_pongs = 0
+
+        # Writer/reader pipeline. Replies come back in order, so each write the
+        # writer makes leaves one send time per reply it earns; raw text lines
+        # (whose reply count isn't known here) suspend timing for ACK_TIMEOUT_S.
+        self._mailbox = MotionMailbox()
+        self._decoder = LinkDecoder()
+        self._in_flight: deque[float] = deque(maxlen=64)
+        self._untimed_until = 0.0
+        self._last_ack_ms: float | None = None
+        self.telemetry: Optional[dict[str, Any]] = None
+        self.odometry: Optional[dict[str, Any]] = None
+
+        # Stream mode: every target the firmware holds, as far as this end knows,
+        # and the encoder that sends changes to them.
+        self._stream = StreamEncoder()
+        self._targets = MotionUpdate()
 
     def _on_tx(self, line: str) -> None:
         """Record an outbound line and track heartbeat timing."""
@@ -90,6 +357,7 @@ class MotionDriverBridge:
             # A new PING before the previous PONG arrived = a missed beat.
             if self._awaiting_pong:
                 self._miss_times.append(now)
+                self._missed_pongs += 1
             self._awaiting_pong = True
             self._last_ping_mono = now
 
@@ -102,6 +370,7 @@ class MotionDriverBridge:
                 self._last_rtt_ms = (now - self._last_ping_mono) * 1000
             self._last_pong_mono = now
             self._awaiting_pong = False
+            self._missed_pongs = 0
             self._pong_times.append(now)
 
     def heartbeat_stats(self) -> dict[str, Any]:
@@ -117,6 +386,9 @@ class MotionDriverBridge:
             "rate_hz": rate,
             "missed_60s": missed,
             "interval_ms": self.heartbeat_interval * 1000,
+            "baudrate": self.active_baudrate,
+            "ack_ms": self._last_ack_ms,
+            "superseded": self._mailbox.superseded,
         }
 
     async def connect(self) -> None:
@@ -145,14 +417,87 @@ class MotionDriverBridge:
         )
         self.connected = True
         logger.info("MotionDriver connected")
+        await self._handshake(timeout=2.0)
+
+    async def _handshake(self, timeout: float) -> None:
+        """Find the firmware at the base or the negotiated rate, then raise the link."""
+        self._set_port_baudrate(self.baudrate)
+        self.active_baudrate = self.baudrate
+        self._awaiting_pong = False
+        self._missed_pongs = 0
+        # Whatever the firmware holds now, this end can't vouch for it.
+        self._forget_targets()
 
         # Send ping to verify connection
-        await self.send_raw("PING\n")
-        response = await self.read_line(timeout=2.0)
-        if response and "PONG" in response:
+        if await self._ping(timeout=timeout):
             logger.success("MotionDriver responded to PING")
-        else:
-            logger.warning(f"Unexpected response to PING: {response}")
+            if self.link_baudrate != self.baudrate:
+                await self._negotiate_baud(self.link_baudrate)
+            return
+
+        # A reconnect inside the deadman window finds the firmware still at the
+        # negotiated rate; try that before giving up on the handshake.
+        if self.link_baudrate != self.baudrate:
+            self._set_port_baudrate(self.link_baudrate)
+            if await self._ping(timeout=BAUD_PING_TIMEOUT_S):
+                self.active_baudrate = self.link_baudrate
+                logger.success(f"MotionDriver responded to PING @ {self.link_baudrate} baud")
+                return
+            self._set_port_baudrate(self.baudrate)
+        logger.warning("No PONG from MotionDriver")
+
+    async def _ping(self, timeout: float) -> bool:
+        """Send PING and wait up to timeout seconds for PONG."""
+        await self.send_raw("PING\n")
+        return await self._await_line(lambda line: "PONG" in line, timeout) is not None
+
+    async def _await_line(self, predicate: Any, timeout: float) -> Optional[str]:
+        """Read lines until one satisfies predicate; None if timeout passes first."""
+        deadline = time.monotonic() + timeout
+        while self.connected:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                break
+            line = await self.read_line(timeout=remaining)
+            if line and predicate(line):
+                return line
+        return None
+
+    def _set_port_baudrate(self, baudrate: int) -> None:
+        """Retune the open serial port."""
+        if self.writer is not None:
+            self.writer.transport.serial.baudrate = baudrate
+
+    async def _negotiate_baud(self, baudrate: int) -> bool:
+        """Raise the link to baudrate, or leave it at base if either end can't."""
+        await self.send_raw(f"BAUD {baudrate}\n")
+        reply = await self._await_line(
+            lambda line: line == f"BAUD {baudrate}" or line.startswith("ERR"),
+            BAUD_REPLY_TIMEOUT_S,
+        )
+        if reply != f"BAUD {baudrate}":
+            logger.warning(
+                f"MotionDriver refused BAUD {baudrate} ({reply}); staying at {self.baudrate}"
+            )
+            return False
+
+        self._set_port_baudrate(baudrate)
+        for _ in range(BAUD_PING_ATTEMPTS):
+            if await self._ping(timeout=BAUD_PING_TIMEOUT_S):
+                self.active_baudrate = baudrate
+                logger.success(f"MotionDriver link raised to {baudrate} baud")
+                return True
+
+        # The firmware drops back on its own once its confirm window passes.
+        logger.warning(f"No PONG at {baudrate} baud; falling back to {self.baudrate}")
+        self._set_port_baudrate(self.baudrate)
+        await asyncio.sleep(BAUD_FALLBACK_WAIT_S)
+        await self._ping(timeout=BAUD_PING_TIMEOUT_S)
+        return False
+
+    def _link_stale(self) -> bool:
+        """Heartbeats stopped coming back on a link raised above base."""
+        return self.link_baudrate != self.baudrate and self._missed_pongs >= RELINK_MISSED_PONGS
 
     async def _cleanup_transport(self) -> None:
         """Close and discard the current serial transport, if any."""
@@ -181,33 +526,121 @@ class MotionDriverBridge:
                     await asyncio.sleep(self.reconnect_interval)
                     continue
 
-            # Connected: drain replies and heartbeat until the link drops. A
+            # Connected: write, read and heartbeat until the link drops. A
             # failed read/write flips self.connected to False and breaks out.
-            reader_task = asyncio.create_task(self._reader_loop())
+            self._decoder = LinkDecoder()
+            tasks = [
+                asyncio.create_task(self._reader_loop()),
+                asyncio.create_task(self._writer_loop()),
+            ]
             try:
-                while not self._closing and self.connected:
+                while not self._closing and self.connected and not self._link_stale():
                     await self.send_raw("PING\n")
                     await asyncio.sleep(self.heartbeat_interval)
             finally:
-                reader_task.cancel()
-                try:
-                    await reader_task
-                except asyncio.CancelledError:
-                    pass
-
-            if not self.connected and not self._closing:
+                for task in tasks:
+                    task.cancel()
+                for task in tasks:
+                    try:
+                        await task
+                    except asyncio.CancelledError:
+                        pass
+                # Targets queued for a link that went away are stale by the
+                # time it comes back.
+                self._mailbox.clear()
+                self._in_flight.clear()
+                self._forget_targets()
+
+            if self._closing:
+                continue
+            if not self.connected:
                 logger.warning("MotionDriver link lost; attempting to reconnect")
                 await self._cleanup_transport()
                 await asyncio.sleep(self.reconnect_interval)
+            else:
+                # The port is open but nothing answers at the raised rate: most
+                # likely the firmware's deadman tripped and it went back to base.
+                logger.warning(
+                    f"{self._missed_pongs} PINGs unanswered @ {self.active_baudrate} baud; "
+                    "renegotiating the link"
+                )
+                await self._handshake(timeout=BAUD_REPLY_TIMEOUT_S)
 
     async def _reader_loop(self) -> None:
-        """Continuously read and discard incoming lines.
+        """Parse replies and telemetry frames until the link drops.
 
         The ESP32 replies to every command and heartbeat, so something has to
         drain the buffer; this also detects a dropped link via EOF.
         """
         while not self._closing and self.connected:
-            await self.read_line(timeout=1.0)
+            data = await self._read_chunk(timeout=1.0)
+            if not data:
+                continue
+            metrics.motion_driver_serial_bytes_total.labels(direction="received").inc(len(data))
+            dropped = self._decoder.dropped
+            for item in self._decoder.feed(data):
+                if isinstance(item, RxFrame):
+                    self._on_frame(item)
+                else:
+                    logger.debug(f"Received: {item}")
+                    self._on_rx(item)
+                    self._on_reply(item)
+            if self._decoder.dropped != dropped:
+                metrics.motion_driver_command_errors_total.labels(error_type="serial_error").inc(
+                    self._decoder.dropped - dropped
+                )
+
+    async def _writer_loop(self) -> None:
+        """Send each motion update as one write, always the newest pending."""
+        while not self._closing and self.connected:
+            update = await self._mailbox.get()
+            data, replies = self._encode(update)
+            await self._write(data, update.describe(), "motion", replies)
+
+    def _encode(self, update: MotionUpdate) -> tuple[bytes, int]:
+        """Pack an update as one stream frame once every target is known, else as is."""
+        self._targets.merge(update)
+        if len(self._targets.motors) < MOTOR_COUNT or len(self._targets.servos) < SERVO_COUNT:
+            # A Keyframe would have to guess the rest.
+            self._stream.resync()
+            return update.encode()
+        speeds = [speed_to_q15(self._targets.motors[i]) for i in range(MOTOR_COUNT)]
+        pulses = [self._targets.servos[i] for i in range(SERVO_COUNT)]
+        return self._stream.encode(speeds, pulses), 1
+
+    def _forget_targets(self) -> None:
+        """Drop the mirrored targets, so stream mode waits for a full update."""
+        self._targets = MotionUpdate()
+        self._stream.resync()
+
+    def _on_reply(self, line: str) -> None:
+        """Match an OK/ERR to the oldest timed write and record its latency."""
+        if line != "OK" and not line.startswith("ERR"):
+            return
+        if line.startswith("ERR"):
+            metrics.motion_driver_command_errors_total.labels(error_type="invalid").inc()
+            # Whichever write earned it, the firmware's stream mirror may no longer
+            # match ours (a refused Delta, or ERR Busy ending the stream).
+            self._stream.resync()
+
+        now = time.monotonic()
+        while self._in_flight and now - self._in_flight[0] > ACK_TIMEOUT_S:
+            self._in_flight.popleft()
+            metrics.motion_driver_command_errors_total.labels(error_type="timeout").inc()
+        if not self._in_flight or now < self._untimed_until:
+            return
+        latency = now - self._in_flight.popleft()
+        self._last_ack_ms = latency * 1000
+        metrics.motion_driver_ack_latency_seconds.observe(latency)
+
+    def _on_frame(self, frame: RxFrame) -> None:
+        """Keep the latest telemetry and odometry snapshot."""
+        if frame.opcode == OPCODE_TELEMETRY:
+            self.telemetry = decode_telemetry(frame.payload)
+            metrics.motion_driver_frames_received_total.labels(frame_type="telemetry").inc()
+        elif frame.opcode == OPCODE_ODOMETRY:
+            self.odometry = decode_odometry(frame.payload)
+            metrics.motion_driver_frames_received_total.labels(frame_type="odometry").inc()
 
     async def disconnect(self) -> None:
         """Stop the supervisor and close the serial connection."""
@@ -223,24 +656,70 @@ class MotionDriverBridge:
         self.connected = False
         logger.info("MotionDriver disconnected")
 
+    async def emergency_stop(self) -> None:
+        """Stop every motor now, ahead of any drive commands already sent."""
+        # An update still waiting for the writer must not restart the motors.
+        self._mailbox.clear()
+        # The stop zeroes every motor, leaves the servos holding and ends the stream.
+        self._targets.motors = dict.fromkeys(range(MOTOR_COUNT), 0.0)
+        self._stream.resync()
+        await self.send_raw(ESTOP_TOKEN + "MOTOR ALL STOP\n")
+
+    def submit(self, update: MotionUpdate) -> None:
+        """Hand a motion update to the writer task without waiting for the link."""
+        if not update:
+            return
+        if self._mailbox.put(update):
+            metrics.motion_driver_updates_superseded_total.inc()
+
     async def send_raw(self, command: str) -> None:
         """Send raw command to MotionDriver.
 
         Args:
             command: Command string (should include newline if required)
         """
+        line = command.strip()
+        if line.upper() == "PING":
+            await self._write(command.encode("utf-8"), line, "heartbeat", 0)
+        elif command.startswith(ESTOP_TOKEN):
+            await self._write(command.encode("utf-8"), line, "emergency_stop", None)
+        else:
+            # A raw line may move something behind the stream's back.
+            self._stream.resync()
+            await self._write(command.encode("utf-8"), line, "raw", None)
+
+    async def _write(
+        self, data: bytes, label: str, command_type: str, replies: Optional[int]
+    ) -> None:
+        """Write data in one go and account for it.
+
+        Args:
+            data: Bytes to send
+            label: What the Debug tab shows for it
+            command_type: Metrics label
+            replies: OK/ERR replies it earns, or None if not known here
+        """
         if not self.writer or not self.connected:
             logger.warning("Cannot send command - not connected")
             return
 
         try:
             async with self._write_lock:
-                self.writer.write(command.encode("utf-8"))
+                sent_at = time.monotonic()
+                self.writer.write(data)
                 await self.writer.drain()
-            logger.debug(f"Sent: {command.strip()}")
-            self._on_tx(command.strip())
+                if replies is None:
+                    self._in_flight.clear()
+                    self._untimed_until = sent_at + ACK_TIMEOUT_S
+                elif sent_at >= self._untimed_until:
+                    self._in_flight.extend([sent_at] * replies)
+            logger.debug(f"Sent: {label}")
+            self._on_tx(label)
+            metrics.motion_driver_commands_total.labels(command_type=command_type).inc()
+            metrics.motion_driver_serial_bytes_total.labels(direction="sent").inc(len(data))
         except Exception as e:
             logger.error(f"Failed to send command: {e}")
+            metrics.motion_driver_command_errors_total.labels(error_type="serial_error").inc()
             self.connected = False
 
     async def read_line(self, timeout: float = 1.0) -> Optional[str]:
@@ -262,6 +741,8 @@ class MotionDriverBridge:
                 logger.warning("MotionDriver serial reached EOF (device disconnected)")
                 self.connected = False
                 return None
+            received = metrics.motion_driver_serial_bytes_total.labels(direction="received")
+            received.inc(len(line_bytes))
             line = line_bytes.decode("utf-8", errors="ignore").strip()
             logger.debug(f"Received: {line}")
             if line:
@@ -274,9 +755,32 @@ class MotionDriverBridge:
             self.connected = False
             return None
 
+    async def _read_chunk(self, timeout: float = 1.0) -> Optional[bytes]:
+        """Read whatever has arrived, up to READ_CHUNK_BYTES; None on timeout."""
+        if not self.reader or not self.connected:
+            return None
+
+        try:
+            data = await asyncio.wait_for(self.reader.read(READ_CHUNK_BYTES), timeout=timeout)
+            if data == b"":
+                # EOF - the serial device went away
+                logger.warning("MotionDriver serial reached EOF (device disconnected)")
+                self.connected = False
+                return None
+            return data
+        except asyncio.TimeoutError:
+            return None
+        except Exception as e:
+            logger.error(f"Failed to read from serial: {e}")
+            self.connected = False
+            return None
+
     async def send_command(self, cmd: ControlCommand) -> None:
         """Convert ControlCommand to UART protocol and send to ESP32.
 
+        Motion is handed to the writer task and this returns at once; an update
+        the link has not caught up with yet is replaced by this one.
+
         Args:
             cmd: High-level control command from frontend
         """
@@ -286,27 +790,21 @@ class MotionDriverBridge:
 
         try:
             if cmd.type == "estop" or cmd.type == "stop":
-                # Emergency stop: stop all motors using proper protocol
-                await self.send_raw("MOTOR ALL STOP\n")
+                await self.emergency_stop()
                 logger.warning("Emergency stop executed")
                 return
 
-            # Motor control - use FORWARD/BACKWARD commands with speed 0.0-1.0
+            update = MotionUpdate()
+            # Motor control - speed -1.0..1.0 per wheel
             if cmd.motors:
-                for motor_id, speed in enumerate(cmd.motors):
-                    if speed == 0:
-                        await self.send_raw(f"MOTOR {motor_id} STOP\n")
-                    else:
-                        # Determine direction and magnitude
-                        direction = "FORWARD" if speed > 0 else "BACKWARD"
-                        speed_magnitude = abs(speed)  # 0.0 to 1.0
-                        await self.send_raw(f"MOTOR {motor_id} {direction} {speed_magnitude}\n")
+                update.motors.update(enumerate(cmd.motors))
 
             # Servo control - command carries degrees, firmware wants microseconds
             if cmd.servos:
-                for servo_id, angle_deg in enumerate(cmd.servos):
-                    pulse_us = servo_angle_to_pulse_us(angle_deg)
-                    await self.send_raw(f"S {servo_id} {pulse_us}\n")
+                update.servos.update(
+                    (servo_id, servo_angle_to_pulse_us(angle_deg))
+                    for servo_id, angle_deg in enumerate(cmd.servos)
+                )
 
             # Legacy command support (backwards compatibility)
             if cmd.motor_left is not None or cmd.motor_right is not None:
@@ -315,24 +813,15 @@ class MotionDriverBridge:
 
                 # Map to 6-motor layout. Wheel indices interleave sides
                 # (0=FL, 1=FR, 2=ML, 3=MR, 4=RL, 5=RR), so left is the even indices.
-                for motor_id in [0, 2, 4]:  # Left side
-                    if left == 0:
-                        await self.send_raw(f"MOTOR {motor_id} STOP\n")
-                    else:
-                        direction = "FORWARD" if left > 0 else "BACKWARD"
-                        await self.send_raw(f"MOTOR {motor_id} {direction} {abs(left)}\n")
-
-                for motor_id in [1, 3, 5]:  # Right side
-                    if right == 0:
-                        await self.send_raw(f"MOTOR {motor_id} STOP\n")
-                    else:
-                        direction = "FORWARD" if right > 0 else "BACKWARD"
-                        await self.send_raw(f"MOTOR {motor_id} {direction} {abs(right)}\n")
+                for motor_id in range(MOTOR_COUNT):
+                    update.motors[motor_id] = left if motor_id % 2 == 0 else right
 
             if cmd.servo_pan is not None:
-                await self.send_raw(f"S 0 {servo_angle_to_pulse_us(cmd.servo_pan)}\n")
+                update.servos[0] = servo_angle_to_pulse_us(cmd.servo_pan)
             if cmd.servo_tilt is not None:
-                await self.send_raw(f"S 1 {servo_angle_to_pulse_us(cmd.servo_tilt)}\n")
+                update.servos[1] = servo_angle_to_pulse_us(cmd.servo_tilt)
+
+            self.submit(update)
 
         except Exception as e:
             logger.error(f"Error processing command: {e}")
@@ -353,6 +842,7 @@ class MockMotionDriverBridge:
         logger.info(f"[MOCK] MotionDriver bridge initialized (port={port})")
         self.connected = False
         self.heartbeat_interval = 0.2
+        self._baudrate = baudrate
         self.events = Broadcaster(history=300)
         self._hb_task: Optional[asyncio.Task] = None
         self._rtt_ms = 7.0
@@ -387,6 +877,9 @@ class MockMotionDriverBridge:
             self.events.emit({"dir": "rx", "line": "PONG", "ts": _now_ms()})
             await asyncio.sleep(self.heartbeat_interval)
 
+    async def emergency_stop(self) -> None:
+        await self.send_raw(ESTOP_TOKEN + "MOTOR ALL STOP\n")
+
     async def send_raw(self, command: str) -> None:
         line = command.strip()
         logger.debug(f"[MOCK] Send: {line}")
@@ -412,6 +905,9 @@ class MockMotionDriverBridge:
             "rate_hz": (1.0 / self.heartbeat_interval) if self.connected else 0.0,
             "missed_60s": 0,
             "interval_ms": self.heartbeat_interval * 1000,
+            "baudrate": self._baudrate,
+            "ack_ms": self._rtt_ms if self.connected else None,
+            "superseded": 0,
         }
 
     def is_connected(self) -> bool:
@@ -0,0 +1,153 @@
+"""Keyframe/delta encoder for the MotionDriver binary stream mode.
+
+The firmware keeps a mirror of the last keyframe plus every delta applied since
+(UARTCommandInput's StreamState). A delta only carries the fields that moved, as
+quantised steps against that mirror, so this encoder keeps an identical mirror
+and must apply exactly the same quantisation and saturation. See the "Stream
+mode" section of MotionDriver/README.md for the wire format.
+"""
+
+import struct
+from typing import Optional, Sequence
+
+SYNC = 0xA5
+OPCODE_KEYFRAME = 0x12
+OPCODE_DELTA = 0x13
+
+# Cheddar's wheel count; the firmware sizes frames from its board descriptor.
+MOTOR_COUNT = 6
+SERVO_COUNT = 6
+SERVO_MASK_SHIFT = MOTOR_COUNT
+
+SPEED_SCALE = 32767
+DELTA_SPEED_STEP = 256
+DELTA_PULSE_STEP_US = 4
+MAX_STEP = 127
+MAX_PULSE_US = 0xFFFF
+
+# Sent regardless of how little changed, so a delta refused by the firmware
+# (sequence gap, ERR Busy or Shed) costs at most this many frames before it resyncs.
+DEFAULT_KEYFRAME_INTERVAL = 20
+
+
+def crc8(data: bytes) -> int:
+    """CRC-8/SMBUS (poly 0x07, init 0x00), as frame::crc8 in the firmware."""
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def encode_frame(opcode: int, payload: bytes) -> bytes:
+    """Wrap a payload as [sync][opcode][payload][crc8]."""
+    body = bytes([opcode]) + payload
+    return bytes([SYNC]) + body + bytes([crc8(body)])
+
+
+def _clamp(value: int, low: int, high: int) -> int:
+    return min(high, max(low, value))
+
+
+def _quantise_step(error: int, unit: int) -> int:
+    """Nearest whole step toward error, limited to what one int8 can carry."""
+    steps = int(round(error / unit))
+    return _clamp(steps, -MAX_STEP, MAX_STEP)
+
+
+class StreamEncoder:
+    """Turns a stream of absolute targets into keyframe and delta frames."""
+
+    def __init__(self, keyframe_interval: int = DEFAULT_KEYFRAME_INTERVAL) -> None:
+        """Initialize the encoder.
+
+        Args:
+            keyframe_interval: Deltas sent between forced keyframes. A keyframe is
+                also sent whenever a field moved further than one delta can carry.
+        """
+        self._keyframe_interval = max(1, keyframe_interval)
+        self._sequence = 0
+        self._deltas_since_keyframe = 0
+        self._speeds: Optional[list[int]] = None
+        self._pulses: Optional[list[int]] = None
+
+    @property
+    def mirror(self) -> Optional[tuple[list[int], list[int]]]:
+        """Speeds (Q15) and pulses (us) the firmware holds, or None before a keyframe."""
+        if self._speeds is None or self._pulses is None:
+            return None
+        return list(self._speeds), list(self._pulses)
+
+    def resync(self) -> None:
+        """Force a keyframe next, e.g. after the firmware replied ERR Delta sequence."""
+        self._speeds = None
+        self._pulses = None
+
+    def encode(self, speeds_q15: Sequence[int], pulses_us: Sequence[int]) -> bytes:
+        """Encode one update, returning the frame to write.
+
+        Args:
+            speeds_q15: Six signed Q15 motor speeds (+-32767 = full).
+            pulses_us: Six servo pulse widths in microseconds.
+        """
+        if len(speeds_q15) != MOTOR_COUNT or len(pulses_us) != SERVO_COUNT:
+            raise ValueError("expected six motor speeds and six servo pulses")
+
+        speeds = [_clamp(int(s), -SPEED_SCALE, SPEED_SCALE) for s in speeds_q15]
+        pulses = [_clamp(int(p), 0, MAX_PULSE_US) for p in pulses_us]
+
+        if (
+            self._speeds is None
+            or self._pulses is None
+            or self._deltas_since_keyframe >= self._keyframe_interval
+            or not self._fits_delta(speeds, pulses)
+        ):
+            return self._keyframe(speeds, pulses)
+        return self._delta(speeds, pulses)
+
+    def _fits_delta(self, speeds: list[int], pulses: list[int]) -> bool:
+        assert self._speeds is not None and self._pulses is not None
+        speed_reach = MAX_STEP * DELTA_SPEED_STEP + DELTA_SPEED_STEP // 2
+        pulse_reach = MAX_STEP * DELTA_PULSE_STEP_US + DELTA_PULSE_STEP_US // 2
+        return all(abs(s - m) <= speed_reach for s, m in zip(speeds, self._speeds)) and all(
+            abs(p - m) <= pulse_reach for p, m in zip(pulses, self._pulses)
+        )
+
+    def _keyframe(self, speeds: list[int], pulses: list[int]) -> bytes:
+        self._sequence = (self._sequence + 1) & 0xFF
+        self._deltas_since_keyframe = 0
+        self._speeds = speeds
+        self._pulses = pulses
+        payload = struct.pack(
+            f"<B{MOTOR_COUNT}h{SERVO_COUNT}H", self._sequence, *speeds, *pulses
+        )
+        return encode_frame(OPCODE_KEYFRAME, payload)
+
+    def _delta(self, speeds: list[int], pulses: list[int]) -> bytes:
+        assert self._speeds is not None and self._pulses is not None
+        mask = 0
+        steps: list[int] = []
+
+        for index in range(MOTOR_COUNT):
+            step = _quantise_step(speeds[index] - self._speeds[index], DELTA_SPEED_STEP)
+            if step:
+                mask |= 1 << index
+                steps.append(step)
+                self._speeds[index] = _clamp(
+                    self._speeds[index] + step * DELTA_SPEED_STEP, -SPEED_SCALE, SPEED_SCALE
+                )
+
+        for channel in range(SERVO_COUNT):
+            step = _quantise_step(pulses[channel] - self._pulses[channel], DELTA_PULSE_STEP_US)
+            if step:
+                mask |= 1 << (SERVO_MASK_SHIFT + channel)
+                steps.append(step)
+                self._pulses[channel] = _clamp(
+                    self._pulses[channel] + step * DELTA_PULSE_STEP_US, 0, MAX_PULSE_US
+                )
+
+        self._sequence = (self._sequence + 1) & 0xFF
+        self._deltas_since_keyframe += 1
+        payload = struct.pack(f"<BH{len(steps)}b", self._sequence, mask, *steps)
+        return encode_frame(OPCODE_DELTA, payload)
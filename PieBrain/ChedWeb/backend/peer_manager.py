@@ -96,7 +96,7 @@ class PeerManager:
             if self.motion_driver:
                 logger.warning("Control channel closed - stopping all motors")
                 loop = asyncio.get_event_loop()
-                loop.create_task(self.motion_driver.send_raw("MOTOR ALL STOP\n"))
+                loop.create_task(self.motion_driver.emergency_stop())
 
         # Check if channel is already open and start metrics immediately
         if channel.readyState == "open":
@@ -190,7 +190,7 @@ class PeerManager:
                         logger.warning(
                             f"Peer connection {self.pc.connectionState} - stopping all motors"
                         )
-                        await self.motion_driver.send_raw("MOTOR ALL STOP\n")
+                        await self.motion_driver.emergency_stop()
                 if self.pc.connectionState == "failed":
                     await self.close()
 
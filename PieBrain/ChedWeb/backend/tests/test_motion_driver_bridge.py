@@ -2,12 +2,32 @@
 Tests for the MotionDriver serial bridge
 """
 
+import asyncio
+import struct
+from collections import deque
+from typing import Optional
+
+import motion_driver_bridge
 import pytest
 from motion_driver_bridge import (
+    ESTOP_TOKEN,
+    OPCODE_DRIVE,
+    OPCODE_SERVO,
+    OPCODE_TELEMETRY,
+    RELINK_MISSED_PONGS,
     SERVO_MAX_PULSE_US,
     SERVO_MIN_PULSE_US,
+    TELEMETRY_FORMAT,
+    LinkDecoder,
+    MotionDriverBridge,
+    MotionMailbox,
+    MotionUpdate,
+    RxFrame,
+    decode_telemetry,
     servo_angle_to_pulse_us,
+    speed_to_q15,
 )
+from motion_stream import OPCODE_DELTA, OPCODE_KEYFRAME, StreamEncoder, encode_frame
 
 
 def test_centre_angle_maps_to_centre_pulse():
@@ -42,3 +62,279 @@ def test_steering_extremes_are_distinguishable():
     left = servo_angle_to_pulse_us(45)
     right = servo_angle_to_pulse_us(135)
     assert left < 1500 < right
+
+
+class ScriptedBridge(MotionDriverBridge):
+    """Bridge wired to a fake firmware instead of a serial port.
+
+    The firmware answers only when both ends agree on the baud rate, like the
+    real link: a mismatched line arrives as garbage and gets no reply.
+    """
+
+    def __init__(self, link_baudrate: int, supported: bool = True, confirms: bool = True) -> None:
+        super().__init__(port="/dev/null", link_baudrate=link_baudrate)
+        self.connected = True
+        self.port_baudrate = self.baudrate
+        self.firmware_baudrate = self.baudrate
+        self.supported = supported
+        self.confirms = confirms
+        self.sent: list[str] = []
+        self.received: list[str] = []
+        self._replies: deque[str] = deque()
+
+    async def send_raw(self, command: str) -> None:
+        line = command.strip()
+        self.sent.append(line)
+        self._on_tx(line)
+        if self.port_baudrate != self.firmware_baudrate:
+            return
+        self.received.append(line)
+        if line == "PING":
+            if self.firmware_baudrate == self.baudrate or self.confirms:
+                self._replies.append("PONG")
+        elif line.startswith("BAUD "):
+            if not self.supported:
+                self._replies.append("ERR BAUD rate")
+                return
+            self._replies.append(line)
+            self.firmware_baudrate = int(line.split()[1])
+
+    async def read_line(self, timeout: float = 1.0) -> Optional[str]:
+        if not self._replies:
+            return None
+        line = self._replies.popleft()
+        self._on_rx(line)
+        return line
+
+    async def _reader_loop(self) -> None:
+        while True:
+            while self._replies:
+                self._on_rx(self._replies.popleft())
+            await asyncio.sleep(0)
+
+    async def _writer_loop(self) -> None:
+        await asyncio.Event().wait()
+
+    def trip_deadman(self) -> None:
+        """FAILSAFE STOP: the firmware drops back to its base rate on its own."""
+        self.firmware_baudrate = self.baudrate
+
+    def _set_port_baudrate(self, baudrate: int) -> None:
+        self.port_baudrate = baudrate
+        if baudrate == self.baudrate and self.firmware_baudrate != self.baudrate:
+            # Stands in for the firmware's confirm window running out.
+            self.firmware_baudrate = self.baudrate
+
+
+@pytest.fixture(autouse=True)
+def no_fallback_wait(monkeypatch):
+    monkeypatch.setattr(motion_driver_bridge, "BAUD_FALLBACK_WAIT_S", 0)
+
+
+async def test_baud_negotiation_raises_the_link():
+    """BAUD is confirmed at the old rate, then PING at the new one keeps it."""
+    bridge = ScriptedBridge(link_baudrate=921600)
+    assert await bridge._negotiate_baud(921600)
+    assert bridge.active_baudrate == 921600
+    assert bridge.port_baudrate == 921600
+    assert bridge.sent == ["BAUD 921600", "PING"]
+
+
+async def test_baud_negotiation_falls_back_without_pong():
+    """No PONG at the new rate returns both ends to the base rate."""
+    bridge = ScriptedBridge(link_baudrate=2000000, confirms=False)
+    assert not await bridge._negotiate_baud(2000000)
+    assert bridge.active_baudrate == 115200
+    assert bridge.port_baudrate == 115200
+    assert bridge.firmware_baudrate == 115200
+
+
+async def test_refused_baud_leaves_the_port_alone():
+    """ERR BAUD rate means the firmware never switched, so neither do we."""
+    bridge = ScriptedBridge(link_baudrate=921600, supported=False)
+    assert not await bridge._negotiate_baud(921600)
+    assert bridge.port_baudrate == 115200
+    assert bridge.sent == ["BAUD 921600"]
+
+
+async def test_deadman_trip_at_the_raised_rate_renegotiates():
+    """Unanswered heartbeats after a deadman trip find the firmware at base again.
+
+    Without this the bridge kept pinging at 921600 into a firmware back at 115200,
+    and nothing got through until a restart.
+    """
+    bridge = ScriptedBridge(link_baudrate=921600)
+    bridge.heartbeat_interval = 0
+    assert await bridge._negotiate_baud(921600)
+    bridge.trip_deadman()
+    tripped_at = len(bridge.sent)
+
+    supervisor = asyncio.create_task(bridge._supervise())
+    for _ in range(50):
+        await asyncio.sleep(0)
+    bridge._closing = True
+    supervisor.cancel()
+
+    assert bridge.sent[tripped_at : tripped_at + RELINK_MISSED_PONGS + 1] == ["PING"] * (RELINK_MISSED_PONGS + 1)
+    assert "BAUD 921600" in bridge.sent[tripped_at:]
+    assert bridge.firmware_baudrate == bridge.active_baudrate == 921600
+
+    await bridge.send_raw("MOTOR ALL STOP\n")
+    assert bridge.received[-1] == "MOTOR ALL STOP"
+
+
+async def test_heartbeat_stats_report_the_active_rate():
+    """The Debug tab shows the rate the link actually runs at."""
+    bridge = ScriptedBridge(link_baudrate=921600)
+    await bridge._negotiate_baud(921600)
+    assert bridge.heartbeat_stats()["baudrate"] == 921600
+
+
+async def test_emergency_stop_leads_with_the_estop_byte():
+    """The firmware acts on 0x03 on receipt; the text stop backs up older builds."""
+    bridge = ScriptedBridge(link_baudrate=115200)
+    await bridge.emergency_stop()
+    assert bridge.sent == [ESTOP_TOKEN + "MOTOR ALL STOP"]
+
+
+def full_update(speed: float, pulse_us: int) -> MotionUpdate:
+    return MotionUpdate(motors={i: speed for i in range(6)}, servos={i: pulse_us for i in range(6)})
+
+
+def test_full_update_packs_into_one_drive_and_one_servo_frame():
+    """Six motors and six servos are two frames in one write, earning two OKs."""
+    data, replies = full_update(0.5, 1500).encode()
+    assert replies == 2
+    assert len(data) == 30
+    assert data[:15] == encode_frame(OPCODE_DRIVE, struct.pack("<6h", *[16384] * 6))
+    assert data[15:] == encode_frame(OPCODE_SERVO, struct.pack("<6H", *[1500] * 6))
+
+
+def test_partial_update_falls_back_to_text_lines():
+    """A frame would move every wheel, so pan/tilt alone goes out as S lines."""
+    data, replies = MotionUpdate(servos={0: 1200, 1: 1800}).encode()
+    assert data == b"S 0 1200\nS 1 1800\n"
+    assert replies == 2
+
+
+def test_mailbox_keeps_the_newest_target_for_every_wheel():
+    """An unsent update is merged over, not queued behind."""
+    mailbox = MotionMailbox()
+    assert not mailbox.put(MotionUpdate(motors={0: 0.2, 1: 0.2}))
+    assert mailbox.put(MotionUpdate(motors={1: 0.7}, servos={0: 1400}))
+    update = asyncio.run(mailbox.get())
+    assert update.motors == {0: 0.2, 1: 0.7}
+    assert update.servos == {0: 1400}
+    assert mailbox.superseded == 1
+
+
+class FakeWriter:
+    def __init__(self) -> None:
+        self.writes: list[bytes] = []
+
+    def write(self, data: bytes) -> None:
+        self.writes.append(data)
+
+    async def drain(self) -> None:
+        pass
+
+
+def connected_bridge() -> tuple[MotionDriverBridge, FakeWriter]:
+    bridge = MotionDriverBridge(port="/dev/null")
+    writer = FakeWriter()
+    bridge.writer = writer
+    bridge.connected = True
+    return bridge, writer
+
+
+async def test_writer_sends_a_burst_as_one_write_of_the_newest():
+    """Three updates before the writer runs cost one write, carrying the last."""
+    bridge, writer = connected_bridge()
+    for speed in (0.1, 0.2, 0.3):
+        bridge.submit(full_update(speed, 1500))
+    task = asyncio.create_task(bridge._writer_loop())
+    await asyncio.sleep(0)
+    task.cancel()
+    assert writer.writes == [StreamEncoder().encode([speed_to_q15(0.3)] * 6, [1500] * 6)]
+    assert bridge.heartbeat_stats()["superseded"] == 2
+
+
+def test_full_updates_stream_as_a_keyframe_then_deltas():
+    """Once every target is known only what moved goes out, as a short Delta."""
+    bridge = MotionDriverBridge(port="/dev/null")
+    keyframe, replies = bridge._encode(full_update(0.5, 1500))
+    assert keyframe[1] == OPCODE_KEYFRAME and replies == 1
+    delta, replies = bridge._encode(MotionUpdate(motors={0: 0.52}))
+    assert delta[1] == OPCODE_DELTA and replies == 1
+    assert len(delta) == 7
+
+
+def test_partial_targets_go_out_as_before_until_all_are_known():
+    """A Keyframe sets every servo, so it waits until the servos have been set."""
+    bridge = MotionDriverBridge(port="/dev/null")
+    data, _ = bridge._encode(MotionUpdate(motors={i: 0.5 for i in range(6)}))
+    assert data[1] == OPCODE_DRIVE
+    data, _ = bridge._encode(MotionUpdate(servos={i: 1500 for i in range(6)}))
+    assert data[1] == OPCODE_KEYFRAME
+
+
+async def test_stream_resyncs_after_err_estop_and_handshake():
+    """Each of these can leave the firmware's mirror out of step, so a Keyframe follows."""
+    bridge = ScriptedBridge(link_baudrate=115200)
+    bridge._encode(full_update(0.5, 1500))
+    assert bridge._encode(full_update(0.6, 1500))[0][1] == OPCODE_DELTA
+
+    bridge._on_reply("ERR Busy")
+    assert bridge._encode(full_update(0.6, 1500))[0][1] == OPCODE_KEYFRAME
+
+    await bridge.emergency_stop()
+    data, _ = bridge._encode(MotionUpdate(servos={0: 1600}))
+    assert data[1] == OPCODE_KEYFRAME
+    # The stop zeroed the motors; a servo tweak must not bring them back.
+    assert struct.unpack_from("<6h", data, 3) == (0,) * 6
+
+    await bridge._handshake(timeout=0.1)
+    assert bridge._encode(MotionUpdate(servos={0: 1600}))[0] == b"S 0 1600\n"
+
+
+async def test_emergency_stop_drops_an_unsent_update():
+    """A drive update still in the mailbox must not follow the stop out."""
+    bridge, writer = connected_bridge()
+    bridge.submit(full_update(1.0, 1500))
+    await bridge.emergency_stop()
+    task = asyncio.create_task(bridge._writer_loop())
+    await asyncio.sleep(0)
+    task.cancel()
+    assert writer.writes == [(ESTOP_TOKEN + "MOTOR ALL STOP\n").encode()]
+
+
+async def test_replies_are_timed_against_the_write_that_earned_them():
+    """Each OK closes out the oldest outstanding write; raw lines pause timing."""
+    bridge, _ = connected_bridge()
+    await bridge._write(b"frame", "DRIVE", "motion", 1)
+    bridge._on_reply("OK")
+    assert bridge.heartbeat_stats()["ack_ms"] is not None
+    assert not bridge._in_flight
+
+    await bridge.send_raw("STATS\n")
+    await bridge._write(b"frame", "DRIVE", "motion", 1)
+    assert not bridge._in_flight
+
+
+def test_decoder_splits_text_replies_from_telemetry_frames():
+    """Lines and frames interleave; a torn or corrupt frame is skipped, not parsed."""
+    payload = struct.pack(TELEMETRY_FORMAT, 1234, *[0] * 12, *[1500] * 6, 80, 1000, 0x01)
+    frame = encode_frame(OPCODE_TELEMETRY, payload)
+    corrupt = frame[:-1] + bytes([frame[-1] ^ 0xFF])
+    stream = b"OK\n" + frame + b"PONG\n" + corrupt + b"ERR Busy\n"
+
+    decoder = LinkDecoder()
+    items = []
+    for offset in range(0, len(stream), 7):
+        items.extend(decoder.feed(stream[offset : offset + 7]))
+
+    assert items == ["OK", RxFrame(OPCODE_TELEMETRY, payload), "PONG", "ERR Busy"]
+    assert decoder.dropped == 1
+    telemetry = decode_telemetry(payload)
+    assert telemetry["servos_us"] == [1500] * 6
+    assert telemetry["driver_enabled"] and not telemetry["failsafe"]
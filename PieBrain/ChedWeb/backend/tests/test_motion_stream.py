@@ -0,0 +1,171 @@
+"""
+Tests for the MotionDriver stream-mode encoder
+"""
+
+import struct
+
+import pytest
+from motion_stream import (
+    DELTA_PULSE_STEP_US,
+    DELTA_SPEED_STEP,
+    OPCODE_DELTA,
+    OPCODE_KEYFRAME,
+    SPEED_SCALE,
+    SYNC,
+    StreamEncoder,
+    crc8,
+)
+
+CENTRE = [1500] * 6
+STOPPED = [0] * 6
+
+
+class FirmwareMirror:
+    """Decodes frames the way UARTCommandInput's stream handlers apply them."""
+
+    def __init__(self) -> None:
+        self.valid = False
+        self.sequence = 0
+        self.speeds = [0] * 6
+        self.pulses = [0] * 6
+
+    def apply(self, frame: bytes) -> bool:
+        assert frame[0] == SYNC
+        body, crc = frame[1:-1], frame[-1]
+        assert crc8(body) == crc
+        opcode, payload = body[0], body[1:]
+
+        if opcode == OPCODE_KEYFRAME:
+            assert len(payload) == 25
+            values = struct.unpack("<B6h6H", payload)
+            self.sequence = values[0]
+            self.speeds = list(values[1:7])
+            self.pulses = list(values[7:13])
+            self.valid = True
+            return True
+
+        assert opcode == OPCODE_DELTA
+        sequence, mask = struct.unpack_from("<BH", payload)
+        if not self.valid or sequence != (self.sequence + 1) & 0xFF:
+            self.valid = False
+            return False
+        steps = list(struct.unpack_from(f"<{bin(mask).count('1')}b", payload, 3))
+        assert len(payload) == 3 + len(steps)
+        for index in range(6):
+            if mask & (1 << index):
+                speed = self.speeds[index] + steps.pop(0) * DELTA_SPEED_STEP
+                self.speeds[index] = max(-SPEED_SCALE, min(SPEED_SCALE, speed))
+        for channel in range(6):
+            if mask & (1 << (6 + channel)):
+                pulse = self.pulses[channel] + steps.pop(0) * DELTA_PULSE_STEP_US
+                self.pulses[channel] = max(0, min(0xFFFF, pulse))
+        self.sequence = sequence
+        return True
+
+
+def test_crc_matches_smbus_check_value():
+    """CRC-8/SMBUS of the standard check string is 0xF4."""
+    assert crc8(b"123456789") == 0xF4
+
+
+def test_first_update_is_a_keyframe():
+    """With no mirror yet there is nothing to delta against."""
+    frame = StreamEncoder().encode(STOPPED, CENTRE)
+    assert frame[1] == OPCODE_KEYFRAME
+    assert len(frame) == 28
+
+
+def test_unchanged_update_is_a_six_byte_keepalive():
+    """An update that moved nothing sends an empty-mask delta."""
+    encoder = StreamEncoder()
+    encoder.encode(STOPPED, CENTRE)
+    frame = encoder.encode(STOPPED, CENTRE)
+    assert frame[1] == OPCODE_DELTA
+    assert len(frame) == 6
+    assert struct.unpack_from("<H", frame, 3)[0] == 0
+
+
+def test_delta_carries_only_changed_fields():
+    """One motor and one servo moving costs two step bytes."""
+    encoder = StreamEncoder()
+    encoder.encode(STOPPED, CENTRE)
+    frame = encoder.encode([2560, 0, 0, 0, 0, 0], [1500, 1500, 1540, 1500, 1500, 1500])
+    mask = struct.unpack_from("<H", frame, 3)[0]
+    assert mask == (1 << 0) | (1 << (6 + 2))
+    assert struct.unpack_from("<2b", frame, 5) == (10, 10)
+
+
+def test_large_jump_falls_back_to_keyframe():
+    """A field further away than one int8 step can reach forces a keyframe."""
+    encoder = StreamEncoder()
+    encoder.encode(STOPPED, CENTRE)
+    frame = encoder.encode([SPEED_SCALE] * 6, CENTRE)
+    assert frame[1] == OPCODE_KEYFRAME
+
+
+def test_keyframe_interval_is_honoured():
+    """Every keyframe_interval deltas a keyframe is sent anyway."""
+    encoder = StreamEncoder(keyframe_interval=3)
+    opcodes = [encoder.encode(STOPPED, CENTRE)[1] for _ in range(8)]
+    assert opcodes == [
+        OPCODE_KEYFRAME,
+        OPCODE_DELTA,
+        OPCODE_DELTA,
+        OPCODE_DELTA,
+        OPCODE_KEYFRAME,
+        OPCODE_DELTA,
+        OPCODE_DELTA,
+        OPCODE_DELTA,
+    ]
+
+
+def test_firmware_mirror_tracks_encoder_mirror():
+    """The firmware's mirror must match the encoder's after every frame."""
+    encoder = StreamEncoder(keyframe_interval=50)
+    firmware = FirmwareMirror()
+    for tick in range(200):
+        ramp = (tick * 331) % (2 * SPEED_SCALE) - SPEED_SCALE
+        speeds = [ramp, -ramp, ramp // 2, 0, SPEED_SCALE, -SPEED_SCALE]
+        pulses = [1000 + (tick * 7) % 1000] * 3 + [1500, 2000, 1000]
+        assert firmware.apply(encoder.encode(speeds, pulses))
+        assert encoder.mirror == (firmware.speeds, firmware.pulses)
+
+
+def test_mirror_stays_within_half_a_step_of_target():
+    """Quantisation error stays below half a step once a delta lands."""
+    encoder = StreamEncoder()
+    encoder.encode(STOPPED, CENTRE)
+    encoder.encode([1000] * 6, [1503] * 6)
+    speeds, pulses = encoder.mirror
+    assert all(abs(s - 1000) <= DELTA_SPEED_STEP // 2 for s in speeds)
+    assert all(abs(p - 1503) <= DELTA_PULSE_STEP_US // 2 for p in pulses)
+
+
+def test_lost_delta_is_refused_until_resync():
+    """A gap in sequence is refused; resync() recovers with a keyframe."""
+    encoder = StreamEncoder()
+    firmware = FirmwareMirror()
+    firmware.apply(encoder.encode(STOPPED, CENTRE))
+    encoder.encode([512] * 6, CENTRE)  # lost on the wire
+    assert not firmware.apply(encoder.encode([1024] * 6, CENTRE))
+    assert not firmware.apply(encoder.encode([1536] * 6, CENTRE))
+
+    encoder.resync()
+    frame = encoder.encode([1536] * 6, CENTRE)
+    assert frame[1] == OPCODE_KEYFRAME
+    assert firmware.apply(frame)
+    assert firmware.speeds == [1536] * 6
+
+
+def test_sequence_wraps_modulo_256():
+    """The one-byte sequence wraps without breaking the stream."""
+    encoder = StreamEncoder(keyframe_interval=1000)
+    firmware = FirmwareMirror()
+    for _ in range(300):
+        assert firmware.apply(encoder.encode(STOPPED, CENTRE))
+
+
+def test_wrong_counts_are_rejected():
+    """Six motors and six servos, always."""
+    with pytest.raises(ValueError):
+        StreamEncoder().encode([0] * 5, CENTRE)
@@ -21,6 +21,7 @@ export function HeartbeatCard({ heartbeat, rttHistory, connected }: Props) {
   const deadmanFrac = age !== null && age !== undefined ? Math.min((age * 1000) / deadmanMs, 1) : 0
 
   const rtt = heartbeat.rtt_ms
+  const ackMs = heartbeat.ack_ms
 
   return (
     <Card className="w-full">
@@ -79,6 +80,9 @@ export function HeartbeatCard({ heartbeat, rttHistory, connected }: Props) {
           <Row label="Last PONG" value={age !== null && age !== undefined ? `${age.toFixed(2)} s ago` : '--'} good={healthy} />
           <Row label="Missed beats (60s)" value={String(heartbeat.missed_60s ?? 0)} />
           <Row label="Deadman window" value={`${deadmanMs} ms`} />
+          <Row label="Link baud" value={heartbeat.baudrate ? String(heartbeat.baudrate) : '--'} />
+          <Row label="Drive ack" value={ackMs !== null && ackMs !== undefined ? `${ackMs.toFixed(1)} ms` : '--'} />
+          <Row label="Superseded updates" value={String(heartbeat.superseded ?? 0)} />
         </div>
 
         <div className="relative h-2 overflow-hidden rounded bg-muted">
@@ -85,6 +85,9 @@ export const HeartbeatStatsSchema = z.object({
   missed_60s: z.number().optional(),
   interval_ms: z.number().optional(),
   deadman_ms: z.number().optional(),
+  baudrate: z.number().optional(),
+  ack_ms: z.number().nullable().optional(),
+  superseded: z.number().optional(),
 })
 
 export const PowerFlagsSchema = z.object({
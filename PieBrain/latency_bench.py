@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+"""Command-to-actuation latency benchmark for the MotionDriver link.
+
+Sweeps DRIVE commands across a range of message rates and, for each rate,
+reports:
+
+  * round trip   - Pi write() to the firmware's OK arriving back (this script's clock)
+  * rx_to_parse  - line framed on the ESP32 to parsed (the firmware's LAT clock)
+  * rx_to_motor  - line framed on the ESP32 to the first LEDC duty change it caused
+
+as p50/p99/p999 in microseconds. The firmware side comes from the LAT command
+(see MotionDriver/docs/cli_help.txt), which this turns on for the run.
+
+The backend owns the serial port, so stop it first (sudo systemctl stop
+cheddar-backend), and put the wheels up: the motors are driven, gently, the
+whole time. Example:
+
+    python3 latency_bench.py --port /dev/serial0 --rates 10,50,100,200
+"""
+
+import argparse
+import math
+import sys
+import time
+
+import serial
+
+BOOT_BAUDRATE = 115200
+# 8N1: ten bit times per byte on the wire.
+BITS_PER_BYTE = 10
+# Leave the link this much slack, or the queue in the Pi's UART driver becomes
+# the thing being measured.
+MAX_LINK_LOAD = 0.8
+LAT_PATHS = ("rx_to_parse", "rx_to_motor_pwm", "rx_to_servo_pwm")
+# How long to wait for the last replies after the final send. The firmware's
+# deadman trips after 1 s without a command, stopping the motors and dropping the
+# link back to BOOT_BAUDRATE, so this has to stay well under that.
+TAIL_WAIT_S = 0.5
+
+
+def percentile(samples, fraction):
+    """Nearest-rank percentile of a sorted list; None when empty."""
+    if not samples:
+        return None
+    rank = max(1, math.ceil(len(samples) * fraction))
+    return samples[min(rank, len(samples)) - 1]
+
+
+def format_triple(p50, p99, p999):
+    if p50 is None:
+        return f"{'-':>21}"
+    return f"{p50:>6.0f} {p99:>6.0f} {p999:>7.0f}"
+
+
+class Link:
+    """Line-oriented view of the port with a non-blocking read side."""
+
+    def __init__(self, port, baudrate):
+        self._serial = serial.Serial(port, baudrate, timeout=0)
+        self._pending = b""
+
+    def close(self):
+        self._serial.close()
+
+    def write_line(self, line):
+        self._serial.write(line.encode("ascii") + b"\n")
+
+    def read_lines(self):
+        """Complete lines received so far, with the time they were read."""
+        chunk = self._serial.read(self._serial.in_waiting or 1)
+        now = time.perf_counter()
+        if not chunk:
+            return []
+        self._pending += chunk
+        *lines, self._pending = self._pending.split(b"\n")
+        return [(now, line.strip().decode("ascii", "replace")) for line in lines]
+
+    def command(self, line, timeout_s=1.0):
+        """Sends a command and returns the lines before its OK; raises on ERR."""
+        self.write_line(line)
+        body = []
+        deadline = time.perf_counter() + timeout_s
+        while time.perf_counter() < deadline:
+            for _, reply in self.read_lines():
+                if reply in ("OK", "PONG"):
+                    return body
+                if reply.startswith("ERR"):
+                    raise RuntimeError(f"{line!r}: {reply}")
+                body.append(reply)
+            time.sleep(0.001)
+        raise TimeoutError(f"No reply to {line!r}")
+
+
+def read_firmware_latency(link):
+    """Parses the LAT report into {path: {field: value}}."""
+    report = {}
+    for line in link.command("LAT"):
+        fields = line.split()
+        if len(fields) < 3 or fields[0] != "LAT" or fields[1] not in LAT_PATHS:
+            continue
+        report[fields[1]] = {
+            key: int(value) for key, value in (field.split("=", 1) for field in fields[2:])
+        }
+    return report
+
+
+def run_rate(link, rate_hz, duration_s, speed):
+    """Streams tagged DRIVE commands at rate_hz; returns sorted round trips (us)."""
+    link.command("LAT RESET")
+    interval_s = 1.0 / rate_hz
+    sent_at = {}
+    outstanding = []
+    round_trips = []
+    errors = 0
+    sequence = 0
+    start = time.perf_counter()
+    next_send = start
+    end = start + duration_s
+
+    # Keep reading past the last send so the tail of replies is counted.
+    while time.perf_counter() < end or (outstanding and time.perf_counter() < end + TAIL_WAIT_S):
+        now = time.perf_counter()
+        if now >= next_send and now < end:
+            # Alternate the target so every command really retargets the motors;
+            # a repeated speed changes nothing the firmware could time.
+            value = speed if sequence % 2 == 0 else speed * 0.8
+            speeds = " ".join(f"{value:.3f}" for _ in range(6))
+            sequence += 1
+            sent_at[sequence] = time.perf_counter()
+            link.write_line(f"#{sequence} DRIVE {speeds}")
+            outstanding.append(sequence)
+            next_send += interval_s
+
+        for received_at, reply in link.read_lines():
+            if not outstanding:
+                continue
+            if reply == "OK":
+                tag = outstanding.pop(0)
+                round_trips.append((received_at - sent_at.pop(tag)) * 1e6)
+            elif reply.startswith("ERR"):
+                outstanding.pop(0)
+                errors += 1
+        time.sleep(0.0002)
+
+    round_trips.sort()
+    return round_trips, sequence, errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--port", default="/dev/serial0")
+    parser.add_argument("--baudrate", type=int, default=BOOT_BAUDRATE,
+                        help="Link rate; the firmware is switched to it with BAUD")
+    parser.add_argument("--rates", default="10,20,50,100,200",
+                        help="Comma-separated DRIVE rates to sweep, in Hz")
+    parser.add_argument("--duration", type=float, default=5.0,
+                        help="Seconds spent at each rate")
+    parser.add_argument("--speed", type=float, default=0.15,
+                        help="Wheel speed commanded (alternating with 80%% of it)")
+    args = parser.parse_args()
+
+    rates = [float(rate) for rate in args.rates.split(",") if rate]
+    link = Link(args.port, BOOT_BAUDRATE)
+    try:
+        link.command("PING")
+        link.command("LOG OFF")
+        link.command("ACK OFF")
+        if args.baudrate != BOOT_BAUDRATE:
+            link.write_line(f"BAUD {args.baudrate}")
+            time.sleep(0.05)
+            link.close()
+            link = Link(args.port, args.baudrate)
+            link.command("PING")
+        link.command("LAT ON")
+
+        line_bytes = len(f"#99999 DRIVE {' '.join(['0.000'] * 6)}\n")
+        capacity_hz = MAX_LINK_LOAD * args.baudrate / BITS_PER_BYTE / line_bytes
+
+        print(f"{'rate_hz':>8} {'sent':>6} {'err':>4} | "
+              f"{'round trip p50/p99/p999':>23} | "
+              f"{'rx_to_parse':>21} | {'rx_to_motor_pwm':>21}")
+        for rate_hz in rates:
+            if rate_hz > capacity_hz:
+                print(f"{rate_hz:>8.0f}  skipped: {args.baudrate} baud carries ~{capacity_hz:.0f} Hz")
+                continue
+
+            round_trips, sent, errors = run_rate(link, rate_hz, args.duration, args.speed)
+            firmware = read_firmware_latency(link)
+            columns = [format_triple(percentile(round_trips, 0.5),
+                                     percentile(round_trips, 0.99),
+                                     percentile(round_trips, 0.999))]
+            for path in ("rx_to_parse", "rx_to_motor_pwm"):
+                stats = firmware.get(path, {})
+                if stats.get("n", 0) == 0:
+                    columns.append(format_triple(None, None, None))
+                else:
+                    columns.append(format_triple(stats["p50_us"], stats["p99_us"], stats["p999_us"]))
+            print(f"{rate_hz:>8.0f} {sent:>6} {errors:>4} |  " + " | ".join(columns))
+    finally:
+        try:
+            link.command("MOTOR ALL STOP")
+            link.command("LAT OFF")
+        finally:
+            link.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())